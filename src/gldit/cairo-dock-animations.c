@@ -135,14 +135,124 @@ gfloat cairo_dock_calculate_magnitude (gint iMagnitudeIndex)  // merci a Robrob
 }
 
 
+static gboolean _animation_step (GldiContainer *pContainer)
+{
+	return pContainer->iface.animation_loop (pContainer);  // may destroy the container; the icons it redraws are accumulated on the container and redrawn at once.
+}
+
+#if GTK_CHECK_VERSION (3, 8, 0)
+// The animation loop is paced on the frame clock of the container: the steps are spaced by a whole number of frames (the closest to the animation delta-T), and are run right after a vblank, so that each step is displayed on its own frame and the animation doesn't stutter when the delta-T is not a multiple of the refresh interval.
+typedef struct {
+	GSource source;
+	GldiContainer *pContainer;
+	gint64 iPlannedTime;  // time at which the current step was planned (us, monotonic)
+	gint64 iStartTime;
+	} GldiAnimationSource;
+
+static guint s_iNbFrames = 0;  // same as the counters of the containers, summed over all the animations since the beginning, see cairo_dock_get_animation_frames_stats()
+static guint s_iNbLateFrames = 0;
+static guint s_iNbDroppedFrames = 0;
+
+static gint64 _get_next_step_time (GldiContainer *pContainer, gint64 iLastTime, gint64 *iRefreshInterval)
+{
+	gint64 iDeltaT = (gint64) pContainer->iAnimationDeltaT * 1000;
+	gint64 iNextTime = iLastTime + iDeltaT;
+	*iRefreshInterval = 0;
+	GdkFrameClock *pFrameClock = gtk_widget_get_frame_clock (pContainer->pWidget);  // NULL if not realized
+	if (pFrameClock != NULL)
+	{
+		gint64 iPresentationTime = 0;
+		gdk_frame_clock_get_refresh_info (pFrameClock, iLastTime, iRefreshInterval, &iPresentationTime);
+		if (*iRefreshInterval > 0)
+		{
+			gint64 iNbFrames = MAX (1, (iDeltaT + *iRefreshInterval / 2) / *iRefreshInterval);
+			iNextTime = iLastTime + iNbFrames * *iRefreshInterval;
+			gdk_frame_clock_get_refresh_info (pFrameClock, iNextTime - *iRefreshInterval / 2, iRefreshInterval, &iPresentationTime);  // snap on the closest vblank
+			if (iPresentationTime > 0)
+				iNextTime = iPresentationTime;
+		}
+	}
+	return iNextTime;
+}
+
+static gboolean _animation_source_dispatch (GSource *pSource, G_GNUC_UNUSED GSourceFunc callback, G_GNUC_UNUSED gpointer data)
+{
+	GldiAnimationSource *pAnimationSource = (GldiAnimationSource*)pSource;
+	GldiContainer *pContainer = pAnimationSource->pContainer;
+	gint64 iNow = g_source_get_time (pSource);
+	
+	//\_______________ measure how late we are.
+	gint64 iRefreshInterval;
+	_get_next_step_time (pContainer, pAnimationSource->iPlannedTime, &iRefreshInterval);
+	pContainer->iNbFrames ++;
+	s_iNbFrames ++;
+	if (iRefreshInterval > 0 && iNow - pAnimationSource->iPlannedTime > iRefreshInterval)  // the step has missed its frame.
+	{
+		guint iNbDroppedFrames = (iNow - pAnimationSource->iPlannedTime) / iRefreshInterval;
+		pContainer->iNbLateFrames ++;
+		pContainer->iNbDroppedFrames += iNbDroppedFrames;
+		s_iNbLateFrames ++;
+		s_iNbDroppedFrames += iNbDroppedFrames;
+	}
+	
+	//\_______________ run the step.
+	gboolean bContinue = _animation_step (pContainer);
+	if (g_source_is_destroyed (pSource))  // the container has been destroyed, or the animation stopped from outside.
+		return FALSE;
+	if (! bContinue)
+	{
+		cd_debug ("animation over after %.2fs: %u frames, %u late, %u dropped", (iNow - pAnimationSource->iStartTime) / 1e6, pContainer->iNbFrames, pContainer->iNbLateFrames, pContainer->iNbDroppedFrames);
+		return FALSE;  // the loop has already reset the source ID.
+	}
+	
+	//\_______________ plan the next step, from the planned time rather than now, to not drift.
+	pAnimationSource->iPlannedTime = _get_next_step_time (pContainer, MAX (pAnimationSource->iPlannedTime, iNow - iRefreshInterval), &iRefreshInterval);
+	g_source_set_ready_time (pSource, pAnimationSource->iPlannedTime);
+	return TRUE;
+}
+
+static GSourceFuncs s_animationSourceFuncs = {
+	NULL,
+	NULL,
+	_animation_source_dispatch,
+	NULL,
+	NULL,
+	NULL
+};
+#endif
+
+void cairo_dock_get_animation_frames_stats (guint *iNbFrames, guint *iNbLateFrames, guint *iNbDroppedFrames)
+{
+	#if GTK_CHECK_VERSION (3, 8, 0)
+	*iNbFrames = s_iNbFrames;
+	*iNbLateFrames = s_iNbLateFrames;
+	*iNbDroppedFrames = s_iNbDroppedFrames;
+	#else
+	*iNbFrames = *iNbLateFrames = *iNbDroppedFrames = 0;
+	#endif
+}
+
 void cairo_dock_launch_animation (GldiContainer *pContainer)
 {
 	if (pContainer->iSidGLAnimation == 0 && pContainer->iface.animation_loop != NULL)
 	{
-		int iAnimationDeltaT = cairo_dock_get_animation_delta_t (pContainer);
 		pContainer->bKeepSlowAnimation = TRUE;
+		pContainer->iNbFrames = pContainer->iNbLateFrames = pContainer->iNbDroppedFrames = 0;
 		
-		pContainer->iSidGLAnimation = g_timeout_add (iAnimationDeltaT, (GSourceFunc)pContainer->iface.animation_loop, pContainer);
+		#if GTK_CHECK_VERSION (3, 8, 0)
+		GSource *pSource = g_source_new (&s_animationSourceFuncs, sizeof (GldiAnimationSource));
+		GldiAnimationSource *pAnimationSource = (GldiAnimationSource*)pSource;
+		gint64 iRefreshInterval;
+		pAnimationSource->pContainer = pContainer;
+		pAnimationSource->iStartTime = g_get_monotonic_time ();
+		pAnimationSource->iPlannedTime = _get_next_step_time (pContainer, pAnimationSource->iStartTime, &iRefreshInterval);
+		g_source_set_ready_time (pSource, pAnimationSource->iPlannedTime);
+		pContainer->iSidGLAnimation = g_source_attach (pSource, NULL);
+		g_source_unref (pSource);  // the main context holds it until it's removed
+		#else
+		int iAnimationDeltaT = cairo_dock_get_animation_delta_t (pContainer);
+		pContainer->iSidGLAnimation = g_timeout_add (iAnimationDeltaT, (GSourceFunc)_animation_step, pContainer);
+		#endif
 	}
 }
 
@@ -355,6 +465,7 @@ void cairo_dock_trigger_icon_removal_from_dock (Icon *pIcon)
 			pIcon->fInsertRemoveFactor = 1.0;
 		else
 			pIcon->fInsertRemoveFactor = 0.05;
+		cairo_dock_invalidate_wave_linear (pDock);
 		gldi_object_notify (pDock, NOTIFICATION_REMOVE_ICON, pIcon, pDock);
 		gldi_icon_start_animation (pIcon);
 	}
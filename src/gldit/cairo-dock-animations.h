@@ -115,6 +115,13 @@ gfloat cairo_dock_calculate_magnitude (gint iMagnitudeIndex);
 */
 void cairo_dock_launch_animation (GldiContainer *pContainer);
 
+/** Get the number of steps of the animations run since the beginning, how many of them missed their frame, and the number of frames that were dropped because of them. They're only counted when the animations are paced on the frame clock (GTK >= 3.8), otherwise they're all 0.
+*@param iNbFrames returns the number of steps
+*@param iNbLateFrames returns the number of late steps
+*@param iNbDroppedFrames returns the number of dropped frames
+*/
+void cairo_dock_get_animation_frames_stats (guint *iNbFrames, guint *iNbLateFrames, guint *iNbDroppedFrames);
+
 void cairo_dock_start_shrinking (CairoDock *pDock);
 
 void cairo_dock_start_growing (CairoDock *pDock);
@@ -53,34 +53,37 @@ extern gboolean g_bUseOpenGL;
 void cairo_dock_set_icon_surface_full (cairo_t *pIconContext, cairo_surface_t *pSurface, double fScale, double fAlpha, Icon *pIcon)
 {
 	//\________________ On efface l'ancienne image.
-	if (! cairo_dock_begin_draw_icon_cairo (pIcon, 0, pIconContext))  // 0 <=> erase
+	cairo_t *ctx = cairo_dock_begin_draw_icon_cairo (pIcon, 0, pIconContext);  // 0 <=> erase
+	if (! ctx)
 		return;
 	
 	//\________________ On applique la nouvelle image.
 	if (pSurface != NULL && fScale > 0)
 	{
-		cairo_save (pIconContext);
+		cairo_save (ctx);
 		if (fScale != 1 && pIcon != NULL)
 		{
 			int iWidth, iHeight;
 			cairo_dock_get_icon_extent (pIcon, &iWidth, &iHeight);
-			cairo_translate (pIconContext, .5 * iWidth * (1 - fScale) , .5 * iHeight * (1 - fScale));
-			cairo_scale (pIconContext, fScale, fScale);
+			cairo_translate (ctx, .5 * iWidth * (1 - fScale) , .5 * iHeight * (1 - fScale));
+			cairo_scale (ctx, fScale, fScale);
 		}
 		
 		cairo_set_source_surface (
-			pIconContext,
+			ctx,
 			pSurface,
 			0.,
 			0.);
 		
 		if (fAlpha != 1)
-			cairo_paint_with_alpha (pIconContext, fAlpha);
+			cairo_paint_with_alpha (ctx, fAlpha);
 		else
-			cairo_paint (pIconContext);
-		cairo_restore (pIconContext);
+			cairo_paint (ctx);
+		cairo_restore (ctx);
 	}
 	cairo_dock_end_draw_icon_cairo (pIcon);
+	if (ctx != pIconContext)
+		cairo_destroy (ctx);
 }
 
 
@@ -475,3 +478,54 @@ void cairo_dock_resize_applet (GldiModuleInstance *pInstance, int w, int h)
 	}
 }
 
+
+  /////////////////
+ /// SELF-TEST ///
+/////////////////
+
+static guint32 _get_center_pixel (cairo_surface_t *pSurface, int iWidth, int iHeight)  // the surface may not be an image surface, so paint it on one.
+{
+	cairo_surface_t *pPixel = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 1, 1);
+	cairo_t *ctx = cairo_create (pPixel);
+	cairo_set_source_surface (ctx, pSurface, - iWidth / 2, - iHeight / 2);
+	cairo_set_operator (ctx, CAIRO_OPERATOR_SOURCE);
+	cairo_paint (ctx);
+	cairo_destroy (ctx);
+	cairo_surface_flush (pPixel);
+	guint32 iPixel = *(guint32*)cairo_image_surface_get_data (pPixel);
+	cairo_surface_destroy (pPixel);
+	return iPixel;
+}
+
+static cairo_surface_t *_make_plain_surface (int iWidth, int iHeight, double r, double g, double b)
+{
+	cairo_surface_t *pSurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, iWidth, iHeight);
+	cairo_t *ctx = cairo_create (pSurface);
+	cairo_set_source_rgb (ctx, r, g, b);
+	cairo_paint (ctx);
+	cairo_destroy (ctx);
+	return pSurface;
+}
+
+void cairo_dock_test_draw_on_shared_icon (gboolean *bDrawn, gboolean *bOtherUntouched)
+{
+	int iSize = 16;
+	Icon *pIcon = cairo_dock_create_dummy_launcher (NULL, NULL, NULL, NULL, 0);
+	Icon *pOtherIcon = cairo_dock_create_dummy_launcher (NULL, NULL, NULL, NULL, 1);
+	cairo_dock_load_image_buffer_from_surface (&pIcon->image, _make_plain_surface (iSize, iSize, 1., 0., 0.), iSize, iSize);
+	cairo_dock_share_image_buffer (&pIcon->image, "/self-test/draw-on-shared-icon", iSize, iSize, 0);
+	cairo_dock_load_image_buffer_from_shared_image (&pOtherIcon->image, "/self-test/draw-on-shared-icon", iSize, iSize, 0);
+	guint32 iOtherPixel = _get_center_pixel (pOtherIcon->image.pSurface, iSize, iSize);
+	
+	cairo_t *pIconContext = cairo_create (pIcon->image.pSurface);  // made before drawing, like an applet does with its icon.
+	cairo_surface_t *pSurface = _make_plain_surface (iSize, iSize, 0., 0., 1.);
+	cairo_dock_set_icon_surface (pIconContext, pSurface, pIcon);
+	
+	*bDrawn = (_get_center_pixel (pIcon->image.pSurface, iSize, iSize) == _get_center_pixel (pSurface, iSize, iSize));
+	*bOtherUntouched = (_get_center_pixel (pOtherIcon->image.pSurface, iSize, iSize) == iOtherPixel);
+	
+	cairo_surface_destroy (pSurface);
+	cairo_destroy (pIconContext);
+	gldi_object_unref (GLDI_OBJECT (pIcon));
+	gldi_object_unref (GLDI_OBJECT (pOtherIcon));
+}
@@ -68,6 +68,12 @@ void cairo_dock_set_image_on_icon_with_default (cairo_t *pIconContext, const gch
 
 
 void cairo_dock_set_hours_minutes_as_quick_info (Icon *pIcon, int iTimeInSeconds);
+
+/** Check that drawing on an icon doesn't draw on the icons sharing its image: 2 throwaway icons share an image, and a new image is set on the first one with a context made on the shared surface beforehand.
+*@param bDrawn returns whether the first icon shows the new image (TRUE is expected)
+*@param bOtherUntouched returns whether the second icon still shows the shared image (TRUE is expected)
+*/
+void cairo_dock_test_draw_on_shared_icon (gboolean *bDrawn, gboolean *bOtherUntouched);
 void cairo_dock_set_minutes_secondes_as_quick_info (Icon *pIcon, int iTimeInSeconds);
 
 /** Convert a size in bytes into a readable format.
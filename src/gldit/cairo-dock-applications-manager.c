@@ -691,18 +691,21 @@ static void _load_appli (Icon *icon)
 		}
 	}
 	
-	// in other cases (or if the preview couldn't be used)
+	// in other cases (or if the preview couldn't be used), use the class icon (shared with the launcher if possible)
+	if (icon->image.iTexture == 0 && icon->image.pSurface == NULL
+	&& myTaskbarParam.bOverWriteXIcons && ! cairo_dock_class_is_using_xicon (icon->cClass))
+	{
+		cairo_dock_load_class_image_buffer (&icon->image, icon->cClass, iWidth, iHeight);
+	}
+	
 	if (icon->image.iTexture == 0 && icon->image.pSurface == NULL)
 	{
-		cairo_surface_t *pSurface = NULL;
-		// or use the class icon
-		if (myTaskbarParam.bOverWriteXIcons && ! cairo_dock_class_is_using_xicon (icon->cClass))
-			pSurface = cairo_dock_create_surface_from_class (icon->cClass, iWidth, iHeight);
 		// or use the X icon
-		if (pSurface == NULL)
-			pSurface = gldi_window_get_icon_surface (icon->pAppli, iWidth, iHeight);
+		cairo_surface_t *pSurface = gldi_window_get_icon_surface (icon->pAppli, iWidth, iHeight);
+		if (pSurface != NULL)
+			cairo_dock_load_image_buffer_from_surface (&icon->image, pSurface, iWidth, iHeight);
 		// or use a default image
-		if (pSurface == NULL)  // some applis like xterm don't define any icon, set the default one.
+		else  // some applis like xterm don't define any icon, set the default one; it's shared between all of them.
 		{
 			cd_debug ("%s (%p) doesn't define any icon, we set the default one.", icon->cName, icon->pAppli);
 			gchar *cIconPath = cairo_dock_search_image_s_path (CAIRO_DOCK_DEFAULT_APPLI_ICON_NAME);
@@ -710,13 +713,9 @@ static void _load_appli (Icon *icon)
 			{
 				cIconPath = g_strdup (GLDI_SHARE_DATA_DIR"/icons/"CAIRO_DOCK_DEFAULT_APPLI_ICON_NAME);
 			}
-			pSurface = cairo_dock_create_surface_from_image_simple (cIconPath,
-				iWidth,
-				iHeight);
+			cairo_dock_load_shared_image_buffer (&icon->image, cIconPath, iWidth, iHeight, CAIRO_DOCK_FILL_SPACE);
 			g_free (cIconPath);
 		}
-		if (pSurface != NULL)
-			cairo_dock_load_image_buffer_from_surface (&icon->image, pSurface, iWidth, iHeight);
 	}
 	
 	// bent the icon in the case of a minimized window and if defined in the config.
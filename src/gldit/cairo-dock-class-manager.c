@@ -21,8 +21,10 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 
 #include <cairo.h>
+#include <gio/gio.h>
 
 #include "cairo-dock-icon-factory.h"
 #include "cairo-dock-icon-facility.h"
@@ -51,6 +53,7 @@
 #include "cairo-dock-keyfile-utilities.h"
 #include "cairo-dock-file-manager.h"
 #include "cairo-dock-windows-manager.h"
+#include "cairo-dock-task.h"
 #include "cairo-dock-class-manager.h"
 
 extern CairoDock *g_pMainDock;
@@ -58,6 +61,30 @@ extern CairoDockDesktopEnv g_iDesktopEnv;
 
 static GHashTable *s_hClassTable = NULL;
 
+// index of the .desktop files, built in a thread; NULL until the first scan is done.
+typedef struct {
+	gchar *cPath;
+	gchar *cIcon;
+} GldiDesktopFileEntry;
+
+typedef struct {
+	gchar **pDirs;  // the XDG applications folders, by order of priority
+	GHashTable *pByName;  // basename -> entry (owns the entries)
+	GHashTable *pByWmClass;  // class guessed from StartupWMClass -> entry
+	GHashTable *pByCommand;  // class guessed from Exec -> entry
+	GHashTable *pByIcon;  // Icon -> entry
+	GList *pScannedDirs;  // all the folders that have been read, sub-folders included
+} GldiDesktopFilesIndex;
+
+static GldiDesktopFilesIndex *s_pDesktopFilesIndex = NULL;
+static GldiTask *s_pDesktopFilesTask = NULL;
+static gchar **s_pDesktopFilesDirs = NULL;  // the folders to index, owned by the task's data
+static GHashTable *s_hDesktopDirMonitors = NULL;  // folder -> GFileMonitor
+static gboolean s_bDesktopFilesRescanPending = FALSE;
+static GHashTable *s_hPendingClasses = NULL;  // classes that were not found before the first scan ended
+
+#define GLDI_DESKTOP_FILES_RESCAN_DELAY 2000  // ms; a package installation usually touches several files in a row.
+
 
 static void cairo_dock_free_class_appli (CairoDockClassAppli *pClassAppli)
 {
@@ -99,6 +126,8 @@ static gboolean _on_window_activated (G_GNUC_UNUSED gpointer data, GldiWindowAct
 
 	return GLDI_NOTIFICATION_LET_PASS;
 }
+static void _start_desktop_files_index (void);
+
 void cairo_dock_initialize_class_manager (void)
 {
 	if (s_hClassTable == NULL)
@@ -106,6 +135,7 @@ void cairo_dock_initialize_class_manager (void)
 			g_str_equal,
 			g_free,
 			(GDestroyNotify) cairo_dock_free_class_appli);
+	_start_desktop_files_index ();
 	// register to events to detect the ending of a launching
 	gldi_object_register_notification (&myWindowObjectMgr,
 		NOTIFICATION_WINDOW_CREATED,
@@ -699,6 +729,36 @@ cairo_surface_t *cairo_dock_create_surface_from_class (const gchar *cClass, int
 	return NULL;
 }
 
+gboolean cairo_dock_load_class_image_buffer (CairoDockImageBuffer *pImage, const gchar *cClass, int iWidth, int iHeight)
+{
+	// if the inhibitor that would give its surface has a shared image of the same size, just share it.
+	CairoDockClassAppli *pClassAppli = cairo_dock_get_class (cClass);
+	if (pClassAppli != NULL && ! pClassAppli->bUseXIcon)
+	{
+		GList *pElement;
+		Icon *pInhibitorIcon;
+		for (pElement = pClassAppli->pIconsOfClass; pElement != NULL; pElement = pElement->next)
+		{
+			pInhibitorIcon = pElement->data;
+			if (! CAIRO_DOCK_ICON_TYPE_IS_APPLET (pInhibitorIcon))
+			{
+				if ((pInhibitorIcon->pSubDock == NULL || myIndicatorsParam.bUseClassIndic)  // see cairo_dock_create_surface_from_class()
+				&& pInhibitorIcon->image.iWidth == iWidth && pInhibitorIcon->image.iHeight == iHeight
+				&& cairo_dock_ref_image_buffer (pImage, &pInhibitorIcon->image))
+					return TRUE;
+				break;
+			}
+		}
+	}
+	
+	// otherwise make a copy of the class image.
+	cairo_surface_t *pSurface = cairo_dock_create_surface_from_class (cClass, iWidth, iHeight);
+	if (pSurface == NULL)
+		return FALSE;
+	cairo_dock_load_image_buffer_from_surface (pImage, pSurface, iWidth, iHeight);
+	return TRUE;
+}
+
 /**
 void cairo_dock_update_visibility_on_inhibitors (const gchar *cClass, GldiWindowActor *pAppli, gboolean bIsHidden)
 {
@@ -1595,6 +1655,320 @@ const CairoDockImageBuffer *cairo_dock_get_class_image_buffer (const gchar *cCla
 }
 
 
+  ///////////////////////////
+ /// DESKTOP FILES INDEX ///
+///////////////////////////
+
+static void _free_desktop_file_entry (GldiDesktopFileEntry *pEntry)
+{
+	g_free (pEntry->cPath);
+	g_free (pEntry->cIcon);
+	g_free (pEntry);
+}
+
+static void _free_desktop_files_tables (GldiDesktopFilesIndex *pIndex)
+{
+	if (pIndex->pByWmClass)
+		g_hash_table_destroy (pIndex->pByWmClass);
+	if (pIndex->pByCommand)
+		g_hash_table_destroy (pIndex->pByCommand);
+	if (pIndex->pByIcon)
+		g_hash_table_destroy (pIndex->pByIcon);
+	if (pIndex->pByName)  // last, since it owns the entries.
+		g_hash_table_destroy (pIndex->pByName);
+	g_list_foreach (pIndex->pScannedDirs, (GFunc)g_free, NULL);
+	g_list_free (pIndex->pScannedDirs);
+	pIndex->pByName = pIndex->pByWmClass = pIndex->pByCommand = pIndex->pByIcon = NULL;
+	pIndex->pScannedDirs = NULL;
+}
+
+static inline void _index_desktop_file_key (GHashTable *pTable, gchar *cKey, GldiDesktopFileEntry *pEntry)
+{
+	if (cKey == NULL || *cKey == '\0' || g_hash_table_lookup (pTable, cKey) != NULL)  // the first folder has the priority
+		g_free (cKey);
+	else
+		g_hash_table_insert (pTable, cKey, pEntry);
+}
+
+static void _index_desktop_files_in_dir (GldiDesktopFilesIndex *pIndex, const gchar *cDirPath, GHashTable *pVisitedDirs)
+{
+	// don't read a folder twice (a symlink can point to a parent folder, or to another folder of the list).
+	struct stat buf;
+	if (stat (cDirPath, &buf) != 0)
+		return;
+	gchar *cDirId = g_strdup_printf ("%lu:%lu", (gulong) buf.st_dev, (gulong) buf.st_ino);
+	if (g_hash_table_lookup (pVisitedDirs, cDirId) != NULL)
+	{
+		g_free (cDirId);
+		return;
+	}
+	g_hash_table_insert (pVisitedDirs, cDirId, cDirId);
+	
+	GDir *dir = g_dir_open (cDirPath, 0, NULL);
+	if (dir == NULL)
+		return;
+	pIndex->pScannedDirs = g_list_prepend (pIndex->pScannedDirs, g_strdup (cDirPath));
+	
+	GKeyFile *pKeyFile = g_key_file_new ();
+	GldiDesktopFileEntry *pEntry;
+	const gchar *cFileName;
+	gchar *cPath, *cCommand, *cStartupWMClass;
+	while ((cFileName = g_dir_read_name (dir)) != NULL)
+	{
+		cPath = g_strdup_printf ("%s/%s", cDirPath, cFileName);
+		if (! g_str_has_suffix (cFileName, ".desktop"))
+		{
+			if (g_file_test (cPath, G_FILE_TEST_IS_DIR))  // kde4/, xfce4/, etc
+				_index_desktop_files_in_dir (pIndex, cPath, pVisitedDirs);
+			g_free (cPath);
+			continue;
+		}
+		if (g_hash_table_lookup (pIndex->pByName, cFileName) != NULL  // already found in a folder with a higher priority
+		|| ! g_key_file_load_from_file (pKeyFile, cPath, G_KEY_FILE_NONE, NULL))
+		{
+			g_free (cPath);
+			continue;
+		}
+		
+		pEntry = g_new0 (GldiDesktopFileEntry, 1);
+		pEntry->cPath = cPath;
+		pEntry->cIcon = g_key_file_get_string (pKeyFile, "Desktop Entry", "Icon", NULL);
+		g_hash_table_insert (pIndex->pByName, g_strdup (cFileName), pEntry);
+		
+		cStartupWMClass = g_key_file_get_string (pKeyFile, "Desktop Entry", "StartupWMClass", NULL);
+		if (cStartupWMClass != NULL && *cStartupWMClass != '\0')
+			_index_desktop_file_key (pIndex->pByWmClass, cairo_dock_guess_class (NULL, cStartupWMClass), pEntry);
+		g_free (cStartupWMClass);
+		
+		cCommand = g_key_file_get_string (pKeyFile, "Desktop Entry", "Exec", NULL);
+		if (cCommand != NULL)
+			_index_desktop_file_key (pIndex->pByCommand, cairo_dock_guess_class (cCommand, NULL), pEntry);
+		g_free (cCommand);
+		
+		if (pEntry->cIcon != NULL && *pEntry->cIcon != '/')
+			_index_desktop_file_key (pIndex->pByIcon, g_ascii_strdown (pEntry->cIcon, -1), pEntry);
+	}
+	g_key_file_free (pKeyFile);
+	g_dir_close (dir);
+}
+
+static void _build_desktop_files_index (GldiDesktopFilesIndex *pIndex)  // thread
+{
+	pIndex->pByName = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)_free_desktop_file_entry);
+	pIndex->pByWmClass = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	pIndex->pByCommand = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	pIndex->pByIcon = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	GHashTable *pVisitedDirs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);  // "device:inode" of the folders read
+	int i;
+	for (i = 0; pIndex->pDirs[i] != NULL; i ++)
+		_index_desktop_files_in_dir (pIndex, pIndex->pDirs[i], pVisitedDirs);
+	g_hash_table_destroy (pVisitedDirs);
+}
+
+static void _on_desktop_dir_changed (G_GNUC_UNUSED GFileMonitor *pMonitor, G_GNUC_UNUSED GFile *pFile, G_GNUC_UNUSED GFile *pOtherFile, GFileMonitorEvent iEventType, G_GNUC_UNUSED gpointer data)
+{
+	if (iEventType != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT
+	&& iEventType != G_FILE_MONITOR_EVENT_DELETED
+	&& iEventType != G_FILE_MONITOR_EVENT_CREATED)
+		return;
+	if (gldi_task_is_running (s_pDesktopFilesTask))  // the current scan may have missed this change, do another one after it.
+		s_bDesktopFilesRescanPending = TRUE;
+	else
+		gldi_task_launch_delayed (s_pDesktopFilesTask, GLDI_DESKTOP_FILES_RESCAN_DELAY);
+}
+
+// a folder above a missing applications folder has changed: rescan if the missing folder (or one of its parents) has appeared.
+static void _on_desktop_parent_dir_changed (G_GNUC_UNUSED GFileMonitor *pMonitor, GFile *pFile, G_GNUC_UNUSED GFile *pOtherFile, GFileMonitorEvent iEventType, const gchar *cMissingDir)
+{
+	if (iEventType != G_FILE_MONITOR_EVENT_CREATED)
+		return;
+	gchar *cPath = g_file_get_path (pFile);
+	if (cPath != NULL && g_str_has_prefix (cMissingDir, cPath) && (cMissingDir[strlen (cPath)] == '/' || cMissingDir[strlen (cPath)] == '\0'))
+		_on_desktop_dir_changed (pMonitor, pFile, pOtherFile, iEventType, NULL);
+	g_free (cPath);
+}
+
+static void _watch_desktop_dir (const gchar *cDirPath, const gchar *cMissingDir)
+{
+	if (g_hash_table_lookup (s_hDesktopDirMonitors, cDirPath) != NULL)
+		return;
+	GFile *pDir = g_file_new_for_path (cDirPath);
+	GFileMonitor *pMonitor = g_file_monitor_directory (pDir, G_FILE_MONITOR_NONE, NULL, NULL);
+	g_object_unref (pDir);
+	if (pMonitor == NULL)
+		return;
+	if (cMissingDir != NULL)
+		g_signal_connect_data (pMonitor, "changed", G_CALLBACK (_on_desktop_parent_dir_changed), g_strdup (cMissingDir), (GClosureNotify)g_free, 0);
+	else
+		g_signal_connect (pMonitor, "changed", G_CALLBACK (_on_desktop_dir_changed), NULL);
+	g_hash_table_insert (s_hDesktopDirMonitors, g_strdup (cDirPath), pMonitor);
+}
+
+static void _resolve_pending_class (const gchar *cClass, G_GNUC_UNUSED gpointer data, G_GNUC_UNUSED gpointer unused)
+{
+	CairoDockClassAppli *pClassAppli = _cairo_dock_lookup_class_appli (cClass);
+	if (pClassAppli == NULL || pClassAppli->cDesktopFile != NULL)  // found in the meantime.
+		return;
+	gchar *cResult = cairo_dock_register_class_full (NULL, cClass, NULL);
+	g_free (cResult);
+	if (pClassAppli->cDesktopFile == NULL)  // really not there.
+		return;
+	cd_debug ("class '%s' found after the desktop files were indexed", cClass);
+	
+	// the applis of this class were loaded without it, give them what they missed and redraw them.
+	Icon *pIcon;
+	GList *ic;
+	for (ic = pClassAppli->pAppliOfClass; ic != NULL; ic = ic->next)
+	{
+		pIcon = ic->data;
+		if (pIcon->cCommand == NULL)
+			pIcon->cCommand = g_strdup (pClassAppli->cCommand);
+		if (pIcon->pMimeTypes == NULL)
+			pIcon->pMimeTypes = g_strdupv ((gchar**)pClassAppli->pMimeTypes);
+		if (cairo_dock_get_icon_container (pIcon) != NULL)
+			cairo_dock_reload_icon_image (pIcon, cairo_dock_get_icon_container (pIcon));
+	}
+}
+
+static gboolean _update_desktop_files_index (GldiDesktopFilesIndex *pIndex)
+{
+	// swap the new index with the current one.
+	GldiDesktopFilesIndex *pOldIndex = s_pDesktopFilesIndex;
+	s_pDesktopFilesIndex = g_new0 (GldiDesktopFilesIndex, 1);
+	memcpy (s_pDesktopFilesIndex, pIndex, sizeof (GldiDesktopFilesIndex));
+	s_pDesktopFilesIndex->pDirs = NULL;
+	pIndex->pByName = pIndex->pByWmClass = pIndex->pByCommand = pIndex->pByIcon = NULL;
+	pIndex->pScannedDirs = NULL;
+	if (pOldIndex != NULL)
+	{
+		_free_desktop_files_tables (pOldIndex);
+		g_free (pOldIndex);
+	}
+	cd_debug ("%d desktop files indexed", g_hash_table_size (s_pDesktopFilesIndex->pByName));
+	
+	// watch the folders that we didn't watch yet.
+	GList *d;
+	for (d = s_pDesktopFilesIndex->pScannedDirs; d != NULL; d = d->next)
+		_watch_desktop_dir (d->data, NULL);
+	
+	// for the applications folders that don't exist yet, watch the first parent that does, so that we know when they appear.
+	int i;
+	for (i = 0; pIndex->pDirs[i] != NULL; i ++)
+	{
+		if (g_file_test (pIndex->pDirs[i], G_FILE_TEST_IS_DIR))
+			continue;
+		gchar *cParentDir = g_path_get_dirname (pIndex->pDirs[i]), *cDir;
+		while (! g_file_test (cParentDir, G_FILE_TEST_IS_DIR) && strcmp (cParentDir, "/") != 0 && strcmp (cParentDir, ".") != 0)
+		{
+			cDir = cParentDir;
+			cParentDir = g_path_get_dirname (cDir);
+			g_free (cDir);
+		}
+		if (g_file_test (cParentDir, G_FILE_TEST_IS_DIR))
+			_watch_desktop_dir (cParentDir, pIndex->pDirs[i]);
+		g_free (cParentDir);
+	}
+	
+	// the classes that were missed while we were indexing can now be searched properly.
+	if (s_hPendingClasses != NULL)
+	{
+		GHashTable *pPendingClasses = s_hPendingClasses;
+		s_hPendingClasses = NULL;  // from now on, the index is used.
+		g_hash_table_foreach (pPendingClasses, (GHFunc) _resolve_pending_class, NULL);
+		g_hash_table_destroy (pPendingClasses);
+	}
+	
+	if (s_bDesktopFilesRescanPending)
+	{
+		s_bDesktopFilesRescanPending = FALSE;
+		gldi_task_launch_delayed (s_pDesktopFilesTask, GLDI_DESKTOP_FILES_RESCAN_DELAY);
+	}
+	return FALSE;
+}
+
+static void _free_desktop_files_index (GldiDesktopFilesIndex *pIndex)
+{
+	_free_desktop_files_tables (pIndex);
+	g_strfreev (pIndex->pDirs);
+	g_free (pIndex);
+}
+
+static void _start_desktop_files_index (void)
+{
+	if (s_pDesktopFilesTask != NULL)
+		return;
+	// $XDG_DATA_HOME/applications first, then $XDG_DATA_DIRS/applications, as the spec says.
+	const gchar * const *pSystemDirs = g_get_system_data_dirs ();
+	int i, n = 0;
+	for (i = 0; pSystemDirs[i] != NULL; i ++)
+		n ++;
+	GldiDesktopFilesIndex *pIndex = g_new0 (GldiDesktopFilesIndex, 1);
+	pIndex->pDirs = g_new0 (gchar*, n + 2);
+	pIndex->pDirs[0] = g_strdup_printf ("%s/applications", g_get_user_data_dir ());
+	for (i = 0; i < n; i ++)
+		pIndex->pDirs[i+1] = g_strdup_printf ("%s/applications", pSystemDirs[i]);
+	
+	s_pDesktopFilesDirs = pIndex->pDirs;
+	s_hDesktopDirMonitors = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+	s_hPendingClasses = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	s_pDesktopFilesTask = gldi_task_new_full (0,
+		(GldiGetDataAsyncFunc) _build_desktop_files_index,
+		(GldiUpdateSyncFunc) _update_desktop_files_index,
+		(GFreeFunc) _free_desktop_files_index,
+		pIndex);
+	gldi_task_launch (s_pDesktopFilesTask);
+}
+
+static gchar *_search_desktop_file_in_index (const gchar *cDesktopFile, const gchar *cFileName)
+{
+	GldiDesktopFilesIndex *pIndex = s_pDesktopFilesIndex;
+	GldiDesktopFileEntry *pEntry = g_hash_table_lookup (pIndex->pByName, cFileName);
+	if (pEntry == NULL)
+	{
+		gchar *cCapitalizedName = g_strdup (cFileName);
+		*cCapitalizedName = g_ascii_toupper (*cCapitalizedName);  // handle stupid cases like Thunar.desktop
+		pEntry = g_hash_table_lookup (pIndex->pByName, cCapitalizedName);
+		g_free (cCapitalizedName);
+	}
+	if (pEntry == NULL && *cDesktopFile != '/' && ! g_str_has_suffix (cDesktopFile, ".desktop"))  // we were given a class, let's see if a .desktop file claims it.
+	{
+		pEntry = g_hash_table_lookup (pIndex->pByWmClass, cDesktopFile);
+		if (pEntry == NULL)
+			pEntry = g_hash_table_lookup (pIndex->pByCommand, cDesktopFile);
+		if (pEntry == NULL)
+			pEntry = g_hash_table_lookup (pIndex->pByIcon, cDesktopFile);
+	}
+	return (pEntry ? g_strdup (pEntry->cPath) : NULL);
+}
+
+static gchar *_probe_desktop_file (const gchar *cFileName)
+{
+	const gchar *cSubDirs[] = {"", "xfce4/", "kde4/", NULL};
+	gchar **pDirs = s_pDesktopFilesDirs;
+	if (pDirs == NULL)
+		return NULL;
+	gchar *cCapitalizedName = g_strdup (cFileName);
+	*cCapitalizedName = g_ascii_toupper (*cCapitalizedName);  // handle stupid cases like Thunar.desktop
+	GString *sDesktopFilePath = g_string_new ("");
+	gboolean bFound = FALSE;
+	int i, j;
+	for (i = 0; pDirs[i] != NULL && ! bFound; i ++)
+	{
+		for (j = 0; cSubDirs[j] != NULL && ! bFound; j ++)
+		{
+			g_string_printf (sDesktopFilePath, "%s/%s%s", pDirs[i], cSubDirs[j], cFileName);
+			bFound = g_file_test (sDesktopFilePath->str, G_FILE_TEST_EXISTS);
+			if (! bFound && *cSubDirs[j] == '\0')
+			{
+				g_string_printf (sDesktopFilePath, "%s/%s", pDirs[i], cCapitalizedName);
+				bFound = g_file_test (sDesktopFilePath->str, G_FILE_TEST_EXISTS);
+			}
+		}
+	}
+	g_free (cCapitalizedName);
+	return g_string_free (sDesktopFilePath, ! bFound);
+}
+
 static gchar *_search_desktop_file (const gchar *cDesktopFile)  // file, path or even class
 {
 	if (cDesktopFile == NULL)
@@ -1611,42 +1985,12 @@ static gchar *_search_desktop_file (const gchar *cDesktopFile)  // file, path or
 		cDesktopFileName = g_strdup_printf ("%s.desktop", cDesktopFile);
 
 	const gchar *cFileName = (cDesktopFileName ? cDesktopFileName : cDesktopFile);
-	gboolean bFound = TRUE;
-	GString *sDesktopFilePath = g_string_new ("");
-	g_string_printf (sDesktopFilePath, "/usr/share/applications/%s", cFileName);
-	if (! g_file_test (sDesktopFilePath->str, G_FILE_TEST_EXISTS))
-	{
-		g_string_printf (sDesktopFilePath, "/usr/share/applications/%c%s", g_ascii_toupper (*cFileName), cFileName+1);  // handle stupid cases like Thunar.desktop
-		if (! g_file_test (sDesktopFilePath->str, G_FILE_TEST_EXISTS))
-		{
-			g_string_printf (sDesktopFilePath, "/usr/share/applications/xfce4/%s", cFileName);
-			if (! g_file_test (sDesktopFilePath->str, G_FILE_TEST_EXISTS))
-			{
-				g_string_printf (sDesktopFilePath, "/usr/share/applications/kde4/%s", cFileName);
-				if (! g_file_test (sDesktopFilePath->str, G_FILE_TEST_EXISTS))
-				{
-					g_string_printf (sDesktopFilePath, "%s/.local/share/applications/%s", g_getenv ("HOME"), cFileName);
-					if (! g_file_test (sDesktopFilePath->str, G_FILE_TEST_EXISTS))
-					{
-						bFound = FALSE;
-					}
-				}
-			}
-		}
-	}
-	g_free (cDesktopFileName);
-
 	gchar *cResult;
-	if (bFound)
-	{
-		cResult = sDesktopFilePath->str;
-		g_string_free (sDesktopFilePath, FALSE);
-	}
-	else
-	{
-		cResult = NULL;
-		g_string_free (sDesktopFilePath, TRUE);
-	}
+	if (s_pDesktopFilesIndex != NULL)
+		cResult = _search_desktop_file_in_index (cDesktopFile, cFileName);
+	else  // we're starting and the thread has not finished yet: don't block, just look at the usual places; the classes we miss will be searched again once the index is ready.
+		cResult = _probe_desktop_file (cFileName);
+	g_free (cDesktopFileName);
 	return cResult;
 }
 
@@ -1877,6 +2221,8 @@ gchar *cairo_dock_register_class_full (const gchar *cDesktopFile, const gchar *c
 					pClassAppli->cStartupWMClass = g_strdup (cWmClass);
 				//g_print ("%s ---> %s\n", cClass, pClassAppli->cStartupWMClass);
 				pClassAppli->bSearchedAttributes = TRUE;
+				if (s_pDesktopFilesIndex == NULL && s_hPendingClasses != NULL)  // not indexed yet, we'll search it again once it is.
+					g_hash_table_insert (s_hPendingClasses, g_strdup (cClass), GINT_TO_POINTER (1));
 			}
 		}
 		cd_debug ("couldn't find the desktop file %s", cDesktopFile?cDesktopFile:cClass);
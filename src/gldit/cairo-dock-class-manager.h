@@ -162,6 +162,15 @@ void cairo_dock_reset_class_table (void);
 */
 cairo_surface_t *cairo_dock_create_surface_from_class (const gchar *cClass, int iWidth, int ifHeight);
 
+/** Load the image of a class into an ImageBuffer, the same way as \ref cairo_dock_create_surface_from_class. If the image comes from an inhibitor whose image is shared and has the same size, it is shared rather than copied.
+*@param pImage an ImageBuffer.
+*@param cClass the class.
+*@param iWidth width of the image.
+*@param iHeight height of the image.
+*@return TRUE if an image has been loaded, FALSE if the class has no image of its own or explicitely wants the X icons.
+*/
+gboolean cairo_dock_load_class_image_buffer (CairoDockImageBuffer *pImage, const gchar *cClass, int iWidth, int iHeight);
+
 
 /** Run a function on each Icon that inhibites a given window.
 *@param actor the window actor
@@ -58,6 +58,8 @@ static gboolean s_bInitialOpacity0 = TRUE;  // set initial window opacity to 0,
 static gboolean s_bNoComposite = FALSE;
 static GldiContainerManagerBackend s_backend;
 
+#define GLDI_CONTAINER_MAX_DAMAGE_RECTS 8  // above, the damage is reduced to its extents, it's cheaper than clipping to many small rectangles
+
 
 void cairo_dock_set_containers_non_sticky (void)
 {
@@ -158,6 +160,18 @@ void cairo_dock_redraw_container (GldiContainer *pContainer)
 	cairo_dock_redraw_container_area (pContainer, &rect);
 }
 
+static gboolean _flush_damage (GldiContainer *pContainer)
+{
+	pContainer->iSidFlushDamage = 0;
+	if (pContainer->pDamage != NULL)
+	{
+		if (gldi_container_is_visible (pContainer))
+			gdk_window_invalidate_region (gldi_container_get_gdk_window (pContainer), pContainer->pDamage, FALSE);
+		// keep it until the container is redrawn, it may want to know what has changed (see gldi_container_take_damage).
+	}
+	return FALSE;
+}
+
 static inline void _redraw_container_area (GldiContainer *pContainer, GdkRectangle *pArea)
 {
 	g_return_if_fail (pContainer != NULL);
@@ -171,8 +185,24 @@ static inline void _redraw_container_area (GldiContainer *pContainer, GdkRectang
 	else if (! pContainer->bIsHorizontal && pArea->x + pArea->width > pContainer->iHeight)
 		pArea->width = pContainer->iHeight - pArea->x;
 	
-	if (pArea->width > 0 && pArea->height > 0)
-		gdk_window_invalidate_rect (gldi_container_get_gdk_window (pContainer), pArea, FALSE);
+	if (pArea->width <= 0 || pArea->height <= 0)
+		return;
+	// accumulate it, it will be redrawn at once with all the other areas damaged before the next frame.
+	if (pContainer->pDamage == NULL)
+		pContainer->pDamage = cairo_region_create_rectangle (pArea);
+	else
+	{
+		cairo_region_union_rectangle (pContainer->pDamage, pArea);
+		if (cairo_region_num_rectangles (pContainer->pDamage) > GLDI_CONTAINER_MAX_DAMAGE_RECTS)
+		{
+			cairo_rectangle_int_t extents;
+			cairo_region_get_extents (pContainer->pDamage, &extents);
+			cairo_region_destroy (pContainer->pDamage);
+			pContainer->pDamage = cairo_region_create_rectangle (&extents);
+		}
+	}
+	if (pContainer->iSidFlushDamage == 0)
+		pContainer->iSidFlushDamage = g_idle_add_full (GDK_PRIORITY_REDRAW - 10, (GSourceFunc)_flush_damage, pContainer, NULL);  // just before GDK redraws the windows.
 }
 
 void cairo_dock_redraw_container_area (GldiContainer *pContainer, GdkRectangle *pArea)
@@ -197,6 +227,28 @@ void cairo_dock_redraw_icon (Icon *icon)
 	_redraw_container_area (pContainer, &rect);
 }
 
+static gboolean _forget_damage (G_GNUC_UNUSED GtkWidget *pWidget, G_GNUC_UNUSED cairo_t *pCairoContext, GldiContainer *pContainer)
+{
+	GdkRectangle extents;
+	gldi_container_take_damage (pContainer, &extents);  // the container has been drawn, the damage is now on the screen.
+	return FALSE;
+}
+
+gboolean gldi_container_take_damage (GldiContainer *pContainer, GdkRectangle *pExtents)
+{
+	if (pContainer->iSidFlushDamage != 0)  // the container is drawn before the damage has been flushed (the flush normally comes just before), invalidate it now so that nothing is lost.
+	{
+		g_source_remove (pContainer->iSidFlushDamage);
+		_flush_damage (pContainer);
+	}
+	if (pContainer->pDamage == NULL)
+		return FALSE;
+	cairo_region_get_extents (pContainer->pDamage, pExtents);
+	cairo_region_destroy (pContainer->pDamage);
+	pContainer->pDamage = NULL;
+	return TRUE;
+}
+
 
 void cairo_dock_allow_widget_to_receive_data (GtkWidget *pWidget, GCallback pCallBack, gpointer data)
 {
@@ -539,6 +591,10 @@ static void init_object (GldiObject *obj, gpointer attr)
 		"realize",
 		G_CALLBACK (_remove_background),
 		pContainer);
+	g_signal_connect_after (G_OBJECT (pWindow),
+		"draw",
+		G_CALLBACK (_forget_damage),
+		pContainer);  // after the drawing of the container, which may have used it.
 
 	// remove the resize grip added by gtk3
 	gtk_window_set_has_resize_grip (GTK_WINDOW(pWindow), FALSE);
@@ -565,6 +621,16 @@ static void reset_object (GldiObject *obj)
 		g_source_remove (pContainer->iSidGLAnimation);
 		pContainer->iSidGLAnimation = 0;
 	}
+	if (pContainer->iSidFlushDamage != 0)
+	{
+		g_source_remove (pContainer->iSidFlushDamage);
+		pContainer->iSidFlushDamage = 0;
+	}
+	if (pContainer->pDamage != NULL)
+	{
+		cairo_region_destroy (pContainer->pDamage);
+		pContainer->pDamage = NULL;
+	}
 	
 	if (g_pPrimaryContainer == pContainer)
 		g_pPrimaryContainer = NULL;
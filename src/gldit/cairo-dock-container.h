@@ -162,7 +162,13 @@ struct _GldiContainer {
 	GldiContainerInterface iface;
 	
 	gboolean bIgnoreNextReleaseEvent;
-	gpointer reserved[4];
+	/// region damaged since the container was last drawn, redrawn at once before the next frame (NULL if none).
+	cairo_region_t *pDamage;
+	/// source that invalidates the damaged region on the window.
+	guint iSidFlushDamage;
+	/// number of steps of the current animation, of steps that missed their frame, and of frames dropped because of it.
+	guint iNbFrames, iNbLateFrames, iNbDroppedFrames;
+	gpointer reserved[1];
 };
 
 
@@ -283,6 +289,13 @@ void cairo_dock_redraw_container_area (GldiContainer *pContainer, GdkRectangle *
 */
 void cairo_dock_redraw_icon (Icon *icon);
 
+/** Get the extents of the areas of a Container that have been redrawn since it was last drawn, and forget them. All the redraws of a container (icons, areas, the whole container) are accumulated until the next frame, where they're invalidated at once; the container calls this function when it draws itself, to limit the drawing to what has changed.
+*@param pContainer the Container.
+*@param pExtents filled with the extents of the damaged region.
+*@return FALSE if nothing has been damaged (the container is drawn because of an expose event from the window system).
+*/
+gboolean gldi_container_take_damage (GldiContainer *pContainer, GdkRectangle *pExtents);
+
 
 void cairo_dock_allow_widget_to_receive_data (GtkWidget *pWidget, GCallback pCallBack, gpointer data);
 
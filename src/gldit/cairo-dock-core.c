@@ -56,6 +56,7 @@
 #include "cairo-dock-overlay.h"
 #include "cairo-dock-log.h"
 #include "cairo-dock-opengl.h"
+#include "cairo-dock-dbus.h"  // cairo_dock_dbus_export_notification_profiler, cairo_dock_dbus_export_runtime_stats
 #include "cairo-dock-core.h"
 
 extern GldiContainer *g_pPrimaryContainer;
@@ -106,6 +107,10 @@ void gldi_init (GldiRenderingMethod iRendering)
 	
 	gldi_managers_init ();
 	
+	// let the notifications be profiled from the outside.
+	cairo_dock_dbus_export_notification_profiler ();
+	cairo_dock_dbus_export_runtime_stats ();
+	
 	// register internal backends.
 	cairo_dock_register_built_in_data_renderers ();
 	
@@ -296,7 +296,7 @@ void cairo_dock_render_overlays_to_context (CairoDataRenderer *pRenderer, int iN
 
 static void _cairo_dock_render_to_context (CairoDataRenderer *pRenderer, Icon *pIcon, GldiContainer *pContainer, cairo_t *pCairoContext)
 {
-	cairo_t *ctx = NULL;
+	cairo_t *ctx = NULL, *pCallerContext = pCairoContext;
 	if (pRenderer->bUseOverlay && pRenderer->pOverlay != NULL)
 	{
 		CairoDataToRenderer *pData = cairo_data_renderer_get_data (pRenderer);
@@ -347,7 +347,7 @@ static void _cairo_dock_render_to_context (CairoDataRenderer *pRenderer, Icon *p
 			cairo_dock_update_icon_texture (pIcon);
 	}*/
 	
-	if (ctx != pCairoContext)
+	if (ctx != pCallerContext)
 		cairo_destroy (ctx);
 }
 
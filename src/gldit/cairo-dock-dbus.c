@@ -21,6 +21,14 @@
 #include <glib.h>
 
 #include "cairo-dock-log.h"
+#include "cairo-dock-object.h"  // notifications profiler
+#include "cairo-dock-task.h"  // gldi_task_get_nb_wheel_wakeups, gldi_task_get_nb_completion_wakeups, gldi_task_start_benchmark
+#include "cairo-dock-dock-facility.h"  // cairo_dock_get_wave_stats_linear
+#include "cairo-dock-windows-manager.h"  // gldi_windows_get_new_windows_stats, gldi_windows_get_events_stats, gldi_windows_foreach
+#include "cairo-dock-dock-visibility.h"  // gldi_docks_get_overlap_stats
+#include "cairo-dock-image-buffer.h"  // cairo_dock_get_shared_images_stats, cairo_dock_get_text_cache_stats
+#include "cairo-dock-animations.h"  // cairo_dock_get_animation_frames_stats
+#include "cairo-dock-applet-facility.h"  // cairo_dock_test_draw_on_shared_icon
 #include "cairo-dock-dbus.h"
 
 static DBusGConnection *s_pSessionConnexion = NULL;
@@ -717,3 +725,268 @@ void cairo_dock_dbus_set_boolean_property_with_timeout (DBusGProxy *pDbusProxy,
 	cairo_dock_dbus_set_property_with_timeout (pDbusProxy, cInterface, cProperty, &v, iTimeOut);
 }
 
+
+  //////////////////////////////
+ /// NOTIFICATIONS PROFILER ///
+//////////////////////////////
+
+#define CD_PROFILER_DBUS_PATH "/org/cairodock/CairoDock/NotificationProfiler"
+#define CD_PROFILER_DBUS_INTERFACE "org.cairodock.CairoDock.NotificationProfiler"
+
+static const gchar *s_cProfilerIntrospectionXml =
+	"<!DOCTYPE node PUBLIC \"-//freedesktop//DTD D-BUS Object Introspection 1.0//EN\" \"http://www.freedesktop.org/standards/dbus/1.0/introspect.dtd\">\n"
+	"<node>\n"
+	"  <interface name=\"" DBUS_INTERFACE_INTROSPECTABLE "\">\n"
+	"    <method name=\"Introspect\"><arg name=\"data\" direction=\"out\" type=\"s\"/></method>\n"
+	"  </interface>\n"
+	"  <interface name=\"" CD_PROFILER_DBUS_INTERFACE "\">\n"
+	"    <method name=\"Enable\"><arg name=\"enable\" direction=\"in\" type=\"b\"/></method>\n"
+	"    <method name=\"Reset\"/>\n"
+	"    <method name=\"GetStats\"><arg name=\"stats\" direction=\"out\" type=\"s\"/></method>\n"
+	"    <method name=\"GetHistory\"><arg name=\"history\" direction=\"out\" type=\"s\"/></method>\n"
+	"    <method name=\"TestDestroyDuringNotification\"><arg name=\"calls\" direction=\"out\" type=\"s\"/></method>\n"
+	"  </interface>\n"
+	"</node>\n";
+
+static DBusMessage *_reply_with_string (DBusMessage *pMessage, const gchar *cString)
+{
+	DBusMessage *pReply = dbus_message_new_method_return (pMessage);
+	dbus_message_append_args (pReply, DBUS_TYPE_STRING, &cString, DBUS_TYPE_INVALID);
+	return pReply;
+}
+
+static DBusHandlerResult _on_profiler_message (DBusConnection *pConnection, DBusMessage *pMessage, G_GNUC_UNUSED void *data)
+{
+	DBusMessage *pReply;
+	if (dbus_message_is_method_call (pMessage, CD_PROFILER_DBUS_INTERFACE, "Enable"))
+	{
+		dbus_bool_t bEnable = FALSE;
+		if (dbus_message_get_args (pMessage, NULL, DBUS_TYPE_BOOLEAN, &bEnable, DBUS_TYPE_INVALID))
+		{
+			gldi_object_set_notification_profiling (bEnable);
+			pReply = dbus_message_new_method_return (pMessage);
+		}
+		else
+			pReply = dbus_message_new_error (pMessage, DBUS_ERROR_INVALID_ARGS, "a boolean is expected");
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_RUNTIME_STATS_DBUS_INTERFACE, "TestDrawOnSharedIcon"))
+	{
+		gboolean bDrawn, bOtherUntouched;
+		cairo_dock_test_draw_on_shared_icon (&bDrawn, &bOtherUntouched);
+		gchar *cResult = g_strdup_printf ("%d\t%d", bDrawn, bOtherUntouched);
+		pReply = _reply_with_string (pMessage, cResult);
+		g_free (cResult);
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_PROFILER_DBUS_INTERFACE, "Reset"))
+	{
+		gldi_object_reset_notification_profile ();
+		pReply = dbus_message_new_method_return (pMessage);
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_PROFILER_DBUS_INTERFACE, "GetStats"))
+	{
+		gchar *cStats = gldi_object_dump_notification_profile ();
+		pReply = _reply_with_string (pMessage, cStats);
+		g_free (cStats);
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_PROFILER_DBUS_INTERFACE, "GetHistory"))
+	{
+		gchar *cHistory = gldi_object_dump_notification_history ();
+		pReply = _reply_with_string (pMessage, cHistory);
+		g_free (cHistory);
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_PROFILER_DBUS_INTERFACE, "TestDestroyDuringNotification"))
+	{
+		guint iNbCalls, iNbCallsAfterDestroy;
+		gldi_object_test_destroy_during_notification (&iNbCalls, &iNbCallsAfterDestroy);
+		gchar *cCalls = g_strdup_printf ("%u\t%u", iNbCalls, iNbCallsAfterDestroy);
+		pReply = _reply_with_string (pMessage, cCalls);
+		g_free (cCalls);
+	}
+	else if (dbus_message_is_method_call (pMessage, DBUS_INTERFACE_INTROSPECTABLE, "Introspect"))
+	{
+		pReply = _reply_with_string (pMessage, s_cProfilerIntrospectionXml);
+	}
+	else
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+	
+	dbus_connection_send (pConnection, pReply, NULL);
+	dbus_message_unref (pReply);
+	return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+void cairo_dock_dbus_export_notification_profiler (void)
+{
+	DBusGConnection *pConnection = cairo_dock_get_session_connection ();
+	if (pConnection == NULL)
+		return;
+	static const DBusObjectPathVTable vtable = {NULL, _on_profiler_message, NULL, NULL, NULL, NULL};
+	if (! dbus_connection_register_object_path (dbus_g_connection_get_connection (pConnection), CD_PROFILER_DBUS_PATH, &vtable, NULL))
+		cd_warning ("couldn't export the notifications profiler on the bus");
+}
+
+
+  /////////////////////
+ /// RUNTIME STATS ///
+/////////////////////
+
+#define CD_RUNTIME_STATS_DBUS_PATH "/org/cairodock/CairoDock/RuntimeStats"
+#define CD_RUNTIME_STATS_DBUS_INTERFACE "org.cairodock.CairoDock.RuntimeStats"
+
+static const gchar *s_cRuntimeStatsIntrospectionXml =
+	"<!DOCTYPE node PUBLIC \"-//freedesktop//DTD D-BUS Object Introspection 1.0//EN\" \"http://www.freedesktop.org/standards/dbus/1.0/introspect.dtd\">\n"
+	"<node>\n"
+	"  <interface name=\"" DBUS_INTERFACE_INTROSPECTABLE "\">\n"
+	"    <method name=\"Introspect\"><arg name=\"data\" direction=\"out\" type=\"s\"/></method>\n"
+	"  </interface>\n"
+	"  <interface name=\"" CD_RUNTIME_STATS_DBUS_INTERFACE "\">\n"
+	"    <method name=\"GetTaskStats\"><arg name=\"stats\" direction=\"out\" type=\"s\"/></method>\n"
+	"    <method name=\"StartTaskBenchmark\"><arg name=\"nb_tasks\" direction=\"in\" type=\"i\"/><arg name=\"period\" direction=\"in\" type=\"i\"/><arg name=\"job_duration\" direction=\"in\" type=\"i\"/></method>\n"
+	"    <method name=\"StopTaskBenchmark\"><arg name=\"stats\" direction=\"out\" type=\"s\"/></method>\n"
+	"    <method name=\"GetWaveStats\"><arg name=\"stats\" direction=\"out\" type=\"s\"/></method>\n"
+	"    <method name=\"GetNewWindowsStats\"><arg name=\"stats\" direction=\"out\" type=\"s\"/></method>\n"
+	"    <method name=\"GetOverlapStats\"><arg name=\"stats\" direction=\"out\" type=\"s\"/></method>\n"
+	"    <method name=\"GetSharedImagesStats\"><arg name=\"stats\" direction=\"out\" type=\"s\"/></method>\n"
+	"    <method name=\"GetTextCacheStats\"><arg name=\"stats\" direction=\"out\" type=\"s\"/></method>\n"
+	"    <method name=\"GetFramesStats\"><arg name=\"stats\" direction=\"out\" type=\"s\"/></method>\n"
+	"    <method name=\"GetEventsStats\"><arg name=\"stats\" direction=\"out\" type=\"s\"/></method>\n"
+	"    <method name=\"GetWindowsOrder\"><arg name=\"by_z\" direction=\"in\" type=\"b\"/><arg name=\"windows\" direction=\"out\" type=\"s\"/></method>\n"
+	"    <method name=\"TestDrawOnSharedIcon\"><arg name=\"result\" direction=\"out\" type=\"s\"/></method>\n"
+	"  </interface>\n"
+	"</node>\n";
+
+static void _append_window_id (GldiWindowActor *actor, GString *sIds)
+{
+	g_string_append_printf (sIds, "%s%u", sIds->len != 0 ? "\t" : "", gldi_window_get_id (actor));
+}
+
+static DBusHandlerResult _on_runtime_stats_message (DBusConnection *pConnection, DBusMessage *pMessage, G_GNUC_UNUSED void *data)
+{
+	DBusMessage *pReply;
+	if (dbus_message_is_method_call (pMessage, CD_RUNTIME_STATS_DBUS_INTERFACE, "GetTaskStats"))
+	{
+		gchar *cStats = g_strdup_printf ("%u\t%u",
+			gldi_task_get_nb_wheel_wakeups (),
+			gldi_task_get_nb_completion_wakeups ());
+		pReply = _reply_with_string (pMessage, cStats);
+		g_free (cStats);
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_RUNTIME_STATS_DBUS_INTERFACE, "StartTaskBenchmark"))
+	{
+		dbus_int32_t iNbTasks = 0, iPeriod = 0, iJobDuration = 0;
+		if (dbus_message_get_args (pMessage, NULL, DBUS_TYPE_INT32, &iNbTasks, DBUS_TYPE_INT32, &iPeriod, DBUS_TYPE_INT32, &iJobDuration, DBUS_TYPE_INVALID)
+		&& iNbTasks >= 0 && iNbTasks <= 1000 && iPeriod > 0 && iJobDuration >= 0)
+		{
+			gldi_task_start_benchmark (iNbTasks, iPeriod, iJobDuration);
+			pReply = dbus_message_new_method_return (pMessage);
+		}
+		else
+			pReply = dbus_message_new_error (pMessage, DBUS_ERROR_INVALID_ARGS, "3 positive integers are expected");
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_RUNTIME_STATS_DBUS_INTERFACE, "StopTaskBenchmark"))
+	{
+		gchar *cStats = g_strdup_printf ("%u", gldi_task_stop_benchmark ());
+		pReply = _reply_with_string (pMessage, cStats);
+		g_free (cStats);
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_RUNTIME_STATS_DBUS_INTERFACE, "GetWaveStats"))
+	{
+		CairoDockWaveStats stats;
+		cairo_dock_get_wave_stats_linear (&stats);
+		gchar *cStats = g_strdup_printf ("%u\t%u\t%" G_GINT64_FORMAT,
+			stats.iNbWaves,
+			stats.iNbIncrementalWaves,
+			stats.iTotalTime);
+		pReply = _reply_with_string (pMessage, cStats);
+		g_free (cStats);
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_RUNTIME_STATS_DBUS_INTERFACE, "GetNewWindowsStats"))
+	{
+		guint iNbWindows;
+		gint64 iTotalTime;
+		gldi_windows_get_new_windows_stats (&iNbWindows, &iTotalTime);
+		gchar *cStats = g_strdup_printf ("%u\t%" G_GINT64_FORMAT, iNbWindows, iTotalTime);
+		pReply = _reply_with_string (pMessage, cStats);
+		g_free (cStats);
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_RUNTIME_STATS_DBUS_INTERFACE, "GetOverlapStats"))
+	{
+		guint iNbQueries, iNbTestedWindows, iNbOverlaps;
+		gldi_docks_get_overlap_stats (&iNbQueries, &iNbTestedWindows, &iNbOverlaps);
+		gchar *cStats = g_strdup_printf ("%u\t%u\t%u", iNbQueries, iNbTestedWindows, iNbOverlaps);
+		pReply = _reply_with_string (pMessage, cStats);
+		g_free (cStats);
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_RUNTIME_STATS_DBUS_INTERFACE, "GetSharedImagesStats"))
+	{
+		CairoDockSharedImagesStats stats;
+		cairo_dock_get_shared_images_stats (&stats);
+		gchar *cStats = g_strdup_printf ("%d\t%d\t%" G_GSIZE_FORMAT "\t%" G_GSIZE_FORMAT,
+			stats.iNbImages,
+			stats.iNbReferences,
+			stats.iMemoryUsed,
+			stats.iMemorySaved);
+		pReply = _reply_with_string (pMessage, cStats);
+		g_free (cStats);
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_RUNTIME_STATS_DBUS_INTERFACE, "GetTextCacheStats"))
+	{
+		CairoDockTextCacheStats stats;
+		cairo_dock_get_text_cache_stats (&stats);
+		gchar *cStats = g_strdup_printf ("%d\t%d\t%u\t%u",
+			stats.iNbTexts,
+			stats.iNbUnusedTexts,
+			stats.iNbHits,
+			stats.iNbMisses);
+		pReply = _reply_with_string (pMessage, cStats);
+		g_free (cStats);
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_RUNTIME_STATS_DBUS_INTERFACE, "GetFramesStats"))
+	{
+		guint iNbFrames, iNbLateFrames, iNbDroppedFrames;
+		cairo_dock_get_animation_frames_stats (&iNbFrames, &iNbLateFrames, &iNbDroppedFrames);
+		gchar *cStats = g_strdup_printf ("%u\t%u\t%u", iNbFrames, iNbLateFrames, iNbDroppedFrames);
+		pReply = _reply_with_string (pMessage, cStats);
+		g_free (cStats);
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_RUNTIME_STATS_DBUS_INTERFACE, "GetEventsStats"))
+	{
+		gulong iNbEvents, iNbCoalescedEvents;
+		gldi_windows_get_events_stats (&iNbEvents, &iNbCoalescedEvents);
+		gchar *cStats = g_strdup_printf ("%lu\t%lu", iNbEvents, iNbCoalescedEvents);
+		pReply = _reply_with_string (pMessage, cStats);
+		g_free (cStats);
+	}
+	else if (dbus_message_is_method_call (pMessage, CD_RUNTIME_STATS_DBUS_INTERFACE, "GetWindowsOrder"))
+	{
+		dbus_bool_t bOrderedByZ = FALSE;
+		if (dbus_message_get_args (pMessage, NULL, DBUS_TYPE_BOOLEAN, &bOrderedByZ, DBUS_TYPE_INVALID))
+		{
+			GString *sIds = g_string_new ("");
+			gldi_windows_foreach (bOrderedByZ, (GFunc) _append_window_id, sIds);
+			pReply = _reply_with_string (pMessage, sIds->str);
+			g_string_free (sIds, TRUE);
+		}
+		else
+			pReply = dbus_message_new_error (pMessage, DBUS_ERROR_INVALID_ARGS, "a boolean is expected");
+	}
+	else if (dbus_message_is_method_call (pMessage, DBUS_INTERFACE_INTROSPECTABLE, "Introspect"))
+	{
+		pReply = _reply_with_string (pMessage, s_cRuntimeStatsIntrospectionXml);
+	}
+	else
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+	
+	dbus_connection_send (pConnection, pReply, NULL);
+	dbus_message_unref (pReply);
+	return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+void cairo_dock_dbus_export_runtime_stats (void)
+{
+	DBusGConnection *pConnection = cairo_dock_get_session_connection ();
+	if (pConnection == NULL)
+		return;
+	static const DBusObjectPathVTable vtable = {NULL, _on_runtime_stats_message, NULL, NULL, NULL, NULL};
+	if (! dbus_connection_register_object_path (dbus_g_connection_get_connection (pConnection), CD_RUNTIME_STATS_DBUS_PATH, &vtable, NULL))
+		cd_warning ("couldn't export the runtime statistics on the bus");
+}
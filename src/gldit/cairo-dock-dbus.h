@@ -198,5 +198,13 @@ void cairo_dock_dbus_set_property_with_timeout (DBusGProxy *pDbusProxy, const gc
 void cairo_dock_dbus_set_boolean_property_with_timeout (DBusGProxy *pDbusProxy, const gchar *cInterface, const gchar *cProperty, gboolean bValue, gint iTimeOut);
 
 
+/** Export the notifications profiler on the session bus, under the path /org/cairodock/CairoDock/NotificationProfiler, with the interface org.cairodock.CairoDock.NotificationProfiler (Enable(b), Reset(), GetStats() -> s, GetHistory() -> s, TestDestroyDuringNotification() -> s). It is disabled until it is enabled through the bus, and costs nothing until then.
+*/
+void cairo_dock_dbus_export_notification_profiler (void);
+
+/** Export some statistics of the dock on the session bus, under the path /org/cairodock/CairoDock/RuntimeStats, with the interface org.cairodock.CairoDock.RuntimeStats. GetTaskStats() -> s gives the number of wakeups of the Tasks' timer and of the main loop by the Tasks' threads; StartTaskBenchmark(i,i,i) launches a number of periodic Tasks (number, period in s, duration of their job in ms) and StopTaskBenchmark() -> s stops them and gives the number of iterations they have completed; GetWaveStats() -> s gives the number of waves computed, how many of them were incremental, and the time spent (us); GetNewWindowsStats() -> s gives the number of new X windows inspected and the time spent to get their properties (us); GetOverlapStats() -> s gives the number of searches of a window overlapping a dock, the number of windows tested, and how many searches found one; GetSharedImagesStats() -> s gives the number of shared images, the number of ImageBuffers using them, the memory they use and the memory saved by sharing them (bytes); GetTextCacheStats() -> s gives the number of texts in the cache, how many of them are not used any more, and the number of texts taken from the cache and rendered; GetFramesStats() -> s gives the number of steps of the animations, how many of them missed their frame, and the number of frames dropped because of them; GetEventsStats() -> s gives the number of events received from the window system, and how many of them were dropped because a later one of the same kind on the same window superseded them; GetWindowsOrder(b) -> s gives the ids of all the windows known by the windows manager, by z-order (from bottom to top) if TRUE, or by age otherwise; TestDrawOnSharedIcon() -> s draws on an icon whose image is shared with another one, and tells whether the first one was drawn and the second one left untouched (1 or 0). The values are separated by tabs.
+*/
+void cairo_dock_dbus_export_runtime_stats (void);
+
 G_END_DECLS
 #endif
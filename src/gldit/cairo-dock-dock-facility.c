@@ -57,6 +57,7 @@ void cairo_dock_update_dock_size (CairoDock *pDock)
 	}
 	int iPrevMaxDockHeight = pDock->iMaxDockHeight;
 	int iPrevMaxDockWidth = pDock->iMaxDockWidth;
+	cairo_dock_invalidate_wave_linear (pDock);  // the size and the position at rest of the icons are about to change.
 	
 	//\__________________________ First compute the dock's size.
 	
@@ -286,8 +287,11 @@ static void cairo_dock_manage_mouse_position (CairoDock *pDock)
 		break ;
 	}
 }
+static void _forget_wave_damage (CairoDock *pDock);
+
 Icon *cairo_dock_calculate_dock_icons (CairoDock *pDock)
 {
+	_forget_wave_damage (pDock);  // only a linear view computing the wave incrementally knows what has changed.
 	Icon *pPointedIcon = pDock->pRenderer->calculate_icons (pDock);
 	cairo_dock_manage_mouse_position (pDock);
 	return pPointedIcon;
@@ -591,6 +595,46 @@ void cairo_dock_update_input_shape (CairoDock *pDock)
  /// LINEAR DOCK ///
 ///////////////////
 
+// Geometry of the icons of a linear dock, stored as packed arrays (one per field) so that the wave can be computed by simple loops over contiguous memory, that the compiler can vectorize, instead of walking the list and touching the big Icon structures for a few floats each time.
+typedef struct {
+	guint iNbIcons;
+	guint iSize;  // number of allocated icons
+	Icon **pIcons;
+	gdouble *fXAtRest;
+	gdouble *fWidth;
+	gdouble *fHeight;
+	gdouble *fInsertRemoveFactor;
+	gdouble *fXMin;
+	gdouble *fXMax;
+	gdouble *fPhase;
+	gdouble *fScale;
+	gdouble *fScaleNoIR;  // scale before the insert/remove factor is applied
+	gdouble *fX;
+	gdouble *fY;
+	gdouble *fMarginLeft;  // max, over the icons up to this one, of the shift under which an icon at rest gets constrained by its fXMin
+	gdouble *fMarginRight;  // min, over the icons from this one, of the shift above which an icon at rest gets constrained by its fXMax
+	guint iStamp;  // geometry stamp of the dock when the icons were loaded; the layout is loaded again when it differs.
+	gboolean bLoaded;
+	gboolean bHasInsertRemove;  // whether some icons were being inserted or removed when they were loaded; their factor is then refreshed each time.
+	// state of the last computation, used by the incremental mode.
+	gboolean bIncremental;  // whether the next computations can be done incrementally
+	gdouble fMagnitude;
+	double fFlatDockWidth;
+	int iWidth, iHeight;
+	double fAlign;
+	gboolean bDirectionUp;
+	guint iFirst, iLast;  // icons that were inside the wave: [iFirst; iLast[
+	double fLeftShift, fRightShift;  // shift of the icons at rest before/after the wave, or G_MAXDOUBLE if they're not simply shifted
+	gint iPointed;
+	gboolean bDamage;  // whether the damaged area is known (FALSE means everything changed)
+	double fDamageXMin, fDamageXMax;
+	} CairoDockWaveLayout;
+
+#define WAVE_LAYOUT_NB_ARRAYS 13
+
+static CairoDockWaveLayout s_scratchLayout;  // to compute the wave on a mere list of icons (when the size of a dock is computed); the docks have their own layout.
+static CairoDockWaveStats s_waveStats;  // see cairo_dock_get_wave_stats_linear()
+
 void cairo_dock_calculate_icons_positions_at_rest_linear (GList *pIconList, double fFlatDockWidth)
 {
 	//g_print ("%s (%d, +%d)\n", __func__, fFlatDockWidth);
@@ -616,6 +660,7 @@ void cairo_dock_calculate_icons_positions_at_rest_linear (GList *pIconList, doub
 double cairo_dock_calculate_max_dock_width (CairoDock *pDock, double fFlatDockWidth, double fWidthConstraintFactor, double fExtraWidth)
 {
 	double fMaxDockWidth = 0.;
+	cairo_dock_invalidate_wave_linear (pDock);  // the extreme positions of the icons change.
 	//g_print ("%s (%d)\n", __func__, (int)fFlatDockWidth);
 	GList *pIconList = pDock->icons;
 	if (pIconList == NULL)
@@ -678,11 +723,172 @@ double cairo_dock_calculate_max_dock_width (CairoDock *pDock, double fFlatDockWi
 	return fMaxDockWidth;
 }
 
-Icon * cairo_dock_calculate_wave_with_position_linear (GList *pIconList, int x_abs, gdouble fMagnitude, double fFlatDockWidth, int iWidth, int iHeight, double fAlign, double fFoldingFactor, gboolean bDirectionUp)
+
+static void _load_wave_layout (CairoDockWaveLayout *pLayout, GList *pIconList)
+{
+	guint n = g_list_length (pIconList);
+	if (n > pLayout->iSize)
+	{
+		pLayout->iSize = MAX (n, 2 * pLayout->iSize);
+		pLayout->pIcons = g_renew (Icon*, pLayout->pIcons, pLayout->iSize);
+		g_free (pLayout->fXAtRest);
+		gdouble *pData = g_new (gdouble, WAVE_LAYOUT_NB_ARRAYS * pLayout->iSize);  // all the arrays in a single block
+		pLayout->fXAtRest            = pData;
+		pLayout->fWidth              = pData + 1 * pLayout->iSize;
+		pLayout->fHeight             = pData + 2 * pLayout->iSize;
+		pLayout->fInsertRemoveFactor = pData + 3 * pLayout->iSize;
+		pLayout->fXMin               = pData + 4 * pLayout->iSize;
+		pLayout->fXMax               = pData + 5 * pLayout->iSize;
+		pLayout->fPhase              = pData + 6 * pLayout->iSize;
+		pLayout->fScale              = pData + 7 * pLayout->iSize;
+		pLayout->fScaleNoIR          = pData + 8 * pLayout->iSize;
+		pLayout->fX                  = pData + 9 * pLayout->iSize;
+		pLayout->fY                  = pData + 10 * pLayout->iSize;
+		pLayout->fMarginLeft         = pData + 11 * pLayout->iSize;
+		pLayout->fMarginRight        = pData + 12 * pLayout->iSize;
+	}
+	pLayout->iNbIcons = n;
+	pLayout->bLoaded = TRUE;
+	pLayout->bIncremental = FALSE;
+	pLayout->bHasInsertRemove = FALSE;
+	
+	Icon *icon;
+	GList *ic;
+	guint i;
+	for (ic = pIconList, i = 0; ic != NULL; ic = ic->next, i ++)
+	{
+		icon = ic->data;
+		pLayout->pIcons[i] = icon;
+		pLayout->fXAtRest[i] = icon->fXAtRest;
+		pLayout->fWidth[i] = icon->fWidth;
+		pLayout->fHeight[i] = icon->fHeight;
+		pLayout->fInsertRemoveFactor[i] = icon->fInsertRemoveFactor;
+		pLayout->fXMin[i] = icon->fXMin;
+		pLayout->fXMax[i] = icon->fXMax;
+		if (icon->fInsertRemoveFactor != 0)
+			pLayout->bHasInsertRemove = TRUE;
+	}
+}
+
+// get the layout of a dock, loading its icons only if their geometry has changed since the last time.
+static CairoDockWaveLayout *_get_wave_layout (CairoDock *pDock)
+{
+	CairoDockWaveLayout *pLayout = pDock->pWaveLayout;
+	if (pLayout == NULL)
+	{
+		pLayout = g_new0 (CairoDockWaveLayout, 1);
+		pDock->pWaveLayout = pLayout;
+	}
+	if (! pLayout->bLoaded || pLayout->iStamp != pDock->iGeometryStamp)
+	{
+		_load_wave_layout (pLayout, pDock->icons);
+		pLayout->iStamp = pDock->iGeometryStamp;
+	}
+	else if (pLayout->bHasInsertRemove)  // the factor of the icons being inserted/removed changes at each step of their animation.
+	{
+		pLayout->bHasInsertRemove = FALSE;
+		guint i;
+		for (i = 0; i < pLayout->iNbIcons; i ++)
+		{
+			pLayout->fInsertRemoveFactor[i] = pLayout->pIcons[i]->fInsertRemoveFactor;
+			if (pLayout->fInsertRemoveFactor[i] != 0)
+				pLayout->bHasInsertRemove = TRUE;
+		}
+		pLayout->bIncremental = FALSE;
+	}
+	return pLayout;
+}
+
+static void _store_wave_layout (CairoDockWaveLayout *pLayout, guint iFirst, guint iLast)
+{
+	Icon *icon;
+	guint i;
+	for (i = iFirst; i < iLast; i ++)
+	{
+		icon = pLayout->pIcons[i];
+		icon->fPhase = pLayout->fPhase[i];
+		icon->fScale = pLayout->fScale[i];
+		icon->fX = pLayout->fX[i];
+		icon->fY = pLayout->fY[i];
+	}
+}
+
+// sin(x) for x in [0;pi], as a polynomial (cos around pi/2, up to x^12), so that the loop calling it can be vectorized; the error is below 1e-8, far below a pixel. It is exactly 0 at the bounds, so that icons outside of the wave keep a scale of exactly 1.
+static inline double _wave_sin (double x)
+{
+	double t = x - G_PI / 2;
+	double t2 = t * t;
+	double s = 1 + t2 * (-1./2 + t2 * (1./24 + t2 * (-1./720 + t2 * (1./40320 + t2 * (-1./3628800 + t2 * (1./479001600))))));
+	return (x <= 0 || x >= G_PI ? 0 : s);
+}
+
+// compute the phase, scale and height of the icons in [iFirst; iLast[; no dependency between icons, so it's vectorizable.
+static void _compute_wave_scales (CairoDockWaveLayout *pLayout, guint iFirst, guint iLast, int x_abs, gdouble fMagnitude, int iWidth, int iHeight, gboolean bDirectionUp)
+{
+	const double fPhaseFactor = G_PI / myIconsParam.iSinusoidWidth;
+	const double fAmplitude = fMagnitude * myIconsParam.fAmplitude;
+	const double fYOffset = myDocksParam.iDockLineWidth + myDocksParam.iFrameMargin;
+	gdouble *fXAtRest = pLayout->fXAtRest, *fWidth = pLayout->fWidth, *fHeight = pLayout->fHeight, *fInsertRemoveFactor = pLayout->fInsertRemoveFactor;
+	gdouble *fPhase = pLayout->fPhase, *fScale = pLayout->fScale, *fScaleNoIR = pLayout->fScaleNoIR, *fY = pLayout->fY;
+	double phase, ir;
+	guint i;
+	for (i = iFirst; i < iLast; i ++)
+	{
+		//\_______________ We compute its phase (pi/2 next to the cursor).
+		phase = (fXAtRest[i] + fWidth[i] / 2 - x_abs) * fPhaseFactor + G_PI / 2;
+		phase = (phase < 0 ? 0 : phase > G_PI ? G_PI : phase);
+		fPhase[i] = phase;
+		
+		//\_______________ We deduct the sinusoidal amplitude next to the icon (its scale)
+		fScaleNoIR[i] = 1 + fAmplitude * _wave_sin (phase);
+		
+		ir = fInsertRemoveFactor[i];
+		fScale[i] = fScaleNoIR[i] * (iWidth <= 0 || ir == 0 ? 1 : ir > 0 ? ir : 1 + ir);
+		
+		fY[i] = (bDirectionUp ? iHeight - fYOffset - fScale[i] * fHeight[i] : fYOffset);
+	}
+}
+
+// place the icon i next to the icon i-1 (on the right of the pointed icon).
+static inline void _place_icon_after (CairoDockWaveLayout *pLayout, guint i, gdouble fMagnitude, int iWidth, double fAlign, double fFoldingFactor)
+{
+	gdouble *fWidth = pLayout->fWidth, *fScale = pLayout->fScale, *fXMax = pLayout->fXMax, *fX = pLayout->fX;
+	const int iGap = myIconsParam.iIconGap;
+	const double fAmplitude = myIconsParam.fAmplitude;
+	double fDeltaExtremum;
+	
+	fX[i] = fX[i-1] + (fWidth[i-1] + iGap) * fScale[i-1];
+	if (fX[i] + fWidth[i] * fScale[i] > fXMax[i] - fAmplitude * fMagnitude * (fWidth[i] + 1.5*iGap) / 8 && iWidth != 0)
+	{
+		fDeltaExtremum = fX[i] + fWidth[i] * fScale[i] - (fXMax[i] - fAmplitude * fMagnitude * (fWidth[i] + 1.5*iGap) / 16);
+		if (fAmplitude != 0)
+			fX[i] -= fDeltaExtremum * (1 - (fScale[i] - 1) / fAmplitude) * fMagnitude;
+	}
+	fX[i] = fAlign * iWidth + (fX[i] - fAlign * iWidth) * (1. - fFoldingFactor);
+}
+
+// place the icon i-1 next to the icon i (on the left of the pointed icon).
+static inline void _place_icon_before (CairoDockWaveLayout *pLayout, guint i, int x_abs, gdouble fMagnitude, int iWidth, double fAlign, double fFoldingFactor)
+{
+	gdouble *fWidth = pLayout->fWidth, *fScale = pLayout->fScale, *fXMin = pLayout->fXMin, *fX = pLayout->fX;
+	const int iGap = myIconsParam.iIconGap;
+	const double fAmplitude = myIconsParam.fAmplitude;
+	double fDeltaExtremum;
+	
+	fX[i-1] = fX[i] - (fWidth[i-1] + iGap) * fScale[i-1];
+	if (fX[i-1] < fXMin[i-1] + fAmplitude * fMagnitude * (fWidth[i-1] + 1.5*iGap) / 8
+	    && iWidth != 0 && x_abs < iWidth && fMagnitude > 0)  /// && prev_icon->fPhase == 0
+	    // We re-add 'fMagnitude > 0' otherwise we have a small jump due to constraints on the left of the pointed icon.
+	{
+		fDeltaExtremum = fX[i-1] - (fXMin[i-1] + fAmplitude * fMagnitude * (fWidth[i-1] + 1.5*iGap) / 16);
+		if (fAmplitude != 0)
+			fX[i-1] -= fDeltaExtremum * (1 - (fScale[i-1] - 1) / fAmplitude) * fMagnitude;
+	}
+	fX[i-1] = fAlign * iWidth + (fX[i-1] - fAlign * iWidth) * (1. - fFoldingFactor);
+}
+
+static inline int _clamp_wave_position (int x_abs, double fFlatDockWidth, int iWidth)
 {
-	//g_print (">>>>>%s (%d/%.2f, %dx%d, %.2f, %.2f)\n", __func__, x_abs, fFlatDockWidth, iWidth, iHeight, fAlign, fFoldingFactor);
-	if (pIconList == NULL)
-		return NULL;
 	if (x_abs < 0 && iWidth > 0)
 		// to avoid too quick resize when leaving from the edges.
 		///x_abs = -1;
@@ -690,145 +896,290 @@ Icon * cairo_dock_calculate_wave_with_position_linear (GList *pIconList, int x_a
 	else if (x_abs > fFlatDockWidth && iWidth > 0)
 		///x_abs = fFlatDockWidth+1;
 		x_abs = (int) fFlatDockWidth;
+	return x_abs;
+}
+
+// compute the whole wave on the loaded layout; return the index of the pointed icon, and whether it's really pointed.
+static gint _compute_wave (CairoDockWaveLayout *pLayout, int x_abs, gdouble fMagnitude, double fFlatDockWidth, int iWidth, int iHeight, double fAlign, double fFoldingFactor, gboolean bDirectionUp, gboolean *bPointed)
+{
+	const guint n = pLayout->iNbIcons;
+	gdouble *fXAtRest = pLayout->fXAtRest, *fWidth = pLayout->fWidth, *fInsertRemoveFactor = pLayout->fInsertRemoveFactor;
+	gdouble *fScale = pLayout->fScale, *fScaleNoIR = pLayout->fScaleNoIR, *fX = pLayout->fX;
 	
+	//\_______________ We compute the scale of each icon.
+	_compute_wave_scales (pLayout, 0, n, x_abs, fMagnitude, iWidth, iHeight, bDirectionUp);
 	
-	float x_cumulated = 0, fXMiddle, fDeltaExtremum;
-	GList* ic, *pointed_ic;
-	Icon *icon, *prev_icon;
-	double fScale = 0.;
+	//\_______________ We place the icons after the pointed icon next to each other, and look for the pointed icon.
+	float x_cumulated = 0, fXMiddle;
+	const int iGap = myIconsParam.iIconGap;
 	double offset = 0.;
-	pointed_ic = (x_abs < 0 ? pIconList : NULL);
-	for (ic = pIconList; ic != NULL; ic = ic->next)
+	gint iPointed = (x_abs < 0 ? 0 : -1);
+	*bPointed = FALSE;
+	guint i;
+	for (i = 0; i < n; i ++)
 	{
-		icon = ic->data;
-		x_cumulated = icon->fXAtRest;
-		fXMiddle = icon->fXAtRest + icon->fWidth / 2;
-
-		//\_______________ We compute its phase (pi/2 next to the cursor).
-		icon->fPhase = (fXMiddle - x_abs) / myIconsParam.iSinusoidWidth * G_PI + G_PI / 2;
-		if (icon->fPhase < 0)
-		{
-			icon->fPhase = 0;
-		}
-		else if (icon->fPhase > G_PI)
-		{
-			icon->fPhase = G_PI;
-		}
-		
-		//\_______________ We deduct the sinusoidal amplitude next to the icon (its scale)
-		icon->fScale = 1 + fMagnitude * myIconsParam.fAmplitude * sin (icon->fPhase);
-		if (iWidth > 0 && icon->fInsertRemoveFactor != 0)
-		{
-			fScale = icon->fScale;
-			///offset += (icon->fWidth * icon->fScale) * (pointed_ic == NULL ? 1 : -1);
-			if (icon->fInsertRemoveFactor > 0)
-				icon->fScale *= icon->fInsertRemoveFactor;
-			else
-				icon->fScale *= (1 + icon->fInsertRemoveFactor);
-			///offset -= (icon->fWidth * icon->fScale) * (pointed_ic == NULL ? 1 : -1);
-		}
-		
-		icon->fY = (bDirectionUp ? iHeight - myDocksParam.iDockLineWidth - myDocksParam.iFrameMargin - icon->fScale * icon->fHeight : myDocksParam.iDockLineWidth + myDocksParam.iFrameMargin);
-		//g_print ("%s fY : %d; %.2f\n", icon->cName, iHeight, icon->fHeight);
+		x_cumulated = fXAtRest[i];
 		
 		/* If we already have defined a pointed icon, we can move the current
 		 * icon compared to the previous one
 		 */
-		if (pointed_ic != NULL)
+		if (iPointed >= 0)
 		{
-			if (ic == pIconList)  // can happen if we are outside from the left of the dock.
+			if (i == 0)  // can happen if we are outside from the left of the dock.
 			{
-				icon->fX = x_cumulated - 1. * (fFlatDockWidth - iWidth) / 2;
-				//g_print ("  outside from the left : icon->fX = %.2f (%.2f)\n", icon->fX, x_cumulated);
+				fX[i] = x_cumulated - 1. * (fFlatDockWidth - iWidth) / 2;
+				fX[i] = fAlign * iWidth + (fX[i] - fAlign * iWidth) * (1. - fFoldingFactor);
 			}
 			else
-			{
-				prev_icon = (ic->prev != NULL ? ic->prev->data : cairo_dock_get_last_icon (pIconList));
-				icon->fX = prev_icon->fX + (prev_icon->fWidth + myIconsParam.iIconGap) * prev_icon->fScale;
-
-				if (icon->fX + icon->fWidth * icon->fScale > icon->fXMax - myIconsParam.fAmplitude * fMagnitude * (icon->fWidth + 1.5*myIconsParam.iIconGap) / 8 && iWidth != 0)
-				{
-					//g_print ("  we constraint %s (fXMax=%.2f , fX=%.2f\n", prev_icon->cName, prev_icon->fXMax, prev_icon->fX);
-					fDeltaExtremum = icon->fX + icon->fWidth * icon->fScale - (icon->fXMax - myIconsParam.fAmplitude * fMagnitude * (icon->fWidth + 1.5*myIconsParam.iIconGap) / 16);
-					if (myIconsParam.fAmplitude != 0)
-						icon->fX -= fDeltaExtremum * (1 - (icon->fScale - 1) / myIconsParam.fAmplitude) * fMagnitude;
-				}
-			}
-			icon->fX = fAlign * iWidth + (icon->fX - fAlign * iWidth) * (1. - fFoldingFactor);
-			//g_print ("  on the right : icon->fX = %.2f (%.2f)\n", icon->fX, x_cumulated);
+				_place_icon_after (pLayout, i, fMagnitude, iWidth, fAlign, fFoldingFactor);
 		}
 		
 		//\_______________ We check if we have a pointer on this icon.
-		if (pointed_ic == NULL
-		    && x_cumulated + icon->fWidth + .5*myIconsParam.iIconGap >= x_abs
-		    && x_cumulated - .5*myIconsParam.iIconGap <= x_abs) // we found the pointed icon.
+		if (iPointed < 0
+		    && x_cumulated + fWidth[i] + .5*iGap >= x_abs
+		    && x_cumulated - .5*iGap <= x_abs) // we found the pointed icon.
 		{
-			pointed_ic = ic;
-			///icon->bPointed = TRUE;
-			icon->bPointed = (x_abs != (int) fFlatDockWidth && x_abs != 0);
-			icon->fX = x_cumulated - (fFlatDockWidth - iWidth) / 2 + (1 - icon->fScale) * (x_abs - x_cumulated + .5*myIconsParam.iIconGap);
-			icon->fX = fAlign * iWidth + (icon->fX - fAlign * iWidth) * (1. - fFoldingFactor);
-			//g_print ("  pointed icon: fX = %.2f (%.2f, %d)\n", icon->fX, x_cumulated, icon->bPointed);
+			iPointed = i;
+			*bPointed = (x_abs != (int) fFlatDockWidth && x_abs != 0);
+			fX[i] = x_cumulated - (fFlatDockWidth - iWidth) / 2 + (1 - fScale[i]) * (x_abs - x_cumulated + .5*iGap);
+			fX[i] = fAlign * iWidth + (fX[i] - fAlign * iWidth) * (1. - fFoldingFactor);
 		}
-		else
-			icon->bPointed = FALSE;
 		
-		if (iWidth > 0 && icon->fInsertRemoveFactor != 0)
+		if (iWidth > 0 && fInsertRemoveFactor[i] != 0)
 		{
-			if (pointed_ic != ic)  // bPointed can be false for the last icon on the right.
-				offset += (icon->fWidth * (fScale - icon->fScale)) * (pointed_ic == NULL ? 1 : -1);
+			if (iPointed != (gint)i)  // bPointed can be false for the last icon on the right.
+				offset += (fWidth[i] * (fScaleNoIR[i] - fScale[i])) * (iPointed < 0 ? 1 : -1);
 			else
-				offset += (2*(fXMiddle - x_abs) * (fScale - icon->fScale)) * (pointed_ic == NULL ? 1 : -1);
+			{
+				fXMiddle = fXAtRest[i] + fWidth[i] / 2;
+				offset += (2*(fXMiddle - x_abs) * (fScaleNoIR[i] - fScale[i])) * -1;
+			}
 		}
 	}
 	
 	//\_______________ We place icons before pointed icon beside this one
-	if (pointed_ic == NULL)  // We are at the right of icons.
+	if (iPointed < 0)  // We are at the right of icons.
 	{
-		pointed_ic = g_list_last (pIconList);
-		icon = pointed_ic->data;
-		icon->fX = x_cumulated - (fFlatDockWidth - iWidth) / 2 + (1 - icon->fScale) * (icon->fWidth + .5*myIconsParam.iIconGap);
-		icon->fX = fAlign * iWidth + (icon->fX - fAlign * iWidth) * (1 - fFoldingFactor);
-		//g_print ("  outside on the right: icon->fX = %.2f (%.2f)\n", icon->fX, x_cumulated);
+		iPointed = n - 1;
+		fX[iPointed] = x_cumulated - (fFlatDockWidth - iWidth) / 2 + (1 - fScale[iPointed]) * (fWidth[iPointed] + .5*iGap);
+		fX[iPointed] = fAlign * iWidth + (fX[iPointed] - fAlign * iWidth) * (1 - fFoldingFactor);
 	}
 	
-	ic = pointed_ic;
-	while (ic != pIconList)
+	for (i = iPointed; i > 0; i --)
+		_place_icon_before (pLayout, i, x_abs, fMagnitude, iWidth, fAlign, fFoldingFactor);
+	
+	if (offset != 0)
 	{
-		icon = ic->data;
-		
-		ic = ic->prev;  // since ic != pIconList, ic->prev is not NULL
-		prev_icon = ic->data;
-		
-		prev_icon->fX = icon->fX - (prev_icon->fWidth + myIconsParam.iIconGap) * prev_icon->fScale;
-		//g_print ("fX <- %.2f; fXMin : %.2f\n", prev_icon->fX, prev_icon->fXMin);
-		if (prev_icon->fX < prev_icon->fXMin + myIconsParam.fAmplitude * fMagnitude * (prev_icon->fWidth + 1.5*myIconsParam.iIconGap) / 8
-		    && iWidth != 0 && x_abs < iWidth && fMagnitude > 0)  /// && prev_icon->fPhase == 0
-		    // We re-add 'fMagnitude > 0' otherwise we have a small jump due to constraints on the left of the pointed icon.
+		offset /= 2;
+		for (i = 0; i < n; i ++)
+			fX[i] -= offset;
+	}
+	return iPointed;
+}
+
+// get the range of icons [*iFirst; *iLast[ that can be inside the wave for a given position of the cursor; the icons outside have a phase of 0 or pi.
+static void _get_wave_window (CairoDockWaveLayout *pLayout, int x_abs, guint *iFirst, guint *iLast)
+{
+	gdouble *fXAtRest = pLayout->fXAtRest, *fWidth = pLayout->fWidth;
+	const double r = myIconsParam.iSinusoidWidth / 2.;
+	guint a = 0, b = pLayout->iNbIcons, m;
+	while (a < b)  // first icon whose middle is after x_abs - r (the middles are sorted)
+	{
+		m = (a + b) / 2;
+		if (fXAtRest[m] + fWidth[m] / 2 > x_abs - r)
+			b = m;
+		else
+			a = m + 1;
+	}
+	*iFirst = (a > 0 ? a - 1 : 0);  // one icon more on each side, to be safe with the rounding of the phase.
+	b = pLayout->iNbIcons;
+	while (a < b)  // first icon whose middle is after x_abs + r
+	{
+		m = (a + b) / 2;
+		if (fXAtRest[m] + fWidth[m] / 2 >= x_abs + r)
+			b = m;
+		else
+			a = m + 1;
+	}
+	*iLast = MIN (a + 1, pLayout->iNbIcons);
+}
+
+// after a complete computation, check if the following ones can be done incrementally, and prepare the needed data.
+static void _prepare_incremental_wave (CairoDockWaveLayout *pLayout, gint iPointed, int x_abs, gdouble fMagnitude, double fFoldingFactor, int iWidth)
+{
+	const guint n = pLayout->iNbIcons;
+	gdouble *fXAtRest = pLayout->fXAtRest, *fWidth = pLayout->fWidth, *fInsertRemoveFactor = pLayout->fInsertRemoveFactor;
+	gdouble *fXMin = pLayout->fXMin, *fXMax = pLayout->fXMax, *fMarginLeft = pLayout->fMarginLeft, *fMarginRight = pLayout->fMarginRight;
+	const int iGap = myIconsParam.iIconGap;
+	const double fAmplitude = myIconsParam.fAmplitude;
+	
+	pLayout->bIncremental = FALSE;
+	if (fFoldingFactor != 0 || iWidth <= 0 || n == 0)
+		return;
+	// the icons must be placed next to each other at rest, without any insert/remove animation.
+	guint i;
+	for (i = 0; i < n; i ++)
+	{
+		if (fInsertRemoveFactor[i] != 0)
+			return;
+		if (i > 0 && fabs (fXAtRest[i] - (fXAtRest[i-1] + fWidth[i-1] + iGap)) > 1e-6)
+			return;
+	}
+	
+	// margins under/above which the icons at rest, shifted by a constant, are constrained by their fXMin/fXMax.
+	double m;
+	for (i = 0; i < n; i ++)
+	{
+		m = fXMin[i] + fAmplitude * fMagnitude * (fWidth[i] + 1.5*iGap) / 8 - fXAtRest[i];
+		fMarginLeft[i] = (i > 0 ? MAX (m, fMarginLeft[i-1]) : m);
+	}
+	for (i = n; i > 0; i --)
+	{
+		m = fXMax[i-1] - fAmplitude * fMagnitude * (fWidth[i-1] + 1.5*iGap) / 8 - fWidth[i-1] - fXAtRest[i-1];
+		fMarginRight[i-1] = (i < n ? MIN (m, fMarginRight[i]) : m);
+	}
+	
+	_get_wave_window (pLayout, x_abs, &pLayout->iFirst, &pLayout->iLast);
+	pLayout->iFirst = MIN (pLayout->iFirst, (guint)iPointed);
+	pLayout->iLast = MAX (pLayout->iLast, (guint)iPointed + 1);
+	pLayout->fLeftShift = pLayout->fRightShift = G_MAXDOUBLE;  // unknown
+	pLayout->iPointed = iPointed;
+	pLayout->bIncremental = TRUE;
+}
+
+static void _get_icons_extent (CairoDockWaveLayout *pLayout, guint iFirst, guint iLast, double *fXMin, double *fXMax)
+{
+	gdouble *fWidth = pLayout->fWidth, *fScale = pLayout->fScale, *fX = pLayout->fX;
+	double xmin = G_MAXDOUBLE, xmax = - G_MAXDOUBLE;
+	guint i;
+	for (i = iFirst; i < iLast; i ++)
+	{
+		xmin = MIN (xmin, fX[i]);
+		xmax = MAX (xmax, fX[i] + fWidth[i] * fScale[i]);
+	}
+	*fXMin = xmin;
+	*fXMax = xmax;
+}
+
+// update the wave for a new position of the cursor, recomputing only the icons inside the wave (at the previous and the new positions), the other ones being shifted by a constant. Return the range of icons that have been recomputed, or FALSE if the wave has to be computed entirely.
+static gboolean _compute_wave_incremental (CairoDockWaveLayout *pLayout, int x_abs, gboolean *bPointed, guint *iFirst, guint *iLast)
+{
+	const guint n = pLayout->iNbIcons;
+	gdouble *fXAtRest = pLayout->fXAtRest, *fWidth = pLayout->fWidth, *fScale = pLayout->fScale, *fX = pLayout->fX;
+	const gdouble fMagnitude = pLayout->fMagnitude;
+	const int iWidth = pLayout->iWidth;
+	const double fAlign = pLayout->fAlign;
+	const double fFlatDockWidth = pLayout->fFlatDockWidth;
+	const int iGap = myIconsParam.iIconGap;
+	
+	//\_______________ look for the pointed icon (the icons are sorted).
+	if (x_abs < 0)
+		return FALSE;
+	guint a = 0, b = n, m;
+	while (a < b)
+	{
+		m = (a + b) / 2;
+		if (fXAtRest[m] + fWidth[m] + .5*iGap >= x_abs)
+			b = m;
+		else
+			a = m + 1;
+	}
+	if (a == n || fXAtRest[a] - .5*iGap > x_abs)  // no pointed icon, let the complete computation handle it.
+		return FALSE;
+	const guint p = a;
+	
+	//\_______________ get the icons whose scale can have changed.
+	guint iFirstWave, iLastWave;
+	_get_wave_window (pLayout, x_abs, &iFirstWave, &iLastWave);
+	iFirstWave = MIN (iFirstWave, p);
+	iLastWave = MAX (iLastWave, p + 1);
+	guint lo = MIN (iFirstWave, pLayout->iFirst);  // the previous wave has to be flattened
+	guint hi = MAX (iLastWave, pLayout->iLast);
+	
+	// remember the previous extent of these icons, to know what has changed.
+	double fDamageXMin, fDamageXMax;
+	_get_icons_extent (pLayout, lo, hi, &fDamageXMin, &fDamageXMax);
+	
+	//\_______________ compute the wave inside this range.
+	_compute_wave_scales (pLayout, lo, hi, x_abs, fMagnitude, iWidth, pLayout->iHeight, pLayout->bDirectionUp);
+	
+	*bPointed = (x_abs != (int) fFlatDockWidth && x_abs != 0);
+	fX[p] = fXAtRest[p] - (fFlatDockWidth - iWidth) / 2 + (1 - fScale[p]) * (x_abs - fXAtRest[p] + .5*iGap);
+	guint i;
+	for (i = p + 1; i < hi; i ++)
+		_place_icon_after (pLayout, i, fMagnitude, iWidth, fAlign, 0.);
+	for (i = p; i > lo; i --)
+		_place_icon_before (pLayout, i, x_abs, fMagnitude, iWidth, fAlign, 0.);
+	
+	//\_______________ shift the icons outside of the range, unless they hit their constraint.
+	double fLeftShift = G_MAXDOUBLE, fRightShift = G_MAXDOUBLE;
+	if (hi < n)
+	{
+		fRightShift = fX[hi-1] + (fWidth[hi-1] + iGap) * fScale[hi-1] - fXAtRest[hi];
+		if (fRightShift > pLayout->fMarginRight[hi])
 		{
-			//g_print ("  we constraint %s (fXMin=%.2f , fX=%.2f\n", prev_icon->cName, prev_icon->fXMin, prev_icon->fX);
-			fDeltaExtremum = prev_icon->fX - (prev_icon->fXMin + myIconsParam.fAmplitude * fMagnitude * (prev_icon->fWidth + 1.5*myIconsParam.iIconGap) / 16);
-			if (myIconsParam.fAmplitude != 0)
-				prev_icon->fX -= fDeltaExtremum * (1 - (prev_icon->fScale - 1) / myIconsParam.fAmplitude) * fMagnitude;
+			for (i = hi; i < n; i ++)
+				_place_icon_after (pLayout, i, fMagnitude, iWidth, fAlign, 0.);
+			fRightShift = G_MAXDOUBLE;  // unknown
+		}
+		else
+		{
+			for (i = hi; i < n; i ++)
+				fX[i] = fXAtRest[i] + fRightShift;
 		}
-		prev_icon->fX = fAlign * iWidth + (prev_icon->fX - fAlign * iWidth) * (1. - fFoldingFactor);
-		//g_print ("  prev_icon->fX : %.2f\n", prev_icon->fX);
 	}
-	
-	if (offset != 0)
+	if (lo > 0)
 	{
-		offset /= 2;
-		//g_print ("offset : %.2f (pointed:%s)\n", offset, pointed_ic?((Icon*)pointed_ic->data)->cName:"none");
-		for (ic = pIconList; ic != NULL; ic = ic->next)
+		fLeftShift = fX[lo] - (fWidth[lo-1] + iGap) - fXAtRest[lo-1];
+		if (x_abs < iWidth && fMagnitude > 0 && fLeftShift < pLayout->fMarginLeft[lo-1])
 		{
-			icon = ic->data;
-			//if (ic == pIconList)
-			//	cd_debug ("fX : %.2f - %.2f", icon->fX, offset);
-			icon->fX -= offset;
+			for (i = lo; i > 0; i --)
+				_place_icon_before (pLayout, i, x_abs, fMagnitude, iWidth, fAlign, 0.);
+			fLeftShift = G_MAXDOUBLE;  // unknown
+		}
+		else
+		{
+			for (i = 0; i < lo; i ++)
+				fX[i] = fXAtRest[i] + fLeftShift;
 		}
 	}
 	
-	icon = pointed_ic->data;
+	//\_______________ deduce the damaged area.
+	double xmin, xmax;
+	_get_icons_extent (pLayout, lo, hi, &xmin, &xmax);
+	pLayout->bDamage = TRUE;
+	pLayout->fDamageXMin = (lo > 0 && (fLeftShift != pLayout->fLeftShift || fLeftShift == G_MAXDOUBLE) ? - G_MAXDOUBLE : MIN (fDamageXMin, xmin));  // if the icons on the left have moved, everything on the left is damaged.
+	pLayout->fDamageXMax = (hi < n && (fRightShift != pLayout->fRightShift || fRightShift == G_MAXDOUBLE) ? G_MAXDOUBLE : MAX (fDamageXMax, xmax));
+	
+	pLayout->iFirst = iFirstWave;
+	pLayout->iLast = iLastWave;
+	pLayout->fLeftShift = fLeftShift;
+	pLayout->fRightShift = fRightShift;
+	pLayout->iPointed = p;
+	*iFirst = lo;
+	*iLast = hi;
+	return TRUE;
+}
+
+Icon * cairo_dock_calculate_wave_with_position_linear (GList *pIconList, int x_abs, gdouble fMagnitude, double fFlatDockWidth, int iWidth, int iHeight, double fAlign, double fFoldingFactor, gboolean bDirectionUp)
+{
+	//g_print (">>>>>%s (%d/%.2f, %dx%d, %.2f, %.2f)\n", __func__, x_abs, fFlatDockWidth, iWidth, iHeight, fAlign, fFoldingFactor);
+	if (pIconList == NULL)
+		return NULL;
+	x_abs = _clamp_wave_position (x_abs, fFlatDockWidth, iWidth);
+	
+	CairoDockWaveLayout *pLayout = &s_scratchLayout;
+	_load_wave_layout (pLayout, pIconList);
+	gboolean bPointed;
+	gint iPointed = _compute_wave (pLayout, x_abs, fMagnitude, fFlatDockWidth, iWidth, iHeight, fAlign, fFoldingFactor, bDirectionUp, &bPointed);
+	
+	//\_______________ Write the result back into the icons.
+	_store_wave_layout (pLayout, 0, pLayout->iNbIcons);
+	guint i;
+	for (i = 0; i < pLayout->iNbIcons; i ++)
+		pLayout->pIcons[i]->bPointed = FALSE;
+	Icon *icon = pLayout->pIcons[iPointed];
+	icon->bPointed = bPointed;
 	return (icon->bPointed ? icon : NULL);
 }
 
@@ -840,11 +1191,104 @@ Icon *cairo_dock_apply_wave_effect_linear (CairoDock *pDock)
 	//g_print ("%s (flat:%d, w:%d, x:%d)\n", __func__, (int)pDock->fFlatDockWidth, pDock->container.iWidth, pDock->container.iMouseX);
 	double offset = (pDock->container.iWidth - pDock->iActiveWidth) * pDock->fAlign + (pDock->iActiveWidth - pDock->fFlatDockWidth) / 2;
 	int x_abs = pDock->container.iMouseX - offset;
-
+	if (pDock->icons == NULL)
+		return NULL;
+	
+	gint64 t0 = g_get_monotonic_time ();
+	
 	//\_______________ We compute all parameters for the icons.
 	double fMagnitude = cairo_dock_calculate_magnitude (pDock->iMagnitudeIndex);  // * pDock->fMagnitudeMax
-	Icon *pPointedIcon = cairo_dock_calculate_wave_with_position_linear (pDock->icons, x_abs, fMagnitude, pDock->fFlatDockWidth, pDock->container.iWidth, pDock->container.iHeight, pDock->fAlign, pDock->fFoldingFactor, pDock->container.bDirectionUp);  // iMaxDockWidth
-	return pPointedIcon;
+	x_abs = _clamp_wave_position (x_abs, pDock->fFlatDockWidth, pDock->container.iWidth);
+	CairoDockWaveLayout *pLayout = _get_wave_layout (pDock);
+	gboolean bPointed;
+	guint iFirst, iLast;
+	gint iPrevPointed = pLayout->iPointed;
+	if (pLayout->bIncremental  // only the position of the cursor has changed since the last time.
+	    && pLayout->fMagnitude == fMagnitude
+	    && pLayout->fFlatDockWidth == pDock->fFlatDockWidth
+	    && pLayout->iWidth == pDock->container.iWidth
+	    && pLayout->iHeight == pDock->container.iHeight
+	    && pLayout->fAlign == pDock->fAlign
+	    && pLayout->bDirectionUp == pDock->container.bDirectionUp
+	    && pDock->fFoldingFactor == 0
+	    && _compute_wave_incremental (pLayout, x_abs, &bPointed, &iFirst, &iLast))
+	{
+		// only the icons inside the wave have changed, the other ones have only moved.
+		_store_wave_layout (pLayout, iFirst, iLast);
+		guint i;
+		for (i = 0; i < iFirst; i ++)
+			pLayout->pIcons[i]->fX = pLayout->fX[i];
+		for (i = iLast; i < pLayout->iNbIcons; i ++)
+			pLayout->pIcons[i]->fX = pLayout->fX[i];
+		s_waveStats.iNbIncrementalWaves ++;
+	}
+	else
+	{
+		iPrevPointed = -1;
+		pLayout->iPointed = _compute_wave (pLayout, x_abs, fMagnitude, pDock->fFlatDockWidth, pDock->container.iWidth, pDock->container.iHeight, pDock->fAlign, pDock->fFoldingFactor, pDock->container.bDirectionUp, &bPointed);
+		_store_wave_layout (pLayout, 0, pLayout->iNbIcons);
+		guint i;
+		for (i = 0; i < pLayout->iNbIcons; i ++)
+			pLayout->pIcons[i]->bPointed = FALSE;
+		
+		pLayout->fMagnitude = fMagnitude;
+		pLayout->fFlatDockWidth = pDock->fFlatDockWidth;
+		pLayout->iWidth = pDock->container.iWidth;
+		pLayout->iHeight = pDock->container.iHeight;
+		pLayout->fAlign = pDock->fAlign;
+		pLayout->bDirectionUp = pDock->container.bDirectionUp;
+		pLayout->bDamage = FALSE;
+		if (! pLayout->bHasInsertRemove)
+			_prepare_incremental_wave (pLayout, pLayout->iPointed, x_abs, fMagnitude, pDock->fFoldingFactor, pDock->container.iWidth);
+	}
+	
+	//\_______________ update the pointed icon.
+	if (iPrevPointed >= 0)
+		pLayout->pIcons[iPrevPointed]->bPointed = FALSE;
+	Icon *icon = pLayout->pIcons[pLayout->iPointed];
+	icon->bPointed = bPointed;
+	
+	s_waveStats.iNbWaves ++;
+	s_waveStats.iTotalTime += g_get_monotonic_time () - t0;
+	return (icon->bPointed ? icon : NULL);
+}
+
+void cairo_dock_get_wave_stats_linear (CairoDockWaveStats *pStats)
+{
+	*pStats = s_waveStats;
+}
+
+void cairo_dock_invalidate_wave_linear (CairoDock *pDock)
+{
+	pDock->iGeometryStamp ++;
+}
+
+void cairo_dock_free_wave_linear (CairoDock *pDock)
+{
+	CairoDockWaveLayout *pLayout = pDock->pWaveLayout;
+	if (pLayout == NULL)
+		return;
+	g_free (pLayout->pIcons);
+	g_free (pLayout->fXAtRest);  // all the arrays are in the same block
+	g_free (pLayout);
+	pDock->pWaveLayout = NULL;
+}
+
+static void _forget_wave_damage (CairoDock *pDock)
+{
+	CairoDockWaveLayout *pLayout = pDock->pWaveLayout;
+	if (pLayout != NULL)
+		pLayout->bDamage = FALSE;
+}
+
+gboolean cairo_dock_get_wave_damage_linear (CairoDock *pDock, double *fXMin, double *fXMax)
+{
+	CairoDockWaveLayout *pLayout = pDock->pWaveLayout;
+	if (pLayout == NULL || pLayout->iStamp != pDock->iGeometryStamp || ! pLayout->bDamage)
+		return FALSE;
+	*fXMin = pLayout->fDamageXMin;
+	*fXMax = pLayout->fDamageXMax;
+	return TRUE;
 }
 
 double cairo_dock_get_current_dock_width_linear (CairoDock *pDock)
@@ -146,6 +146,39 @@ Icon * cairo_dock_calculate_wave_with_position_linear (GList *pIconList, int x_a
 Icon *cairo_dock_apply_wave_effect_linear (CairoDock *pDock);
 #define cairo_dock_apply_wave_effect cairo_dock_apply_wave_effect_linear
 
+/** Tell that the geometry of the icons of a linear dock has changed (an icon is inserted or removed, its size changes, etc), so that the next wave loads the icons again and is computed entirely. Each dock keeps the geometry of its icons between 2 waves, and while only the mouse moves, the wave is updated incrementally, only for the icons inside the wave.
+*@param pDock a linear dock.
+*/
+void cairo_dock_invalidate_wave_linear (CairoDock *pDock);
+
+/// Statistics about the computation of the wave, since the beginning.
+struct _CairoDockWaveStats {
+	/// number of waves computed by \ref cairo_dock_apply_wave_effect_linear
+	guint iNbWaves;
+	/// number of them that only needed to update the icons inside the wave
+	guint iNbIncrementalWaves;
+	/// cumulated time spent to compute them, in us
+	gint64 iTotalTime;
+};
+
+/** Get the statistics about the computation of the wave.
+*@param pStats filled with the statistics.
+*/
+void cairo_dock_get_wave_stats_linear (CairoDockWaveStats *pStats);
+
+/** Free the layout used to compute the wave of a dock. It's done when the dock is destroyed.
+*@param pDock a linear dock.
+*/
+void cairo_dock_free_wave_linear (CairoDock *pDock);
+
+/** Get the horizontal range that has changed during the last call to \ref cairo_dock_apply_wave_effect_linear, in the same coordinates as the fX of the icons. The bounds can be infinite if all the icons on one side have moved.
+*@param pDock a linear dock.
+*@param fXMin return location for the left bound.
+*@param fXMax return location for the right bound.
+*@return FALSE if the whole dock has changed, or if the icons were not placed by \ref cairo_dock_apply_wave_effect_linear during the last \ref cairo_dock_calculate_dock_icons.
+*/
+gboolean cairo_dock_get_wave_damage_linear (CairoDock *pDock, double *fXMin, double *fXMax);
+
 /** Get the current width of all the icons of a linear dock. It doesn't take into account any decoration or frame, only the space occupied by the icons.
 *@param pDock a linear dock.
 * @return the dock's width.
@@ -139,8 +139,14 @@ static gboolean _on_expose (G_GNUC_UNUSED GtkWidget *pWidget, cairo_t *pCairoCon
 		area.y = y1;
 		area.width = x2 - x1;
 		area.height = y2 - y1;
+		GdkRectangle damage;
+		if (gldi_container_take_damage (CAIRO_CONTAINER (pDock), &damage))  // what has been redrawn since the last frame; it's normally inside the clip already, unless the expose event didn't come from us.
+			gdk_rectangle_union (&area, &damage, &area);
+		gboolean bPartial = (area.x > 0 || area.y > 0
+			|| area.width < (pDock->container.bIsHorizontal ? pDock->container.iWidth : pDock->container.iHeight)
+			|| area.height < (pDock->container.bIsHorizontal ? pDock->container.iHeight : pDock->container.iWidth));  // only a part of the dock is damaged (some icons redrawn during an animation step) -> limit the drawing to it.
 		
-		if (! gldi_gl_container_begin_draw_full (CAIRO_CONTAINER (pDock), area.x + area.y != 0 ? &area : NULL, TRUE))
+		if (! gldi_gl_container_begin_draw_full (CAIRO_CONTAINER (pDock), bPartial ? &area : NULL, TRUE))
 			return FALSE;
 		
 		if (cairo_dock_is_loading ())
@@ -355,6 +361,59 @@ static void _cairo_dock_make_icon_glide (Icon *pPointedIcon, Icon *pMovingicon,
 		}
 	}
 }
+static void _redraw_wave_damage (CairoDock *pDock, Icon *pLastPointedIcon, Icon *pPointedIcon)
+{
+	double fXMin, fXMax;
+	Icon *pFirstIcon = cairo_dock_get_first_icon (pDock->icons);
+	if (pFirstIcon == NULL || s_bIconDragged || ! cairo_dock_get_wave_damage_linear (pDock, &fXMin, &fXMax))
+	{
+		cairo_dock_redraw_container (CAIRO_CONTAINER (pDock));
+		return;
+	}
+	
+	//\_______________ the damage is given in the fX of the icons, the view may shift them when drawing (for instance when the dock is extended).
+	double fOffset = pFirstIcon->fDrawX - pFirstIcon->fX;
+	fXMin += fOffset;
+	fXMax += fOffset;
+	
+	//\_______________ the label of the pointed icon is larger than the icon, and can be moved to stay inside the dock.
+	Icon *pIcons[2] = {pLastPointedIcon, pPointedIcon};
+	Icon *icon;
+	double xc, w;
+	int i;
+	for (i = 0; i < 2; i ++)
+	{
+		icon = pIcons[i];
+		if (icon == NULL || icon->label.iWidth == 0)
+			continue;
+		xc = icon->fDrawX + icon->fWidth * icon->fScale / 2;
+		w = MAX (icon->label.iWidth, icon->label.iHeight);  // the label can be drawn horizontally on a vertical dock.
+		fXMin = MIN (fXMin, xc - w);
+		fXMax = MAX (fXMax, xc + w);
+	}
+	
+	//\_______________ redraw the whole height of the dock, the icons being zoomed upwards.
+	int x = (int) floor (MAX (0., fXMin - 1));  // the bounds can be infinite.
+	int x2 = (int) ceil (MIN ((double) pDock->container.iWidth, fXMax + 1));
+	if (x2 <= x)
+		return;
+	GdkRectangle area;
+	if (pDock->container.bIsHorizontal)
+	{
+		area.x = x;
+		area.y = 0;
+		area.width = x2 - x;
+		area.height = pDock->container.iHeight;
+	}
+	else
+	{
+		area.x = 0;
+		area.y = x;
+		area.width = pDock->container.iHeight;
+		area.height = x2 - x;
+	}
+	cairo_dock_redraw_container_area (CAIRO_CONTAINER (pDock), &area);
+}
 static gboolean _on_motion_notify (GtkWidget* pWidget,
 	GdkEventMotion* pMotion,
 	CairoDock *pDock)
@@ -419,7 +478,7 @@ static gboolean _on_motion_notify (GtkWidget* pWidget,
 		//\_______________ On recalcule toutes les icones et on redessine.
 		pPointedIcon = cairo_dock_calculate_dock_icons (pDock);
 		//g_print ("pPointedIcon: %s\n", pPointedIcon?pPointedIcon->cName:"none");
-		gtk_widget_queue_draw (pWidget);
+		_redraw_wave_damage (pDock, pLastPointedIcon, pPointedIcon);
 		fLastTime = pMotion->time;
 		
 		//\_______________ On tire l'icone cliquee.
@@ -1986,6 +2045,7 @@ static void _detach_icon (GldiContainer *pContainer, Icon *icon)
 	//\___________________ On l'enleve de la liste.
 	pDock->icons = g_list_delete_link (pDock->icons, ic);
 	ic = NULL;
+	cairo_dock_invalidate_wave_linear (pDock);
 	pDock->fFlatDockWidth -= icon->fWidth + myIconsParam.iIconGap;
 	
 	//\___________________ On enleve le separateur si c'est la derniere icone de son type.
@@ -2091,6 +2151,7 @@ static void _insert_icon (GldiContainer *pContainer, Icon *icon, gboolean bAnima
 	pDock->icons = g_list_insert_sorted (pDock->icons,
 		icon,
 		(GCompareFunc)cairo_dock_compare_icons_order);
+	cairo_dock_invalidate_wave_linear (pDock);
 	
 	//\______________ set the icon size, now that it's inside a container.
 	int wi = icon->image.iWidth, hi = icon->image.iHeight;
@@ -2131,6 +2192,7 @@ static void _insert_icon (GldiContainer *pContainer, Icon *icon, gboolean bAnima
 			icon->fInsertRemoveFactor = - 0.95;
 		else
 			icon->fInsertRemoveFactor = - 0.05;
+		cairo_dock_invalidate_wave_linear (pDock);
 		cairo_dock_launch_animation (CAIRO_CONTAINER (pDock));
 	}
 	else
@@ -2259,6 +2321,7 @@ void cairo_dock_remove_icons_from_dock (CairoDock *pDock, CairoDock *pReceivingD
 	g_return_if_fail (pReceivingDock != NULL);
 	GList *pIconsList = pDock->icons;
 	pDock->icons = NULL;
+	cairo_dock_invalidate_wave_linear (pDock);
 	Icon *icon;
 	GList *ic;
 	for (ic = pIconsList; ic != NULL; ic = ic->next)
@@ -2412,6 +2475,7 @@ void cairo_dock_set_icon_size_in_dock (CairoDock *pDock, Icon *icon)
 	// take into account the current ratio
 	icon->fWidth *= pDock->container.fRatio;
 	icon->fHeight *= pDock->container.fRatio;
+	cairo_dock_invalidate_wave_linear (pDock);
 }
 
 
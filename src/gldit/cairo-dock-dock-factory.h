@@ -290,7 +290,13 @@ struct _CairoDock {
 	GLuint iRedirectedTexture;
 	GLuint iFboId;
 	
-	gpointer reserved[4];
+	//\_______________ wave (taken from the reserved slots, so that the size of the structure doesn't change).
+	/// layout of the icons used to compute the wave, private.
+	gpointer pWaveLayout;
+	/// incremented each time the geometry of the icons changes (see \ref cairo_dock_invalidate_wave_linear).
+	guint iGeometryStamp;
+	
+	gpointer reserved[2];
 };
 
 
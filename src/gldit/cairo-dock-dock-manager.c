@@ -2037,6 +2037,8 @@ static void reset_object (GldiObject *obj)
 {
 	CairoDock *pDock = (CairoDock*)obj;
 	
+	cairo_dock_free_wave_linear (pDock);
+	
 	// stop timers
 	if (pDock->iSidUnhideDelayed != 0)
 		g_source_remove (pDock->iSidUnhideDelayed);
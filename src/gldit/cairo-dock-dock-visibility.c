@@ -28,6 +28,174 @@
 #include "cairo-dock-dock-visibility.h"
 
 
+  ///////////////////
+ // Overlap index //
+///////////////////
+
+// windows are indexed in a uniform grid over the screen, one grid per desktop (-1 for the windows that are on all desktops), so that an overlap test only looks at the windows near the dock.
+#define GLDI_OVERLAP_GRID_SIZE 16
+
+typedef struct {
+	GldiWindowActor *actor;
+	int iNumDesktop;  // desktop of the grid it is in
+	int iCellX0, iCellY0, iCellX1, iCellY1;  // cells it covers (inclusive), iCellX0 > iCellX1 if it is not on the screen
+	guint iQueryStamp;  // to test each window once per query
+	} GldiOverlapEntry;
+
+typedef struct {
+	GPtrArray *pCells[GLDI_OVERLAP_GRID_SIZE * GLDI_OVERLAP_GRID_SIZE];
+	} GldiOverlapGrid;
+
+static GHashTable *s_hOverlapEntries = NULL;  // actor -> entry
+static GHashTable *s_hOverlapGrids = NULL;  // desktop number -> grid
+static guint s_iQueryStamp = 0;
+static guint s_iNbTestedWindows = 0;  // number of windows tested against a dock since the beginning
+static guint s_iNbOverlaps = 0;  // number of queries that found an overlapping window
+
+static void _free_overlap_grid (GldiOverlapGrid *pGrid)
+{
+	int i;
+	for (i = 0; i < GLDI_OVERLAP_GRID_SIZE * GLDI_OVERLAP_GRID_SIZE; i ++)
+	{
+		if (pGrid->pCells[i] != NULL)
+			g_ptr_array_free (pGrid->pCells[i], TRUE);
+	}
+	g_free (pGrid);
+}
+
+static inline int _get_cell (int x, int iSize)
+{
+	if (x < 0)
+		return 0;
+	if (x >= iSize)
+		return GLDI_OVERLAP_GRID_SIZE - 1;
+	return (int)((gint64)x * GLDI_OVERLAP_GRID_SIZE / iSize);
+}
+
+// get the cells covered by a rectangle (in the coordinates of the current viewport); FALSE if it's outside of the screen.
+static gboolean _get_cells (GtkAllocation *pArea, int *x0, int *y0, int *x1, int *y1)
+{
+	int W = gldi_desktop_get_width (), H = gldi_desktop_get_height ();
+	if (pArea->width <= 0 || pArea->height <= 0 || W <= 0 || H <= 0
+	|| pArea->x + pArea->width <= 0 || pArea->x >= W || pArea->y + pArea->height <= 0 || pArea->y >= H)
+		return FALSE;
+	*x0 = _get_cell (pArea->x, W);
+	*x1 = _get_cell (pArea->x + pArea->width - 1, W);
+	*y0 = _get_cell (pArea->y, H);
+	*y1 = _get_cell (pArea->y + pArea->height - 1, H);
+	return TRUE;
+}
+
+static void _remove_from_overlap_grid (GldiOverlapEntry *pEntry)
+{
+	if (pEntry->iCellX0 > pEntry->iCellX1)
+		return;
+	GldiOverlapGrid *pGrid = g_hash_table_lookup (s_hOverlapGrids, GINT_TO_POINTER (pEntry->iNumDesktop));
+	int i, j;
+	for (j = pEntry->iCellY0; j <= pEntry->iCellY1; j ++)
+		for (i = pEntry->iCellX0; i <= pEntry->iCellX1; i ++)
+			g_ptr_array_remove_fast (pGrid->pCells[j * GLDI_OVERLAP_GRID_SIZE + i], pEntry);
+	pEntry->iCellX0 = 1;
+	pEntry->iCellX1 = 0;
+}
+
+static void _update_overlap_index (GldiWindowActor *actor)
+{
+	GldiOverlapEntry *pEntry = g_hash_table_lookup (s_hOverlapEntries, actor);
+	if (pEntry == NULL)
+	{
+		pEntry = g_new0 (GldiOverlapEntry, 1);
+		pEntry->actor = actor;
+		pEntry->iCellX0 = 1;  // not in a grid yet
+		g_hash_table_insert (s_hOverlapEntries, actor, pEntry);
+	}
+	
+	int x0, y0, x1, y1;
+	if (! _get_cells (&actor->windowGeometry, &x0, &y0, &x1, &y1))
+	{
+		_remove_from_overlap_grid (pEntry);
+		return;
+	}
+	if (pEntry->iNumDesktop == actor->iNumDesktop && pEntry->iCellX0 == x0 && pEntry->iCellX1 == x1 && pEntry->iCellY0 == y0 && pEntry->iCellY1 == y1)
+		return;  // still in the same cells (the usual case while dragging a window)
+	_remove_from_overlap_grid (pEntry);
+	
+	GldiOverlapGrid *pGrid = g_hash_table_lookup (s_hOverlapGrids, GINT_TO_POINTER (actor->iNumDesktop));
+	if (pGrid == NULL)
+	{
+		pGrid = g_new0 (GldiOverlapGrid, 1);
+		g_hash_table_insert (s_hOverlapGrids, GINT_TO_POINTER (actor->iNumDesktop), pGrid);
+	}
+	int i, j;
+	GPtrArray **pCell;
+	for (j = y0; j <= y1; j ++)
+	{
+		for (i = x0; i <= x1; i ++)
+		{
+			pCell = &pGrid->pCells[j * GLDI_OVERLAP_GRID_SIZE + i];
+			if (*pCell == NULL)
+				*pCell = g_ptr_array_new ();
+			g_ptr_array_add (*pCell, pEntry);
+		}
+	}
+	pEntry->iNumDesktop = actor->iNumDesktop;
+	pEntry->iCellX0 = x0;
+	pEntry->iCellX1 = x1;
+	pEntry->iCellY0 = y0;
+	pEntry->iCellY1 = y1;
+}
+
+static void _remove_from_overlap_index (GldiWindowActor *actor)
+{
+	GldiOverlapEntry *pEntry = g_hash_table_lookup (s_hOverlapEntries, actor);
+	if (pEntry != NULL)
+	{
+		_remove_from_overlap_grid (pEntry);
+		g_hash_table_remove (s_hOverlapEntries, actor);  // frees the entry
+	}
+}
+
+static void _rebuild_overlap_index (void)
+{
+	g_hash_table_remove_all (s_hOverlapEntries);
+	g_hash_table_remove_all (s_hOverlapGrids);
+	gldi_windows_foreach (FALSE, (GFunc)_update_overlap_index, NULL);
+}
+
+static GldiWindowActor *_search_overlapping_window_in_grid (int iNumDesktop, int x0, int y0, int x1, int y1, CairoDock *pDock)
+{
+	GldiOverlapGrid *pGrid = g_hash_table_lookup (s_hOverlapGrids, GINT_TO_POINTER (iNumDesktop));
+	if (pGrid == NULL)
+		return NULL;
+	GPtrArray *pCell;
+	GldiOverlapEntry *pEntry;
+	GldiWindowActor *actor;
+	int i, j;
+	guint k;
+	for (j = y0; j <= y1; j ++)
+	{
+		for (i = x0; i <= x1; i ++)
+		{
+			pCell = pGrid->pCells[j * GLDI_OVERLAP_GRID_SIZE + i];
+			if (pCell == NULL)
+				continue;
+			for (k = 0; k < pCell->len; k ++)
+			{
+				pEntry = g_ptr_array_index (pCell, k);
+				if (pEntry->iQueryStamp == s_iQueryStamp)  // already tested in another cell
+					continue;
+				pEntry->iQueryStamp = s_iQueryStamp;
+				s_iNbTestedWindows ++;
+				actor = pEntry->actor;
+				if (! actor->bIsHidden && gldi_window_is_on_current_desktop (actor) && gldi_dock_overlaps_window (pDock, actor))
+					return actor;
+			}
+		}
+	}
+	return NULL;
+}
+
+
   /////////////////////
  // Dock visibility //
 /////////////////////
@@ -146,6 +314,8 @@ static void _hide_if_any_overlap_or_show (CairoDock *pDock, G_GNUC_UNUSED gpoint
 
 static gboolean _on_window_created (G_GNUC_UNUSED gpointer data, GldiWindowActor *actor)
 {
+	_update_overlap_index (actor);
+	
 	// docks visibility on overlap any
 	/// see how to handle modal dialogs ...
 	gldi_docks_foreach_root ((GFunc)_hide_if_overlap, actor);
@@ -155,6 +325,8 @@ static gboolean _on_window_created (G_GNUC_UNUSED gpointer data, GldiWindowActor
 
 static gboolean _on_window_destroyed (G_GNUC_UNUSED gpointer data, GldiWindowActor *actor)
 {
+	_remove_from_overlap_index (actor);
+	
 	// docks visibility on overlap any
 	gboolean bIsHidden = actor->bIsHidden;  // the window is already destroyed, but the actor is still valid (it represents the last state of the window); temporarily make it hidden so that it doesn't overlap the dock (that's a bit tricky, we could also add an "except-this-window" parameter to 'gldi_dock_search_overlapping_window()')
 	actor->bIsHidden = TRUE;
@@ -166,6 +338,8 @@ static gboolean _on_window_destroyed (G_GNUC_UNUSED gpointer data, GldiWindowAct
 
 static gboolean _on_window_size_position_changed (G_GNUC_UNUSED gpointer data, GldiWindowActor *actor)
 {
+	_update_overlap_index (actor);
+	
 	// docks visibility on overlap any
 	if (! gldi_window_is_on_current_desktop (actor))  // not on this desktop/viewport any more
 	{
@@ -210,6 +384,8 @@ static gboolean _on_window_state_changed (G_GNUC_UNUSED gpointer data, GldiWindo
 
 static gboolean _on_window_desktop_changed (G_GNUC_UNUSED gpointer data, GldiWindowActor *actor)
 {
+	_update_overlap_index (actor);
+	
 	// docks visibility on overlap active
 	if (actor == gldi_windows_get_active())  // c'est la fenetre courante qui a change de bureau.
 	{
@@ -242,6 +418,18 @@ static gboolean _on_desktop_changed (G_GNUC_UNUSED gpointer data)
 }
 
 
+static gboolean _on_desktop_geometry_changed (G_GNUC_UNUSED gpointer data, G_GNUC_UNUSED gboolean bResolutionChanged)
+{
+	_rebuild_overlap_index ();  // the cells depend on the size of the screen, and the windows may have been moved
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+
+static gboolean _on_window_object_destroyed (G_GNUC_UNUSED gpointer data, GldiWindowActor *actor)
+{
+	_remove_from_overlap_index (actor);  // in case it didn't go through NOTIFICATION_WINDOW_DESTROYED
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+
 static gboolean _on_active_window_changed (G_GNUC_UNUSED gpointer data, GldiWindowActor *actor)
 {
 	// docks visibility on overlap active
@@ -265,27 +453,33 @@ void gldi_dock_hide_if_any_window_overlap_or_show (CairoDock *pDock)
 	_hide_if_any_overlap_or_show (pDock, NULL);
 }
 
+// get the area of a dock that a window must not overlap, in the coordinates of the screen.
+static void _get_dock_area (CairoDock *pDock, GtkAllocation *pArea)
+{
+	if (pDock->container.bIsHorizontal)
+	{
+		pArea->width = pDock->iMinDockWidth;
+		pArea->height = pDock->iMinDockHeight;
+		pArea->x = pDock->container.iWindowPositionX + (pDock->container.iWidth - pArea->width)/2;
+		pArea->y = pDock->container.iWindowPositionY + (pDock->container.bDirectionUp ? pDock->container.iHeight - pDock->iMinDockHeight : 0);
+	}
+	else
+	{
+		pArea->width = pDock->iMinDockHeight;
+		pArea->height = pDock->iMinDockWidth;
+		pArea->x = pDock->container.iWindowPositionY + (pDock->container.bDirectionUp ? pDock->container.iHeight - pDock->iMinDockHeight : 0);
+		pArea->y = pDock->container.iWindowPositionX + (pDock->container.iWidth - pArea->height)/2;
+	}
+}
+
 static inline gboolean _window_overlaps_dock (GtkAllocation *pWindowGeometry, gboolean bIsHidden, CairoDock *pDock)
 {
 	if (pWindowGeometry->width != 0 && pWindowGeometry->height != 0)
 	{
-		int iDockX, iDockY, iDockWidth, iDockHeight;
-		if (pDock->container.bIsHorizontal)
-		{
-			iDockWidth = pDock->iMinDockWidth;
-			iDockHeight = pDock->iMinDockHeight;
-			iDockX = pDock->container.iWindowPositionX + (pDock->container.iWidth - iDockWidth)/2;
-			iDockY = pDock->container.iWindowPositionY + (pDock->container.bDirectionUp ? pDock->container.iHeight - pDock->iMinDockHeight : 0);
-		}
-		else
-		{
-			iDockWidth = pDock->iMinDockHeight;
-			iDockHeight = pDock->iMinDockWidth;
-			iDockX = pDock->container.iWindowPositionY + (pDock->container.bDirectionUp ? pDock->container.iHeight - pDock->iMinDockHeight : 0);
-			iDockY = pDock->container.iWindowPositionX + (pDock->container.iWidth - iDockHeight)/2;
-		}
+		GtkAllocation area;
+		_get_dock_area (pDock, &area);
 		
-		if (! bIsHidden && pWindowGeometry->x < iDockX + iDockWidth && pWindowGeometry->x + pWindowGeometry->width > iDockX && pWindowGeometry->y < iDockY + iDockHeight && pWindowGeometry->y + pWindowGeometry->height > iDockY)
+		if (! bIsHidden && pWindowGeometry->x < area.x + area.width && pWindowGeometry->x + pWindowGeometry->width > area.x && pWindowGeometry->y < area.y + area.height && pWindowGeometry->y + pWindowGeometry->height > area.y)
 		{
 			return TRUE;
 		}
@@ -301,21 +495,28 @@ gboolean gldi_dock_overlaps_window (CairoDock *pDock, GldiWindowActor *actor)
 	return _window_overlaps_dock (&actor->windowGeometry, actor->bIsHidden, pDock);
 }
 
-static gboolean _window_is_overlapping_dock (GldiWindowActor *actor, gpointer data)
+GldiWindowActor *gldi_dock_search_overlapping_window (CairoDock *pDock)
 {
-	CairoDock *pDock = CAIRO_DOCK (data);
-	if (gldi_window_is_on_current_desktop (actor) && ! actor->bIsHidden)
-	{
-		if (gldi_dock_overlaps_window (pDock, actor))
-		{
-			return TRUE;
-		}
-	}
-	return FALSE;
+	// only look at the windows that are in the cells covered by the dock, on the current desktop or on all desktops
+	GtkAllocation area;
+	_get_dock_area (pDock, &area);
+	int x0, y0, x1, y1;
+	if (! _get_cells (&area, &x0, &y0, &x1, &y1))
+		return NULL;
+	s_iQueryStamp ++;
+	GldiWindowActor *actor = _search_overlapping_window_in_grid (g_desktopGeometry.iCurrentDesktop, x0, y0, x1, y1, pDock);
+	if (actor == NULL)
+		actor = _search_overlapping_window_in_grid (-1, x0, y0, x1, y1, pDock);
+	if (actor != NULL)
+		s_iNbOverlaps ++;
+	return actor;
 }
-GldiWindowActor *gldi_dock_search_overlapping_window (CairoDock *pDock)
+
+void gldi_docks_get_overlap_stats (guint *iNbQueries, guint *iNbTestedWindows, guint *iNbOverlaps)
 {
-	return gldi_windows_find (_window_is_overlapping_dock, pDock);
+	*iNbQueries = s_iQueryStamp;
+	*iNbTestedWindows = s_iNbTestedWindows;
+	*iNbOverlaps = s_iNbOverlaps;
 }
 
 
@@ -331,6 +532,8 @@ void gldi_docks_visibility_start (void)
 	if (first)
 	{
 		first = FALSE;
+		s_hOverlapEntries = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+		s_hOverlapGrids = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify)_free_overlap_grid);
 		gldi_object_register_notification (&myWindowObjectMgr,
 			NOTIFICATION_WINDOW_CREATED,
 			(GldiNotificationFunc) _on_window_created,
@@ -359,7 +562,16 @@ void gldi_docks_visibility_start (void)
 			NOTIFICATION_WINDOW_ACTIVATED,
 			(GldiNotificationFunc) _on_active_window_changed,
 			GLDI_RUN_FIRST, NULL);
+		gldi_object_register_notification (&myDesktopMgr,
+			NOTIFICATION_DESKTOP_GEOMETRY_CHANGED,
+			(GldiNotificationFunc) _on_desktop_geometry_changed,
+			GLDI_RUN_FIRST, NULL);
+		gldi_object_register_notification (&myWindowObjectMgr,
+			NOTIFICATION_DESTROY,
+			(GldiNotificationFunc) _on_window_object_destroyed,
+			GLDI_RUN_FIRST, NULL);
 	}
+	_rebuild_overlap_index ();  // index the windows that already exist
 	
 	// handle current docks visibility
 	GldiWindowActor *pCurrentAppli = gldi_windows_get_active ();
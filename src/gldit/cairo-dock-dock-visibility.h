@@ -43,6 +43,13 @@ gboolean gldi_dock_overlaps_window (CairoDock *pDock, GldiWindowActor *actor);
 */
 GldiWindowActor *gldi_dock_search_overlapping_window (CairoDock *pDock);
 
+/** Get some statistics about the searches of overlapping windows, since the beginning.
+*@param iNbQueries filled with the number of searches that were made.
+*@param iNbTestedWindows filled with the number of windows tested during these searches; only the windows near the docks are tested.
+*@param iNbOverlaps filled with the number of searches that found a window.
+*/
+void gldi_docks_get_overlap_stats (guint *iNbQueries, guint *iNbTestedWindows, guint *iNbOverlaps);
+
 
 void gldi_docks_visibility_start (void);
 
@@ -885,6 +885,7 @@ void cairo_dock_draw_hidden_appli_icon (Icon *pIcon, GldiContainer *pContainer,
 	if (bStateChanged)
 	{
 		cairo_dock_remove_transition_on_icon (pIcon);
+		cairo_dock_image_buffer_make_private (&pIcon->image);  // the texture of the icon is replaced.
 		
 		GLuint iOriginalTexture;
 		if (pIcon->pAppli->bIsHidden)
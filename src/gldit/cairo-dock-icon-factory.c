@@ -37,13 +37,30 @@
 #include "cairo-dock-icon-facility.h"
 #include "cairo-dock-data-renderer.h"
 #include "cairo-dock-overlay.h"
+#include "cairo-dock-task.h"
+#include "cairo-dock-opengl-font.h"  // cairo_dock_load_gl_font_from_text_description
 #include "cairo-dock-icon-factory.h"
 
 extern CairoDockImageBuffer g_pIconBackgroundBuffer;
-//extern gboolean g_bUseOpenGL;
+extern gboolean g_bUseOpenGL;
 
 const gchar *s_cRendererNames[4] = {NULL, "Emblem", "Stack", "Box"};  // c'est juste pour realiser la transition entre le chiffre en conf, et un nom (limitation du panneau de conf). On garde le numero pour savoir rapidement sur laquelle on set.
 
+typedef struct {
+	Icon *pIcon;
+	gchar *cIconPath;
+	int iWidth, iHeight;
+	GldiTask *pTask;
+	cairo_surface_t *pSurface;
+	gboolean bDecoded;
+} GldiIconImageRequest;
+
+static GQueue s_pDecodedImages = G_QUEUE_INIT;  // requests whose image is ready, waiting to be uploaded into their icon.
+static guint s_iSidUploadImages = 0;
+static GldiIconImageRequest *s_pUploadingRequest = NULL;  // request being uploaded into its icon.
+
+#define GLDI_ICON_IMAGES_UPLOADS_PER_FRAME 4  // the upload includes the creation of the texture, so we spread it over several main loop iterations, to let the containers redraw in-between.
+
 
 Icon *gldi_icon_new (void)
 {
@@ -114,8 +131,11 @@ void cairo_dock_load_icon_image (Icon *icon, G_GNUC_UNUSED GldiContainer *pConta
 	g_return_if_fail (icon->fWidth > 0); // should never happen; if it does, it's an error, so be noisy.
 	
 	//\______________ keep the current buffer on the icon so that the 'load' can use it (for instance, applis may draw emblems).
+	CairoDockImageBuffer prevImage;
+	memcpy (&prevImage, &icon->image, sizeof (CairoDockImageBuffer));
 	cairo_surface_t *pPrevSurface = icon->image.pSurface;
 	GLuint iPrevTexture = icon->image.iTexture;
+	gint iPrevRefCount = cairo_dock_image_buffer_get_ref_count (&icon->image);  // a shared image may be loaded again, in which case its surface is the same but it gets one more reference.
 	
 	//\______________ load the image buffer (surface + texture).
 	if (icon->iface.load_image)
@@ -123,7 +143,8 @@ void cairo_dock_load_icon_image (Icon *icon, G_GNUC_UNUSED GldiContainer *pConta
 	
 	//\______________ if nothing has changed or no image was loaded, set a default image.
 	if ((icon->image.pSurface == pPrevSurface || icon->image.pSurface == NULL)
-	&& (icon->image.iTexture == iPrevTexture || icon->image.iTexture == 0))
+	&& (icon->image.iTexture == iPrevTexture || icon->image.iTexture == 0)
+	&& (icon->image.pSurface == NULL || cairo_dock_image_buffer_get_ref_count (&icon->image) == iPrevRefCount))
 	{
 		gchar *cIconPath = cairo_dock_search_image_s_path (CAIRO_DOCK_DEFAULT_ICON_NAME);
 		if (cIconPath == NULL)  // fichier non trouve.
@@ -153,6 +174,7 @@ void cairo_dock_load_icon_image (Icon *icon, G_GNUC_UNUSED GldiContainer *pConta
 		}
 		else if (icon->image.pSurface != NULL)
 		{
+			cairo_dock_image_buffer_make_private (&icon->image);
 			cairo_t *pCairoIconBGContext = cairo_create (icon->image.pSurface);
 			cairo_set_operator (pCairoIconBGContext, CAIRO_OPERATOR_DEST_OVER);
 			cairo_dock_apply_image_buffer_surface_at_size (&g_pIconBackgroundBuffer, pCairoIconBGContext,
@@ -162,14 +184,12 @@ void cairo_dock_load_icon_image (Icon *icon, G_GNUC_UNUSED GldiContainer *pConta
 		}
 	}
 	
-	//\______________ free the previous buffers.
-	if (pPrevSurface != NULL)
-		cairo_surface_destroy (pPrevSurface);
-	if (iPrevTexture != 0)
-		_cairo_dock_delete_texture (iPrevTexture);
+	//\______________ free the previous buffers (or release them if they are shared).
+	cairo_dock_unload_image_buffer (&prevImage);
 	
 	if (pInstance && icon->image.pSurface != NULL)
 	{
+		cairo_dock_image_buffer_make_private (&icon->image);  // the applet will draw on it.
 		pInstance->pDrawContext = cairo_create (icon->image.pSurface);
 		if (!pInstance->pDrawContext || cairo_status (pInstance->pDrawContext) != CAIRO_STATUS_SUCCESS)
 		{
@@ -192,15 +212,63 @@ void cairo_dock_load_icon_text (Icon *icon)
 		cTruncatedName = cairo_dock_cut_string (icon->cName, myTaskbarParam.iAppliMaxNameLength);
 	}
 	
-	int iWidth, iHeight;
-	cairo_surface_t *pSurface = cairo_dock_create_surface_from_text ((cTruncatedName != NULL ? cTruncatedName : icon->cName),
+	cairo_dock_load_image_buffer_from_text (&icon->label,
+		(cTruncatedName != NULL ? cTruncatedName : icon->cName),
 		&myIconsParam.iconTextDescription,
-		&iWidth,
-		&iHeight);
-	cairo_dock_load_image_buffer_from_surface (&icon->label, pSurface, iWidth, iHeight);
+		1.,
+		0);  // many windows can have the same title, so the label is shared.
 	g_free (cTruncatedName);
 }
 
+static GHashTable *s_pQuickInfoFonts = NULL;  // scale (x1000) -> font used to draw the quick-info in OpenGL
+
+static gboolean _can_draw_quickinfo_with_gl_font (const gchar *cText)
+{
+	if (myIconsParam.quickInfoTextDescription.bUseMarkup || ! g_utf8_validate (cText, -1, NULL))
+		return FALSE;
+	// the glyphs are placed one after the other, which is fine for these scripts; the other ones need a real layout.
+	const gchar *str;
+	gunichar c;
+	for (str = cText; *str != '\0'; str = g_utf8_next_char (str))
+	{
+		c = g_utf8_get_char (str);
+		if (g_unichar_iscntrl (c) || g_unichar_iszerowidth (c))
+			return FALSE;
+		switch (g_unichar_get_script (c))
+		{
+			case G_UNICODE_SCRIPT_COMMON:
+			case G_UNICODE_SCRIPT_LATIN:
+			case G_UNICODE_SCRIPT_GREEK:
+			case G_UNICODE_SCRIPT_CYRILLIC:
+			break;
+			default:
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static CairoDockGLFont *_get_quickinfo_font (double fMaxScale)
+{
+	if (s_pQuickInfoFonts == NULL)
+		s_pQuickInfoFonts = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)cairo_dock_free_gl_font);
+	gpointer key = GINT_TO_POINTER ((int) round (fMaxScale * 1000));
+	CairoDockGLFont *pFont = g_hash_table_lookup (s_pQuickInfoFonts, key);
+	if (pFont == NULL)
+	{
+		pFont = cairo_dock_load_gl_font_from_text_description (&myIconsParam.quickInfoTextDescription, fMaxScale);
+		if (pFont != NULL)
+			g_hash_table_insert (s_pQuickInfoFonts, key, pFont);
+	}
+	return pFont;
+}
+
+void cairo_dock_reset_quickinfo_fonts (void)
+{
+	if (s_pQuickInfoFonts != NULL)
+		g_hash_table_remove_all (s_pQuickInfoFonts);  // the overlays keep a reference on their font until they're reloaded.
+}
+
 void cairo_dock_load_icon_quickinfo (Icon *icon)
 {
 	if (icon->cQuickInfo == NULL)  // no more quick-info -> remove any previous one
@@ -215,12 +283,23 @@ void cairo_dock_load_icon_quickinfo (Icon *icon)
 		if (iHeight / (myIconsParam.quickInfoTextDescription.iSize * fMaxScale) > 5)  // if the icon is very height (the text occupies less than 20% of the icon)
 			fMaxScale = MIN ((double)iHeight / (myIconsParam.quickInfoTextDescription.iSize * 5), MAX (1., 16./myIconsParam.quickInfoTextDescription.iSize) * fMaxScale);  // let's make it use 20% of the icon's height, limited to 16px
 		int w, h;
-		cairo_surface_t *pSurface = cairo_dock_create_surface_from_text_full (icon->cQuickInfo,
+		if (g_bUseOpenGL && _can_draw_quickinfo_with_gl_font (icon->cQuickInfo))  // draw the text with a glyph atlas, so that a quick-info updated every second doesn't create a new texture each time.
+		{
+			CairoDockGLFont *pFont = _get_quickinfo_font (fMaxScale);
+			if (pFont != NULL)
+			{
+				cairo_dock_get_gl_decorated_text_extent (icon->cQuickInfo, pFont, iWidth, &w, &h);
+				CairoOverlay *pOverlay = cairo_dock_add_overlay_from_gl_text (icon, icon->cQuickInfo, pFont, w, h, CAIRO_OVERLAY_BOTTOM, (gpointer)"quick-info");
+				if (pOverlay)
+					cairo_dock_set_overlay_scale (pOverlay, 0);
+				return;
+			}
+		}
+		CairoOverlay *pOverlay = cairo_dock_add_overlay_from_text (icon, icon->cQuickInfo,
 			&myIconsParam.quickInfoTextDescription,
 			fMaxScale,
 			iWidth,  // limit the text to the width of the icon
-			&w, &h);
-		CairoOverlay *pOverlay = cairo_dock_add_overlay_from_surface (icon, pSurface, w, h, CAIRO_OVERLAY_BOTTOM, (gpointer)"quick-info");  // the constant string "quick-info" is used as a unique identifier for all quick-infos; the surface is taken by the overlay.
+			CAIRO_OVERLAY_BOTTOM, (gpointer)"quick-info");  // the constant string "quick-info" is used as a unique identifier for all quick-infos.
 		if (pOverlay)
 			cairo_dock_set_overlay_scale (pOverlay, 0);
 	}
@@ -249,6 +328,15 @@ void cairo_dock_load_icon_buffers (Icon *pIcon, GldiContainer *pContainer)
 	}
 }
 
+static void _reload_icon_image (Icon *pIcon, GldiContainer *pContainer)
+{
+	cairo_dock_load_icon_image (pIcon, pContainer);
+	
+	if (cairo_dock_get_icon_data_renderer (pIcon) != NULL)
+		cairo_dock_refresh_data_renderer (pIcon, pContainer);
+	
+	cairo_dock_redraw_icon (pIcon);
+}
 static gboolean _load_icon_buffer_idle (Icon *pIcon)
 {
 	//g_print ("%s (%s; %dx%d; %.2fx%.2f; %x)\n", __func__, pIcon->cName, pIcon->iAllocatedWidth, pIcon->iAllocatedHeight, pIcon->fWidth, pIcon->fHeight, pIcon->pContainer);
@@ -257,14 +345,9 @@ static gboolean _load_icon_buffer_idle (Icon *pIcon)
 	GldiContainer *pContainer = pIcon->pContainer;
 	if (pContainer)
 	{
-		cairo_dock_load_icon_image (pIcon, pContainer);
-		
-		if (cairo_dock_get_icon_data_renderer (pIcon) != NULL)
-			cairo_dock_refresh_data_renderer (pIcon, pContainer);
+		_reload_icon_image (pIcon, pContainer);
 		
 		cairo_dock_load_icon_quickinfo (pIcon);
-		
-		cairo_dock_redraw_icon (pIcon);
 		//g_print ("icon-factory: do 1 main loop iteration\n");
 		//gtk_main_iteration_do (FALSE);  /// "unforseen consequences" : if _redraw_subdock_content_idle is planned just after, the container-icon stays blank in opengl only. couldn't figure why exactly :-/
 	}
@@ -280,6 +363,125 @@ void cairo_dock_trigger_load_icon_buffers (Icon *pIcon)
 }
 
 
+static void _free_icon_image_request (GldiIconImageRequest *pRequest)
+{
+	if (pRequest->pSurface != NULL)
+		cairo_surface_destroy (pRequest->pSurface);
+	g_free (pRequest->cIconPath);
+	g_free (pRequest);
+}
+
+static gboolean _upload_decoded_images_idle (G_GNUC_UNUSED gpointer data)
+{
+	GldiIconImageRequest *pRequest;
+	Icon *pIcon;
+	int i;
+	for (i = 0; i < GLDI_ICON_IMAGES_UPLOADS_PER_FRAME && (pRequest = g_queue_pop_head (&s_pDecodedImages)) != NULL; i ++)
+	{
+		pIcon = pRequest->pIcon;
+		pIcon->pImageRequest = NULL;
+		if (pIcon->pContainer != NULL
+		&& pIcon->iSidLoadImage == 0  // else a reload is already planned
+		&& cairo_dock_icon_get_allocated_width (pIcon) == pRequest->iWidth
+		&& cairo_dock_icon_get_allocated_height (pIcon) == pRequest->iHeight)  // else the icon has been resized or detached in the meantime, and its image will be loaded again anyway.
+		{
+			s_pUploadingRequest = pRequest;
+			_reload_icon_image (pIcon, pIcon->pContainer);  // reload the image the usual way, which will take the decoded surface.
+			s_pUploadingRequest = NULL;
+		}
+		gldi_task_free (pRequest->pTask);
+		_free_icon_image_request (pRequest);
+	}
+	if (g_queue_is_empty (&s_pDecodedImages))
+	{
+		s_iSidUploadImages = 0;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static void _on_icon_image_decoded (cairo_surface_t *pSurface, G_GNUC_UNUSED double fImageWidth, G_GNUC_UNUSED double fImageHeight, GldiIconImageRequest *pRequest)
+{
+	pRequest->pSurface = pSurface;
+	pRequest->bDecoded = TRUE;
+	g_queue_push_tail (&s_pDecodedImages, pRequest);
+	if (s_iSidUploadImages == 0)
+		s_iSidUploadImages = g_idle_add ((GSourceFunc)_upload_decoded_images_idle, NULL);  // default idle priority, so that the redraws go first.
+}
+
+void cairo_dock_cancel_icon_image_loading (Icon *icon)
+{
+	GldiIconImageRequest *pRequest = icon->pImageRequest;
+	if (pRequest == NULL)
+		return;
+	icon->pImageRequest = NULL;
+	if (pRequest->bDecoded)  // waiting to be uploaded
+	{
+		g_queue_remove (&s_pDecodedImages, pRequest);
+		gldi_task_free (pRequest->pTask);
+	}
+	else  // still being decoded, let the thread finish and forget it; the callback won't be called.
+	{
+		gldi_task_discard (pRequest->pTask);
+	}
+	_free_icon_image_request (pRequest);
+}
+
+void cairo_dock_load_icon_image_from_file (Icon *icon, const gchar *cIconPath, int iWidth, int iHeight)
+{
+	cairo_surface_t *pSurface;
+	GldiIconImageRequest *pRequest = s_pUploadingRequest;
+	if (cairo_dock_load_image_buffer_from_shared_image (&icon->image, cIconPath, iWidth, iHeight, CAIRO_DOCK_FILL_SPACE))  // the same image is already used by another icon (typically a launcher and its applis).
+	{
+		cairo_dock_cancel_icon_image_loading (icon);
+		return;
+	}
+	if (pRequest != NULL && pRequest->pIcon == icon
+	&& pRequest->iWidth == iWidth && pRequest->iHeight == iHeight
+	&& strcmp (pRequest->cIconPath, cIconPath) == 0)  // the image has been decoded, take it.
+	{
+		pSurface = pRequest->pSurface;  // may be NULL if the image couldn't be loaded, in which case the default image will be used.
+		pRequest->pSurface = NULL;
+		cairo_dock_load_image_buffer_from_surface (&icon->image, pSurface, iWidth, iHeight);
+		cairo_dock_share_image_buffer (&icon->image, cIconPath, iWidth, iHeight, CAIRO_DOCK_FILL_SPACE);
+		return;
+	}
+	else
+	{
+		cairo_dock_cancel_icon_image_loading (icon);
+		if (icon->pSubDock == NULL)  // the content of a sub-dock may be drawn on the image right after it's loaded, so the image must be loaded already.
+		{
+			pRequest = g_new0 (GldiIconImageRequest, 1);
+			pRequest->pIcon = icon;
+			pRequest->cIconPath = g_strdup (cIconPath);
+			pRequest->iWidth = iWidth;
+			pRequest->iHeight = iHeight;
+			pRequest->pTask = cairo_dock_create_surface_from_image_async (cIconPath,
+				1.,
+				iWidth,
+				iHeight,
+				CAIRO_DOCK_FILL_SPACE,
+				(CairoDockImageLoadedFunc) _on_icon_image_decoded,
+				pRequest);
+			if (pRequest->pTask != NULL)
+			{
+				icon->pImageRequest = pRequest;
+				pSurface = cairo_dock_create_blank_surface (iWidth, iHeight);  // placeholder until the image is ready; being transparent, it doesn't trigger the default image.
+			}
+			else
+			{
+				g_free (pRequest->cIconPath);
+				g_free (pRequest);
+				pSurface = cairo_dock_create_surface_from_image_simple (cIconPath, iWidth, iHeight);
+			}
+		}
+		else
+			pSurface = cairo_dock_create_surface_from_image_simple (cIconPath, iWidth, iHeight);
+	}
+	cairo_dock_load_image_buffer_from_surface (&icon->image, pSurface, iWidth, iHeight);
+}
+
+
 
   ///////////////////////
  /// CONTAINER ICONS ///
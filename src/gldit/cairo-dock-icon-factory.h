@@ -175,7 +175,8 @@ struct _Icon {
 	gint iThumbnailWidth, iThumbnailHeight;
 	
 	gboolean bIsLaunching;  // a mere recopy of gldi_class_is_starting()
-	gpointer reserved[4];
+	gpointer pImageRequest;  // image being decoded in a thread, see cairo_dock_load_icon_image_from_file (taken from the reserved slots, so that the size of the structure doesn't change).
+	gpointer reserved[3];
 };
 
 typedef void (*CairoIconContainerLoadFunc) (void);
@@ -282,11 +283,15 @@ void cairo_dock_load_icon_image (Icon *icon, GldiContainer *pContainer);
 */
 void cairo_dock_load_icon_text (Icon *icon);
 
-/**Fill the quick-info buffer (surface & texture) of a given icon, according to a text description.
+/**Fill the quick-info buffer (surface & texture) of a given icon, according to a text description. In OpenGL, simple texts are drawn directly with a font instead.
 *@param icon the icon.
 */
 void cairo_dock_load_icon_quickinfo (Icon *icon);
 
+/** Forget the fonts used to draw the quick-info in OpenGL; call it when the quick-info text description changes, before reloading the quick-info.
+*/
+void cairo_dock_reset_quickinfo_fonts (void);
+
 /** Fill all the buffers (surfaces & textures) of a given icon, according to its type. Set its size accordingly, and fills the reflection buffer for cairo. Label and quick-info are loaded with the current global text description.
 *@param pIcon the icon.
 *@param pContainer its container.
@@ -295,6 +300,19 @@ void cairo_dock_load_icon_buffers (Icon *pIcon, GldiContainer *pContainer);
 
 void cairo_dock_trigger_load_icon_buffers (Icon *pIcon);
 
+/** Load the image of an icon from a file, at a given size. This is meant to be called from the 'load_image' method of the icon. The image is decoded in a thread when possible: meanwhile, the icon gets a transparent image of the right size, and the icon's image is reloaded once the decoded image is ready.
+*@param icon the icon.
+*@param cIconPath complete path to the image.
+*@param iWidth width of the image.
+*@param iHeight height of the image.
+*/
+void cairo_dock_load_icon_image_from_file (Icon *icon, const gchar *cIconPath, int iWidth, int iHeight);
+
+/** Cancel the loading of the image of an icon started by \ref cairo_dock_load_icon_image_from_file, if any.
+*@param icon the icon.
+*/
+void cairo_dock_cancel_icon_image_loading (Icon *icon);
+
 
 void cairo_dock_draw_subdock_content_on_icon (Icon *pIcon, CairoDock *pDock);
 
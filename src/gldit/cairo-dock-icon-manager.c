@@ -20,6 +20,7 @@
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 
 #include <gtk/gtk.h>
 
@@ -49,6 +50,7 @@
 #include "cairo-dock-applet-manager.h"  // GLDI_OBJECT_IS_APPLET_ICON
 #include "cairo-dock-backends-manager.h"  // cairo_dock_foreach_icon_container_renderer
 #include "cairo-dock-style-manager.h"
+#include "cairo-dock-image-cache.h"  // cairo_dock_image_cache_flush
 #define _MANAGER_DEF_
 #include "cairo-dock-icon-manager.h"
 
@@ -72,6 +74,13 @@ static GtkIconTheme *s_pIconTheme = NULL;
 static gboolean s_bUseLocalIcons = FALSE;
 static gboolean s_bUseDefaultTheme = TRUE;
 static guint s_iSidReloadTheme = 0;
+static GHashTable *s_hIconPathCache = NULL;  // "size:name" -> path, for the icons that were found
+static gchar *s_cIconPathCacheStamp = NULL;
+static gboolean s_bIconPathCacheDirty = FALSE;
+static guint s_iSidSaveIconPathCache = 0;
+
+#define CAIRO_DOCK_ICON_PATH_CACHE_FILE "icon-paths"
+#define CAIRO_DOCK_ICON_PATH_CACHE_SAVE_DELAY 10  // s
 
 static void _cairo_dock_unload_icon_textures (void);
 static void _cairo_dock_unload_icon_theme (void);
@@ -221,6 +230,209 @@ gint cairo_dock_search_icon_size (GtkIconSize iIconSize)
 	return MAX (iWidth, iHeight);
 }
 
+static gchar *_get_icon_path_cache_file (void)
+{
+	return g_strdup_printf ("%s/%s/%s", g_get_user_cache_dir (), CAIRO_DOCK_DATA_DIR, CAIRO_DOCK_ICON_PATH_CACHE_FILE);
+}
+
+static void _append_dir_mtime (GString *sStamp, const gchar *cDir)
+{
+	struct stat buf;
+	if (stat (cDir, &buf) == 0)
+		g_string_append_printf (sStamp, "%s:%ld;", cDir, (long)buf.st_mtime);
+}
+
+// add the mtime of a theme's folders, then do the same for the themes it inherits from (once each).
+static void _append_theme_mtimes (GString *sStamp, gchar **paths, gint iNbPaths, const gchar *cThemeName, GHashTable *pVisitedThemes)
+{
+	if (g_hash_table_lookup (pVisitedThemes, cThemeName) != NULL)
+		return;
+	gchar *cKey = g_strdup (cThemeName);
+	g_hash_table_insert (pVisitedThemes, cKey, cKey);
+	
+	gchar *cDir, *cInherits = NULL;
+	int i;
+	for (i = 0; i < iNbPaths; i++)
+	{
+		cDir = g_strdup_printf ("%s/%s", paths[i], cThemeName);
+		_append_dir_mtime (sStamp, cDir);
+		if (cInherits == NULL)  // like GTK, take the parents from the first index.theme found
+		{
+			gchar *cIndexFile = g_strdup_printf ("%s/index.theme", cDir);
+			GKeyFile *pKeyFile = g_key_file_new ();
+			if (g_key_file_load_from_file (pKeyFile, cIndexFile, G_KEY_FILE_NONE, NULL))
+				cInherits = g_key_file_get_string (pKeyFile, "Icon Theme", "Inherits", NULL);
+			g_key_file_free (pKeyFile);
+			g_free (cIndexFile);
+		}
+		g_free (cDir);
+	}
+	if (cInherits != NULL)
+	{
+		gchar **cParents = g_strsplit (cInherits, ",", -1);
+		for (i = 0; cParents[i] != NULL; i++)
+		{
+			g_strstrip (cParents[i]);
+			if (*cParents[i] != '\0')
+				_append_theme_mtimes (sStamp, paths, iNbPaths, cParents[i], pVisitedThemes);
+		}
+		g_strfreev (cParents);
+		g_free (cInherits);
+	}
+}
+
+/* The stamp identifies the state of the icon theme: which theme is used, where it is searched, and the mtime of each of these directories, for the theme and all the themes it inherits from (this is what GTK itself checks to know if it has to rescan a theme, and installing an icon updates the theme's icon cache, so it changes the mtime of the theme folder).
+ */
+static gchar *_make_icon_path_cache_stamp (void)
+{
+	GString *sStamp = g_string_new ("");
+	gchar *cThemeName = NULL, *cDefaultThemeName = NULL;
+	g_object_get (gtk_settings_get_default (), "gtk-icon-theme-name", &cDefaultThemeName, NULL);
+	if (s_bUseDefaultTheme)
+		cThemeName = g_strdup (cDefaultThemeName);
+	else
+		cThemeName = g_strdup (myIconsParam.cIconTheme);
+	g_string_append_printf (sStamp, "%s;%d;", cThemeName ? cThemeName : "", s_bUseLocalIcons);
+	
+	if (s_bUseLocalIcons)
+		_append_dir_mtime (sStamp, g_cCurrentIconsPath);
+	
+	gchar **paths = NULL;
+	gint iNbPaths = 0;
+	gtk_icon_theme_get_search_path (s_pIconTheme, &paths, &iNbPaths);
+	int i;
+	for (i = 0; i < iNbPaths; i++)
+		_append_dir_mtime (sStamp, paths[i]);
+	GHashTable *pVisitedThemes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	if (cThemeName != NULL)
+		_append_theme_mtimes (sStamp, paths, iNbPaths, cThemeName, pVisitedThemes);
+	if (! s_bUseLocalIcons && cDefaultThemeName != NULL)  // icons missing from our theme are also searched in the default one.
+		_append_theme_mtimes (sStamp, paths, iNbPaths, cDefaultThemeName, pVisitedThemes);
+	_append_theme_mtimes (sStamp, paths, iNbPaths, "hicolor", pVisitedThemes);  // always the last fallback
+	g_hash_table_destroy (pVisitedThemes);
+	g_strfreev (paths);
+	g_free (cThemeName);
+	g_free (cDefaultThemeName);
+	return g_string_free (sStamp, FALSE);
+}
+
+static void _save_icon_path_cache (void)
+{
+	if (s_iSidSaveIconPathCache != 0)
+	{
+		g_source_remove (s_iSidSaveIconPathCache);
+		s_iSidSaveIconPathCache = 0;
+	}
+	if (! s_bIconPathCacheDirty || s_hIconPathCache == NULL || s_cIconPathCacheStamp == NULL)
+		return;
+	s_bIconPathCacheDirty = FALSE;
+	
+	// one line for the stamp, then one line per icon found: "size:name\tpath".
+	GString *sContent = g_string_new (s_cIconPathCacheStamp);
+	g_string_append_c (sContent, '\n');
+	GHashTableIter iter;
+	gpointer key, value;
+	g_hash_table_iter_init (&iter, s_hIconPathCache);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		if (strpbrk (key, "\t\n") != NULL || strchr (value, '\n') != NULL)
+			continue;
+		g_string_append_printf (sContent, "%s\t%s\n", (gchar*)key, (gchar*)value);
+	}
+	
+	gchar *cCacheFile = _get_icon_path_cache_file ();
+	gchar *cCacheDir = g_path_get_dirname (cCacheFile);
+	g_mkdir_with_parents (cCacheDir, 7*8*8+5*8+5);
+	GError *erreur = NULL;
+	g_file_set_contents (cCacheFile, sContent->str, sContent->len, &erreur);
+	if (erreur != NULL)
+	{
+		cd_warning ("couldn't save the icons cache: %s", erreur->message);
+		g_error_free (erreur);
+	}
+	g_free (cCacheDir);
+	g_free (cCacheFile);
+	g_string_free (sContent, TRUE);
+}
+
+static gboolean _save_icon_path_cache_idle (G_GNUC_UNUSED gpointer data)
+{
+	s_iSidSaveIconPathCache = 0;
+	_save_icon_path_cache ();
+	return FALSE;
+}
+
+static void _load_icon_path_cache (void)
+{
+	s_hIconPathCache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	s_cIconPathCacheStamp = _make_icon_path_cache_stamp ();
+	
+	gchar *cCacheFile = _get_icon_path_cache_file ();
+	gchar *cContent = NULL;
+	if (g_file_get_contents (cCacheFile, &cContent, NULL, NULL))
+	{
+		gchar *str = strchr (cContent, '\n');
+		if (str != NULL)
+		{
+			*str = '\0';
+			if (strcmp (cContent, s_cIconPathCacheStamp) == 0)  // the theme didn't change since the cache was made, we can trust it.
+			{
+				gchar *cLine = str + 1, *cPath;
+				while (*cLine != '\0')
+				{
+					str = strchr (cLine, '\n');
+					if (str != NULL)
+						*str = '\0';
+					cPath = strchr (cLine, '\t');
+					if (cPath != NULL)
+					{
+						*cPath = '\0';
+						g_hash_table_insert (s_hIconPathCache, g_strdup (cLine), g_strdup (cPath + 1));
+					}
+					if (str == NULL)
+						break;
+					cLine = str + 1;
+				}
+				cd_debug ("%d icon paths loaded from the cache", g_hash_table_size (s_hIconPathCache));
+			}
+			else
+			{
+				cd_debug ("the icon theme has changed, the icons cache will be rebuilt");
+				s_bIconPathCacheDirty = TRUE;  // overwrite the outdated cache, even if no icon is searched.
+			}
+		}
+		g_free (cContent);
+	}
+	g_free (cCacheFile);
+}
+
+static void _unload_icon_path_cache (void)
+{
+	_save_icon_path_cache ();
+	if (s_hIconPathCache != NULL)
+	{
+		g_hash_table_destroy (s_hIconPathCache);
+		s_hIconPathCache = NULL;
+	}
+	g_free (s_cIconPathCacheStamp);
+	s_cIconPathCacheStamp = NULL;
+	s_bIconPathCacheDirty = FALSE;
+}
+
+static void _invalidate_icon_path_cache (void)
+{
+	if (s_hIconPathCache == NULL)
+		return;
+	g_hash_table_remove_all (s_hIconPathCache);
+	g_free (s_cIconPathCacheStamp);
+	s_cIconPathCacheStamp = _make_icon_path_cache_stamp ();
+	s_bIconPathCacheDirty = TRUE;
+	if (s_iSidSaveIconPathCache == 0)
+		s_iSidSaveIconPathCache = g_timeout_add_seconds (CAIRO_DOCK_ICON_PATH_CACHE_SAVE_DELAY, _save_icon_path_cache_idle, NULL);
+}
+
+static gchar *_search_icon_s_path_in_theme (const gchar *cFileName, gint iDesiredIconSize);
+
 gchar *cairo_dock_search_icon_s_path (const gchar *cFileName, gint iDesiredIconSize)
 {
 	g_return_val_if_fail (cFileName != NULL, NULL);
@@ -236,9 +448,33 @@ gchar *cairo_dock_search_icon_s_path (const gchar *cFileName, gint iDesiredIconS
 		return g_strdup (cFileName);
 	}
 	
-	//\_______________________ check for the presence of suffix and version number.
 	g_return_val_if_fail (s_pIconTheme != NULL, NULL);
 	
+	//\_______________________ look into the cache first.
+	gchar *cKey = g_strdup_printf ("%d:%s", iDesiredIconSize, cFileName);
+	const gchar *cCachedPath = (s_hIconPathCache != NULL ? g_hash_table_lookup (s_hIconPathCache, cKey) : NULL);
+	if (cCachedPath != NULL)
+	{
+		g_free (cKey);
+		return g_strdup (cCachedPath);
+	}
+	
+	gchar *cIconPath = _search_icon_s_path_in_theme (cFileName, iDesiredIconSize);
+	if (s_hIconPathCache != NULL && cIconPath != NULL)  // the icons that don't exist are not remembered, they can be installed at any time.
+	{
+		g_hash_table_insert (s_hIconPathCache, cKey, g_strdup (cIconPath));
+		s_bIconPathCacheDirty = TRUE;
+		if (s_iSidSaveIconPathCache == 0)
+			s_iSidSaveIconPathCache = g_timeout_add_seconds (CAIRO_DOCK_ICON_PATH_CACHE_SAVE_DELAY, _save_icon_path_cache_idle, NULL);
+	}
+	else
+		g_free (cKey);
+	return cIconPath;
+}
+
+static gchar *_search_icon_s_path_in_theme (const gchar *cFileName, gint iDesiredIconSize)
+{
+	//\_______________________ check for the presence of suffix and version number.
 	GString *sIconPath = g_string_new ("");
 	const gchar *cSuffixTab[4] = {".svg", ".png", ".xpm", NULL};
 	gboolean bHasSuffix=FALSE, bFileFound=FALSE, bHasVersion=FALSE;
@@ -352,6 +588,7 @@ void cairo_dock_add_path_to_icon_theme (const gchar *cThemePath)
 	gtk_icon_theme_append_search_path (s_pIconTheme,
 		cThemePath);  /// TODO: does it check for unicity ?...
 	gtk_icon_theme_rescan_if_needed (s_pIconTheme);
+	_invalidate_icon_path_cache ();  // this new path may change which file is found for an icon
 	if (s_bUseDefaultTheme)
 	{
 		g_signal_handlers_unblock_matched (s_pIconTheme,
@@ -386,6 +623,7 @@ void cairo_dock_remove_path_from_icon_theme (const gchar *cThemePath)
 		}
 		paths[i-1] = NULL;
 		gtk_icon_theme_set_search_path (s_pIconTheme, (const gchar **)paths, iNbPaths - 1);
+		_invalidate_icon_path_cache ();
 	}
 	g_strfreev (paths);
 	
@@ -673,6 +911,7 @@ static gboolean _on_icon_theme_changed_idle (G_GNUC_UNUSED gpointer data)
 static void _on_icon_theme_changed (G_GNUC_UNUSED GtkIconTheme *pIconTheme, G_GNUC_UNUSED gpointer data)
 {
 	cd_message ("theme has changed");
+	_invalidate_icon_path_cache ();  // before anything is reloaded
 	// Reload the icons in idle, because this signal is triggered directly by 'gtk_icon_theme_set_search_path()'; so we may end reloading an applet in the middle of its work (ex.: Status-Notifier when the watcher terminates)
 	if (s_iSidReloadTheme == 0)
 		s_iSidReloadTheme = g_idle_add (_on_icon_theme_changed_idle, NULL);
@@ -695,6 +934,8 @@ static void _cairo_dock_load_icon_theme (void)
 		s_bUseLocalIcons = FALSE;
 		s_bUseDefaultTheme = FALSE;
 	}
+	
+	_load_icon_path_cache ();
 }
 
 static void load (void)
@@ -824,6 +1065,8 @@ static void reload (CairoIconsParam *pPrevIcons, CairoIconsParam *pIcons)
 	// labels
 	CairoIconsParam *pLabels = pIcons;
 	CairoIconsParam *pPrevLabels = pPrevIcons;
+	cairo_dock_reset_quickinfo_fonts ();
+	cairo_dock_reset_text_cache ();
 	gldi_icons_foreach ((GldiIconFunc) _reload_one_label, NULL);
 	
 	if (pPrevLabels->iLabelSize != pLabels->iLabelSize)
@@ -850,6 +1093,7 @@ static void _cairo_dock_unload_icon_textures (void)
 }
 static void _cairo_dock_unload_icon_theme (void)
 {
+	_unload_icon_path_cache ();
 	if (s_bUseDefaultTheme)
 		g_signal_handlers_disconnect_by_func (G_OBJECT(s_pIconTheme), G_CALLBACK(_on_icon_theme_changed), NULL);
 	else
@@ -860,6 +1104,11 @@ static void unload (void)
 {
 	_cairo_dock_unload_icon_textures ();
 	
+	cairo_dock_reset_quickinfo_fonts ();
+	cairo_dock_reset_text_cache ();
+	
+	cairo_dock_image_cache_flush ();
+	
 	cairo_dock_destroy_icon_fbo ();
 	
 	_cairo_dock_delete_floating_icons ();
@@ -896,6 +1145,8 @@ static gboolean on_style_changed (G_GNUC_UNUSED gpointer data)
 	if (myIconsParam.iconTextDescription.bUseDefaultColors || myIconsParam.iconTextDescription.cFont == NULL)  // reload labels and quick-info
 	{
 		cd_debug ("reload labels...");
+		cairo_dock_reset_quickinfo_fonts ();
+		cairo_dock_reset_text_cache ();
 		gldi_icons_foreach ((GldiIconFunc) _reload_one_label, NULL);
 	}
 	
@@ -939,18 +1190,15 @@ static void _load_image (Icon *icon)
 {
 	int iWidth = cairo_dock_icon_get_allocated_width (icon);
 	int iHeight = cairo_dock_icon_get_allocated_height (icon);
-	cairo_surface_t *pSurface = NULL;
+	gchar *cIconPath = NULL;
 	
 	if (icon->cFileName)
-	{
-		gchar *cIconPath = cairo_dock_search_icon_s_path (icon->cFileName, MAX (iWidth, iHeight));
-		if (cIconPath != NULL && *cIconPath != '\0')
-			pSurface = cairo_dock_create_surface_from_image_simple (cIconPath,
-				iWidth,
-				iHeight);
-		g_free (cIconPath);
-	}
-	cairo_dock_load_image_buffer_from_surface (&icon->image, pSurface, iWidth, iHeight);
+		cIconPath = cairo_dock_search_icon_s_path (icon->cFileName, MAX (iWidth, iHeight));
+	if (cIconPath != NULL && *cIconPath != '\0')
+		cairo_dock_load_icon_image_from_file (icon, cIconPath, iWidth, iHeight);  // the image is decoded in a thread
+	else
+		cairo_dock_load_image_buffer_from_surface (&icon->image, NULL, iWidth, iHeight);
+	g_free (cIconPath);
 }
 static void init_object (GldiObject *obj, G_GNUC_UNUSED gpointer attr)
 {
@@ -989,6 +1237,7 @@ static void reset_object (GldiObject *obj)
 		g_source_remove (icon->iSidRedrawSubdockContent);
 	if (icon->iSidLoadImage != 0)  // remove timers after any function that could trigger one (for instance, cairo_dock_deinhibite_class calls cairo_dock_trigger_load_icon_buffers)
 		g_source_remove (icon->iSidLoadImage);
+	cairo_dock_cancel_icon_image_loading (icon);
 	if (icon->iSidDoubleClickDelay != 0)
 		g_source_remove (icon->iSidDoubleClickDelay);
 	
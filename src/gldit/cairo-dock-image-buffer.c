@@ -23,6 +23,7 @@
 #include "cairo-dock-icon-manager.h"  // myIconsParam.iIconWidth
 #include "cairo-dock-desklet-manager.h"  // CAIRO_DOCK_IS_DESKLET
 #include "cairo-dock-surface-factory.h"
+#include "cairo-dock-style-facility.h"  // GldiTextDescription
 #include "cairo-dock-log.h"
 #include "cairo-dock-draw.h"
 #include "cairo-dock-draw-opengl.h"
@@ -38,6 +39,53 @@ extern CairoDockGLConfig g_openglConfig;
 extern GldiContainer *g_pPrimaryContainer;
 extern gboolean g_bEasterEggs;
 
+typedef struct {
+	gchar *cKey;
+	CairoDockImageBuffer image;  // the ImageBuffer the image was loaded into, copied into each ImageBuffer that shares it.
+	gint iRefCount;
+	gboolean bText;  // TRUE for the image of a text, which is kept a while once it's not used any more.
+	guint iStamp;  // text cache stamp at the time the text was rendered.
+	GList *pUnusedLink;  // link in the list of unused texts, or NULL if it's used.
+} GldiSharedImage;
+
+static GHashTable *s_hSharedImages = NULL;  // key -> shared image
+static GHashTable *s_hSharedImagesBySurface = NULL;  // surface -> shared image, to find the shared image of an ImageBuffer.
+
+#define CD_TEXT_CACHE_SIZE 64  // number of unused texts kept in the cache.
+static GQueue s_pUnusedTexts = G_QUEUE_INIT;  // texts not used any more, the most recently released first.
+static guint s_iTextCacheStamp = 0;  // incremented each time the cache is reset, so that the texts rendered before can't be found any more.
+static guint s_iNbTextHits = 0;
+static guint s_iNbTextMisses = 0;
+
+static inline GldiSharedImage *_get_shared_image (const CairoDockImageBuffer *pImage)
+{
+	if (s_hSharedImagesBySurface == NULL || pImage->pSurface == NULL)
+		return NULL;
+	return g_hash_table_lookup (s_hSharedImagesBySurface, pImage->pSurface);
+}
+
+static void _remove_shared_image (GldiSharedImage *pSharedImage)
+{
+	g_hash_table_remove (s_hSharedImagesBySurface, pSharedImage->image.pSurface);
+	g_hash_table_remove (s_hSharedImages, pSharedImage->cKey);  // frees it
+}
+
+static void _unref_shared_image (GldiSharedImage *pSharedImage)
+{
+	pSharedImage->iRefCount --;
+	if (pSharedImage->iRefCount > 0)
+		return;
+	if (pSharedImage->bText && pSharedImage->iStamp == s_iTextCacheStamp)  // the same text is likely to come back soon (a value cycling, a window title), keep it a while.
+	{
+		g_queue_push_head (&s_pUnusedTexts, pSharedImage);
+		pSharedImage->pUnusedLink = s_pUnusedTexts.head;
+		if (s_pUnusedTexts.length > CD_TEXT_CACHE_SIZE)  // forget the least recently used one.
+			_remove_shared_image (g_queue_pop_tail (&s_pUnusedTexts));
+		return;
+	}
+	_remove_shared_image (pSharedImage);
+}
+
 
 gchar *cairo_dock_search_image_s_path (const gchar *cImageFile)
 {
@@ -191,13 +239,21 @@ CairoDockImageBuffer *cairo_dock_create_image_buffer (const gchar *cImageFile, i
 
 void cairo_dock_unload_image_buffer (CairoDockImageBuffer *pImage)
 {
-	if (pImage->pSurface != NULL)
+	GldiSharedImage *pSharedImage = _get_shared_image (pImage);
+	if (pSharedImage != NULL)  // the surface and texture belong to the shared image.
 	{
-		cairo_surface_destroy (pImage->pSurface);
+		_unref_shared_image (pSharedImage);
 	}
-	if (pImage->iTexture != 0)
+	else
 	{
-		_cairo_dock_delete_texture (pImage->iTexture);
+		if (pImage->pSurface != NULL)
+		{
+			cairo_surface_destroy (pImage->pSurface);
+		}
+		if (pImage->iTexture != 0)
+		{
+			_cairo_dock_delete_texture (pImage->iTexture);
+		}
 	}
 	memset (pImage, 0, sizeof (CairoDockImageBuffer));
 }
@@ -210,6 +266,247 @@ void cairo_dock_free_image_buffer (CairoDockImageBuffer *pImage)
 	g_free (pImage);
 }
 
+
+  /////////////////////
+ /// SHARED IMAGES ///
+/////////////////////
+
+static gchar *_make_shared_image_key (const gchar *cImageFile, int iWidth, int iHeight, CairoDockLoadImageModifier iLoadModifier)
+{
+	return g_strdup_printf ("%s\n%dx%d\n%d", cImageFile, iWidth, iHeight, iLoadModifier);
+}
+
+static void _free_shared_image (GldiSharedImage *pSharedImage)
+{
+	if (pSharedImage->image.pSurface != NULL)
+		cairo_surface_destroy (pSharedImage->image.pSurface);
+	if (pSharedImage->image.iTexture != 0)
+		_cairo_dock_delete_texture (pSharedImage->image.iTexture);
+	g_free (pSharedImage->cKey);
+	g_free (pSharedImage);
+}
+
+static void _load_image_buffer_from_shared_image (CairoDockImageBuffer *pImage, GldiSharedImage *pSharedImage)
+{
+	memcpy (pImage, &pSharedImage->image, sizeof (CairoDockImageBuffer));
+	if (pImage->iNbFrames != 0)
+		gettimeofday (&pImage->time, NULL);
+	if (pSharedImage->pUnusedLink != NULL)  // an unused text is used again.
+	{
+		g_queue_delete_link (&s_pUnusedTexts, pSharedImage->pUnusedLink);
+		pSharedImage->pUnusedLink = NULL;
+	}
+	pSharedImage->iRefCount ++;
+}
+
+static gboolean _load_image_buffer_from_key (CairoDockImageBuffer *pImage, const gchar *cKey)
+{
+	if (s_hSharedImages == NULL)
+		return FALSE;
+	GldiSharedImage *pSharedImage = g_hash_table_lookup (s_hSharedImages, cKey);
+	if (pSharedImage == NULL)
+		return FALSE;
+	_load_image_buffer_from_shared_image (pImage, pSharedImage);
+	return TRUE;
+}
+
+gboolean cairo_dock_load_image_buffer_from_shared_image (CairoDockImageBuffer *pImage, const gchar *cImageFile, int iWidth, int iHeight, CairoDockLoadImageModifier iLoadModifier)
+{
+	if (s_hSharedImages == NULL || cImageFile == NULL)
+		return FALSE;
+	gchar *cKey = _make_shared_image_key (cImageFile, iWidth, iHeight, iLoadModifier);
+	gboolean bShared = _load_image_buffer_from_key (pImage, cKey);
+	g_free (cKey);
+	return bShared;
+}
+
+static GldiSharedImage *_share_image_buffer (CairoDockImageBuffer *pImage, gchar *cKey)  // takes the key
+{
+	if (s_hSharedImages == NULL)
+	{
+		s_hSharedImages = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify)_free_shared_image);  // the key belongs to the shared image.
+		s_hSharedImagesBySurface = g_hash_table_new (g_direct_hash, g_direct_equal);
+	}
+	
+	GldiSharedImage *pSharedImage = g_hash_table_lookup (s_hSharedImages, cKey);
+	if (pSharedImage != NULL)  // the same image has been shared in the meantime (for instance it was being loaded for several icons at once), use it instead.
+	{
+		g_free (cKey);
+		cairo_dock_unload_image_buffer (pImage);
+		_load_image_buffer_from_shared_image (pImage, pSharedImage);
+		return pSharedImage;
+	}
+	
+	pSharedImage = g_new0 (GldiSharedImage, 1);
+	pSharedImage->cKey = cKey;
+	memcpy (&pSharedImage->image, pImage, sizeof (CairoDockImageBuffer));
+	pSharedImage->iRefCount = 1;
+	g_hash_table_insert (s_hSharedImages, cKey, pSharedImage);
+	g_hash_table_insert (s_hSharedImagesBySurface, pImage->pSurface, pSharedImage);
+	return pSharedImage;
+}
+
+void cairo_dock_share_image_buffer (CairoDockImageBuffer *pImage, const gchar *cImageFile, int iWidth, int iHeight, CairoDockLoadImageModifier iLoadModifier)
+{
+	if (pImage->pSurface == NULL || cImageFile == NULL || _get_shared_image (pImage) != NULL)
+		return;
+	_share_image_buffer (pImage, _make_shared_image_key (cImageFile, iWidth, iHeight, iLoadModifier));
+}
+
+void cairo_dock_load_shared_image_buffer (CairoDockImageBuffer *pImage, const gchar *cImageFile, int iWidth, int iHeight, CairoDockLoadImageModifier iLoadModifier)
+{
+	if (cImageFile == NULL)
+		return;
+	if (cairo_dock_load_image_buffer_from_shared_image (pImage, cImageFile, iWidth, iHeight, iLoadModifier))
+		return;
+	cairo_dock_load_image_buffer (pImage, cImageFile, iWidth, iHeight, iLoadModifier);
+	cairo_dock_share_image_buffer (pImage, cImageFile, iWidth, iHeight, iLoadModifier);
+}
+
+gboolean cairo_dock_ref_image_buffer (CairoDockImageBuffer *pImage, const CairoDockImageBuffer *pSharedImage)
+{
+	GldiSharedImage *pImageToShare = _get_shared_image (pSharedImage);
+	if (pImageToShare == NULL)
+		return FALSE;
+	_load_image_buffer_from_shared_image (pImage, pImageToShare);
+	return TRUE;
+}
+
+gint cairo_dock_image_buffer_get_ref_count (const CairoDockImageBuffer *pImage)
+{
+	GldiSharedImage *pSharedImage = _get_shared_image (pImage);
+	return (pSharedImage != NULL ? pSharedImage->iRefCount : 0);
+}
+
+void cairo_dock_image_buffer_make_private (CairoDockImageBuffer *pImage)
+{
+	GldiSharedImage *pSharedImage = _get_shared_image (pImage);
+	if (pSharedImage == NULL)
+		return;
+	
+	cairo_surface_t *pSurface = cairo_dock_duplicate_surface (pImage->pSurface,
+		pImage->iWidth, pImage->iHeight,
+		pImage->iWidth, pImage->iHeight);
+	GLuint iTexture = 0;
+	if (pImage->iTexture != 0)
+		iTexture = cairo_dock_create_texture_from_surface (pSurface);
+	
+	_unref_shared_image (pSharedImage);
+	pImage->pSurface = pSurface;
+	pImage->iTexture = iTexture;
+}
+
+void cairo_dock_get_shared_images_stats (CairoDockSharedImagesStats *pStats)
+{
+	memset (pStats, 0, sizeof (CairoDockSharedImagesStats));
+	if (s_hSharedImages == NULL)
+		return;
+	GldiSharedImage *pSharedImage;
+	gsize iSize;
+	GHashTableIter iter;
+	gpointer value;
+	g_hash_table_iter_init (&iter, s_hSharedImages);
+	while (g_hash_table_iter_next (&iter, NULL, &value))
+	{
+		pSharedImage = value;
+		iSize = (gsize) 4 * pSharedImage->image.iWidth * pSharedImage->image.iHeight;
+		if (pSharedImage->image.iTexture != 0)
+			iSize *= 2;  // the surface is kept along with the texture.
+		pStats->iNbImages ++;
+		pStats->iNbReferences += pSharedImage->iRefCount;
+		pStats->iMemoryUsed += iSize;
+		if (pSharedImage->iRefCount > 1)  // unused texts have no reference.
+			pStats->iMemorySaved += iSize * (pSharedImage->iRefCount - 1);
+	}
+}
+
+
+  ///////////////////
+ /// TEXT IMAGES ///
+///////////////////
+
+#define _print_color(c) (c).rgba.red, (c).rgba.green, (c).rgba.blue, (c).rgba.alpha
+static gchar *_make_text_key (const gchar *cText, GldiTextDescription *pTextDescription, double fMaxScale, int iMaxWidth)
+{
+	PangoFontDescription *pDesc = gldi_text_description_get_description (pTextDescription);
+	gchar *cFont = (pDesc ? pango_font_description_to_string (pDesc) : NULL);
+	gchar *cKey = g_strdup_printf ("text %u\n%s %d %d%d%d%d %d %.3f\n%.3f,%.3f,%.3f,%.3f %.3f,%.3f,%.3f,%.3f %.3f,%.3f,%.3f,%.3f\n%.3f %d\n%s",
+		s_iTextCacheStamp,
+		cFont ? cFont : "",
+		gldi_text_description_get_size (pTextDescription),
+		pTextDescription->bNoDecorations,
+		pTextDescription->bUseDefaultColors,
+		pTextDescription->bOutlined,
+		pTextDescription->bUseMarkup,
+		pTextDescription->iMargin,
+		pTextDescription->fMaxRelativeWidth,
+		_print_color (pTextDescription->fColorStart),
+		_print_color (pTextDescription->fBackgroundColor),
+		_print_color (pTextDescription->fLineColor),
+		fMaxScale,
+		iMaxWidth,
+		cText);
+	g_free (cFont);
+	return cKey;
+}
+
+void cairo_dock_load_image_buffer_from_text (CairoDockImageBuffer *pImage, const gchar *cText, GldiTextDescription *pTextDescription, double fMaxScale, int iMaxWidth)
+{
+	g_return_if_fail (cText != NULL && pTextDescription != NULL);
+	gchar *cKey = _make_text_key (cText, pTextDescription, fMaxScale, iMaxWidth);
+	if (_load_image_buffer_from_key (pImage, cKey))
+	{
+		s_iNbTextHits ++;
+		g_free (cKey);
+		return;
+	}
+	s_iNbTextMisses ++;
+	
+	int iWidth, iHeight;
+	cairo_surface_t *pSurface = cairo_dock_create_surface_from_text_full (cText,
+		pTextDescription,
+		fMaxScale,
+		iMaxWidth,
+		&iWidth, &iHeight);
+	cairo_dock_load_image_buffer_from_surface (pImage, pSurface, iWidth, iHeight);
+	if (pImage->pSurface == NULL)
+	{
+		g_free (cKey);
+		return;
+	}
+	GldiSharedImage *pSharedImage = _share_image_buffer (pImage, cKey);
+	pSharedImage->bText = TRUE;
+	pSharedImage->iStamp = s_iTextCacheStamp;
+}
+
+void cairo_dock_reset_text_cache (void)
+{
+	s_iTextCacheStamp ++;  // the texts in use are freed when they're released.
+	GldiSharedImage *pSharedImage;
+	while ((pSharedImage = g_queue_pop_head (&s_pUnusedTexts)) != NULL)
+		_remove_shared_image (pSharedImage);
+}
+
+void cairo_dock_get_text_cache_stats (CairoDockTextCacheStats *pStats)
+{
+	memset (pStats, 0, sizeof (CairoDockTextCacheStats));
+	pStats->iNbHits = s_iNbTextHits;
+	pStats->iNbMisses = s_iNbTextMisses;
+	pStats->iNbUnusedTexts = s_pUnusedTexts.length;
+	if (s_hSharedImages == NULL)
+		return;
+	GldiSharedImage *pSharedImage;
+	GHashTableIter iter;
+	gpointer value;
+	g_hash_table_iter_init (&iter, s_hSharedImages);
+	while (g_hash_table_iter_next (&iter, NULL, &value))
+	{
+		pSharedImage = value;
+		if (pSharedImage->bText)
+			pStats->iNbTexts ++;
+	}
+}
+
 void cairo_dock_image_buffer_next_frame (CairoDockImageBuffer *pImage)
 {
 	if (pImage->iNbFrames == 0)
@@ -480,8 +777,9 @@ void cairo_dock_destroy_icon_fbo (void)
 cairo_t *cairo_dock_begin_draw_image_buffer_cairo (CairoDockImageBuffer *pImage, gint iRenderingMode, cairo_t *pCairoContext)
 {
 	g_return_val_if_fail (pImage->pSurface != NULL, NULL);
+	cairo_dock_image_buffer_make_private (pImage);  // don't draw on the other ImageBuffers.
 	cairo_t *ctx = pCairoContext;
-	if (! ctx)
+	if (! ctx || cairo_get_target (ctx) != pImage->pSurface)  // the given context was made on the shared surface, so it would draw on the other ImageBuffers too.
 	{
 		ctx = cairo_create (pImage->pSurface);
 	}
@@ -502,6 +800,7 @@ void cairo_dock_end_draw_image_buffer_cairo (CairoDockImageBuffer *pImage)
 gboolean cairo_dock_begin_draw_image_buffer_opengl (CairoDockImageBuffer *pImage, GldiContainer *pContainer, gint iRenderingMode)
 {
 	int iWidth, iHeight;
+	cairo_dock_image_buffer_make_private (pImage);  // don't draw on the other ImageBuffers.
 	/// TODO: test without FBO and dock when iRenderingMode == 2
 	if (CAIRO_DOCK_IS_DESKLET (pContainer))
 	{
@@ -644,6 +943,7 @@ void cairo_dock_end_draw_image_buffer_opengl (CairoDockImageBuffer *pImage, Gldi
 
 void cairo_dock_image_buffer_update_texture (CairoDockImageBuffer *pImage)
 {
+	cairo_dock_image_buffer_make_private (pImage);
 	if (pImage->iTexture == 0)
 	{
 		pImage->iTexture = cairo_dock_create_texture_from_surface (pImage->pSurface);
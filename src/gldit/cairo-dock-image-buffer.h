@@ -37,6 +37,8 @@ G_BEGIN_DECLS
 * Use \ref cairo_dock_free_image_buffer to destroy it or \ref cairo_dock_unload_image_buffer to unload and reset it to 0.
 * 
 * Use \ref cairo_dock_apply_image_buffer_surface or \ref cairo_dock_apply_image_buffer_texture to display the image.
+* 
+* An image that is loaded several times at the same size (typically the icon of an application, displayed by its launcher and its windows) can be shared between several ImageBuffers with \ref cairo_dock_load_shared_image_buffer : they will then use the same surface and texture. A shared ImageBuffer must not be drawn on, unless \ref cairo_dock_image_buffer_make_private has been called on it before (the drawing functions of this class do it for you).
 */
 
 
@@ -54,6 +56,30 @@ struct _CairoDockImageBuffer {
 	struct timeval time;  // time the current frame has been set
 	} ;
 
+/// Memory used by the shared images.
+struct _CairoDockSharedImagesStats {
+	/// number of shared images.
+	gint iNbImages;
+	/// number of ImageBuffers using them.
+	gint iNbReferences;
+	/// memory used by the shared images (surfaces and textures), in bytes.
+	gsize iMemoryUsed;
+	/// memory that would be used in addition if the images were not shared, in bytes.
+	gsize iMemorySaved;
+	} ;
+
+/// Usage of the cache of texts.
+struct _CairoDockTextCacheStats {
+	/// number of texts in the cache.
+	gint iNbTexts;
+	/// number of texts that are not used any more, but kept in case they're needed again.
+	gint iNbUnusedTexts;
+	/// number of texts taken from the cache.
+	guint iNbHits;
+	/// number of texts that had to be rendered.
+	guint iNbMisses;
+	} ;
+
 /** Find the path of an image. '~' is handled, as well as the 'images' folder of the current theme. Use \ref cairo_dock_search_icon_s_path to search theme icons.
 *@param cImageFile a file name or path. If it's already a path, it will just be duplicated.
 *@return the path of the file, or NULL if it has not been found.
@@ -119,6 +145,87 @@ void cairo_dock_unload_image_buffer (CairoDockImageBuffer *pImage);
 void cairo_dock_free_image_buffer (CairoDockImageBuffer *pImage);
 
 
+  ///////////////////
+ // SHARED IMAGES //
+///////////////////
+
+/** Load an image into an ImageBuffer, sharing it with the other ImageBuffers that loaded the same image at the same size with the same modifiers. The image is loaded only if it's not already shared. Must be called from the main thread.
+*@param pImage an ImageBuffer.
+*@param cImageFile name of a file
+*@param iWidth width it should be loaded.
+*@param iHeight height it should be loaded.
+*@param iLoadModifier modifier
+*/
+void cairo_dock_load_shared_image_buffer (CairoDockImageBuffer *pImage, const gchar *cImageFile, int iWidth, int iHeight, CairoDockLoadImageModifier iLoadModifier);
+
+/** Load an image into an ImageBuffer from the shared images, if it has already been loaded at the same size with the same modifiers.
+*@param pImage an ImageBuffer.
+*@param cImageFile name of a file
+*@param iWidth width it should be loaded.
+*@param iHeight height it should be loaded.
+*@param iLoadModifier modifier
+*@return TRUE if the image was shared and has been loaded into the ImageBuffer.
+*/
+gboolean cairo_dock_load_image_buffer_from_shared_image (CairoDockImageBuffer *pImage, const gchar *cImageFile, int iWidth, int iHeight, CairoDockLoadImageModifier iLoadModifier);
+
+/** Share an ImageBuffer that has been loaded from an image, so that the next loadings of the same image at the same size can use it. If the image has been shared by another ImageBuffer in the meantime, the ImageBuffer is reloaded with it and its own surface and texture are freed.
+*@param pImage an ImageBuffer, that has just been loaded and not drawn on.
+*@param cImageFile name of the file it was loaded from
+*@param iWidth width it was loaded.
+*@param iHeight height it was loaded.
+*@param iLoadModifier modifier it was loaded with
+*/
+void cairo_dock_share_image_buffer (CairoDockImageBuffer *pImage, const gchar *cImageFile, int iWidth, int iHeight, CairoDockLoadImageModifier iLoadModifier);
+
+/** Load an ImageBuffer with the same image as another one, if this one is shared.
+*@param pImage an ImageBuffer.
+*@param pSharedImage another ImageBuffer.
+*@return TRUE if the image was shared and has been loaded into the ImageBuffer.
+*/
+gboolean cairo_dock_ref_image_buffer (CairoDockImageBuffer *pImage, const CairoDockImageBuffer *pSharedImage);
+
+/** Get the number of ImageBuffers sharing the image of an ImageBuffer.
+*@param pImage an ImageBuffer.
+*@return the number of references on its image, or 0 if the ImageBuffer is not shared.
+*/
+gint cairo_dock_image_buffer_get_ref_count (const CairoDockImageBuffer *pImage);
+
+#define cairo_dock_image_buffer_is_shared(pImage) (cairo_dock_image_buffer_get_ref_count (pImage) != 0)
+
+/** Give its own copy of the surface and texture to an ImageBuffer, so that it can be drawn on without modifying the other ImageBuffers. Does nothing if the ImageBuffer is not shared.
+*@param pImage an ImageBuffer.
+*/
+void cairo_dock_image_buffer_make_private (CairoDockImageBuffer *pImage);
+
+/** Get the memory used by the shared images, and the memory saved by sharing them.
+*@param pStats will be filled with the statistics.
+*/
+void cairo_dock_get_shared_images_stats (CairoDockSharedImagesStats *pStats);
+
+
+  /////////////////
+ // TEXT IMAGES //
+/////////////////
+
+/** Load a text into an ImageBuffer, like \ref cairo_dock_create_surface_from_text_full does. The rendered texts are shared like the shared images, and the last ones that are not used any more are kept in a cache, so that a text that was rendered a moment ago (a window title, a value that cycles) is not rendered again. Must be called from the main thread.
+*@param pImage an ImageBuffer.
+*@param cText the text
+*@param pTextDescription description of the text
+*@param fMaxScale maximum zoom of the text
+*@param iMaxWidth maximum width of the text, or 0 to not limit it
+*/
+void cairo_dock_load_image_buffer_from_text (CairoDockImageBuffer *pImage, const gchar *cText, GldiTextDescription *pTextDescription, double fMaxScale, int iMaxWidth);
+
+/** Forget the texts of the cache; call it when the style changes, since the texts that use the default colors depend on it. The texts still in use are freed when they're released.
+*/
+void cairo_dock_reset_text_cache (void);
+
+/** Get the usage of the cache of texts.
+*@param pStats will be filled with the statistics.
+*/
+void cairo_dock_get_text_cache_stats (CairoDockTextCacheStats *pStats);
+
+
 /** Draw an ImageBuffer with an offset on a Cairo context, at the size it was loaded.
 *@param pImage an ImageBuffer.
 *@param pCairoContext the current cairo context.
@@ -183,6 +290,12 @@ void cairo_dock_create_icon_fbo (void);
 */
 void cairo_dock_destroy_icon_fbo (void);
 
+/** Initiate a drawing session on an ImageBuffer with cairo. The ImageBuffer is made private first, so that the other ImageBuffers sharing its image are not drawn on.
+*@param pImage the ImageBuffer
+*@param iRenderingMode 0 to erase the current image, 1 to keep it
+*@param pCairoContext a context on the ImageBuffer's surface, or NULL
+*@return the context to draw with; if it's not pCairoContext (NULL, or made on the surface before it was made private), it must be destroyed by the caller.
+*/
 cairo_t *cairo_dock_begin_draw_image_buffer_cairo (CairoDockImageBuffer *pImage, gint iRenderingMode, cairo_t *pCairoContext);
 
 void cairo_dock_end_draw_image_buffer_cairo (CairoDockImageBuffer *pImage);
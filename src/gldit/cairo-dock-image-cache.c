@@ -0,0 +1,503 @@
+/**
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>  // close
+#include <fcntl.h>  // open
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <glib/gstdio.h>
+
+#include "cairo-dock-log.h"
+#include "cairo-dock-task.h"
+#include "cairo-dock-image-cache.h"
+
+#define GLDI_IMAGE_CACHE_FILE "rendered-images"
+#define GLDI_IMAGE_CACHE_MAGIC "CDIMGC01"  // change it when the format changes.
+#define GLDI_IMAGE_CACHE_MAX_SIZE (32 * 1024 * 1024)  // size of the file, beyond which the least recently used images are evicted.
+#define GLDI_IMAGE_CACHE_MAX_IMAGE_SIZE (1024 * 1024)  // don't cache big images (backgrounds, etc), they would evict all the icons.
+#define GLDI_IMAGE_CACHE_MAX_PENDING_SIZE (8 * 1024 * 1024)  // memory taken by the new images until they are written in the file; beyond, new images are not cached.
+#define GLDI_IMAGE_CACHE_SAVE_DELAY 5000  // ms
+
+// The file is made of a header, followed by an array of records, then the keys and the pixels, each image being aligned on 16 bytes.
+typedef struct {
+	gchar cMagic[8];
+	guint32 iNbRecords;
+	guint32 iPadding;
+} GldiImageCacheHeader;
+
+typedef struct {
+	guint64 iKeyOffset;
+	guint64 iDataOffset;
+	guint32 iKeyLength;
+	guint32 iLastUse;  // in seconds since the Epoch.
+	gint32 iWidth;
+	gint32 iHeight;
+	gdouble fImageWidth, fImageHeight;
+	gdouble fZoomX, fZoomY;
+} GldiImageCacheRecord;
+
+// a mapping of the cache file; it's unmapped once no entry points into it any more.
+typedef struct {
+	gpointer pFile;
+	gsize iSize;
+	gint iRefCount;
+} GldiImageCacheMapping;
+
+typedef struct {
+	const guchar *pData;  // either inside a mapping of the file, or owned by the entry until it's written in the file.
+	GldiImageCacheMapping *pMapping;  // NULL if the data are owned by the entry.
+	gint iWidth, iHeight;
+	gdouble fImageWidth, fImageHeight;
+	gdouble fZoomX, fZoomY;
+	guint32 iLastUse;
+} GldiImageCacheEntry;
+
+G_LOCK_DEFINE_STATIC (s_imageCache);
+static GHashTable *s_hImageCache = NULL;  // key -> entry; entries are only removed by the saving thread, so it can read them without the lock.
+static gboolean s_bSaveScheduled = FALSE;
+static GldiTask *s_pSaveTask = NULL;
+static gsize s_iPendingSize = 0;  // size of the data owned by the entries.
+static guint s_iNbHits = 0, s_iNbMisses = 0;
+
+static gchar *_get_cache_file (void)
+{
+	return g_strdup_printf ("%s/%s/%s", g_get_user_cache_dir (), CAIRO_DOCK_DATA_DIR, GLDI_IMAGE_CACHE_FILE);
+}
+
+static gchar *_make_key (const gchar *cImagePath, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier)
+{
+	struct stat buf;
+	if (stat (cImagePath, &buf) != 0)
+		return NULL;
+	return g_strdup_printf ("%s\n%ld\n%ld\n%dx%d\n%.3f\n%d",
+		cImagePath,
+		(long)buf.st_mtime,
+		(long)buf.st_size,
+		iWidthConstraint, iHeightConstraint,
+		fMaxScale,
+		iLoadingModifier);
+}
+
+static inline guint32 _get_current_time (void)
+{
+	return (guint32) (g_get_real_time () / G_USEC_PER_SEC);
+}
+
+static inline gsize _get_data_size (int iWidth, int iHeight)
+{
+	return (gsize) cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, iWidth) * iHeight;
+}
+
+static void _unref_mapping (GldiImageCacheMapping *pMapping)  // called with the lock held.
+{
+	pMapping->iRefCount --;
+	if (pMapping->iRefCount == 0)
+	{
+		munmap (pMapping->pFile, pMapping->iSize);
+		g_free (pMapping);
+	}
+}
+
+static void _release_entry_data (GldiImageCacheEntry *pEntry)  // called with the lock held.
+{
+	if (pEntry->pMapping != NULL)
+		_unref_mapping (pEntry->pMapping);
+	else
+	{
+		g_free ((guchar*)pEntry->pData);
+		s_iPendingSize -= _get_data_size (pEntry->iWidth, pEntry->iHeight);
+	}
+	pEntry->pData = NULL;
+	pEntry->pMapping = NULL;
+}
+
+static void _free_entry (GldiImageCacheEntry *pEntry)
+{
+	_release_entry_data (pEntry);
+	g_free (pEntry);
+}
+
+  ////////////
+ /// LOAD ///
+////////////
+
+// map the cache file and check its header; the mapping is returned with 1 reference.
+static GldiImageCacheMapping *_map_cache_file (void)
+{
+	gchar *cCacheFile = _get_cache_file ();
+	int fd = open (cCacheFile, O_RDONLY);
+	g_free (cCacheFile);
+	if (fd < 0)
+		return NULL;
+	struct stat buf;
+	if (fstat (fd, &buf) != 0 || buf.st_size < (off_t)sizeof (GldiImageCacheHeader))
+	{
+		close (fd);
+		return NULL;
+	}
+	gpointer pFile = mmap (NULL, buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);  // the mapping keeps the file alive.
+	if (pFile == MAP_FAILED)
+		return NULL;
+
+	gsize iFileSize = buf.st_size;
+	const GldiImageCacheHeader *pHeader = pFile;
+	if (memcmp (pHeader->cMagic, GLDI_IMAGE_CACHE_MAGIC, sizeof (pHeader->cMagic)) != 0
+	|| pHeader->iNbRecords > (iFileSize - sizeof (GldiImageCacheHeader)) / sizeof (GldiImageCacheRecord))
+	{
+		cd_debug ("the images cache is not valid, it will be rebuilt");
+		munmap (pFile, iFileSize);
+		return NULL;
+	}
+	GldiImageCacheMapping *pMapping = g_new0 (GldiImageCacheMapping, 1);
+	pMapping->pFile = pFile;
+	pMapping->iSize = iFileSize;
+	pMapping->iRefCount = 1;
+	return pMapping;
+}
+
+static inline gboolean _record_is_valid (const GldiImageCacheRecord *r, gsize iFileSize)
+{
+	return (r->iWidth > 0 && r->iHeight > 0
+	&& r->iKeyOffset <= iFileSize && r->iKeyLength <= iFileSize - r->iKeyOffset
+	&& r->iDataOffset <= iFileSize && _get_data_size (r->iWidth, r->iHeight) <= iFileSize - r->iDataOffset);
+}
+
+static void _load_cache_file (void)  // called with the lock held.
+{
+	s_hImageCache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)_free_entry);
+
+	GldiImageCacheMapping *pMapping = _map_cache_file ();
+	if (pMapping == NULL)
+		return;
+
+	const GldiImageCacheHeader *pHeader = pMapping->pFile;
+	const GldiImageCacheRecord *pRecords = (const GldiImageCacheRecord*) (pHeader + 1);
+	const GldiImageCacheRecord *r;
+	GldiImageCacheEntry *pEntry;
+	guint i;
+	for (i = 0; i < pHeader->iNbRecords; i ++)
+	{
+		r = &pRecords[i];
+		if (! _record_is_valid (r, pMapping->iSize))  // corrupted record
+			continue;
+		pEntry = g_new0 (GldiImageCacheEntry, 1);
+		pEntry->pData = (const guchar*)pMapping->pFile + r->iDataOffset;
+		pEntry->pMapping = pMapping;
+		pMapping->iRefCount ++;
+		pEntry->iWidth = r->iWidth;
+		pEntry->iHeight = r->iHeight;
+		pEntry->fImageWidth = r->fImageWidth;
+		pEntry->fImageHeight = r->fImageHeight;
+		pEntry->fZoomX = r->fZoomX;
+		pEntry->fZoomY = r->fZoomY;
+		pEntry->iLastUse = r->iLastUse;
+		g_hash_table_insert (s_hImageCache, g_strndup ((const gchar*)pMapping->pFile + r->iKeyOffset, r->iKeyLength), pEntry);
+	}
+	_unref_mapping (pMapping);
+	cd_debug ("%d rendered images in the cache", g_hash_table_size (s_hImageCache));
+}
+
+  ////////////
+ /// SAVE ///
+////////////
+
+typedef struct {
+	gchar *cKey;
+	GldiImageCacheEntry *pEntry;  // only to find it again in the table.
+	GldiImageCacheEntry entry;  // copy of the entry, taken with the lock held, since a lookup can update it at any time.
+} GldiImageCacheItem;
+
+static int _compare_items (const GldiImageCacheItem *a, const GldiImageCacheItem *b)
+{
+	return (a->entry.iLastUse > b->entry.iLastUse ? -1 : a->entry.iLastUse < b->entry.iLastUse ? 1 : 0);  // most recently used first
+}
+
+static void _save_cache_file (G_GNUC_UNUSED gpointer data)  // thread
+{
+	//\______________ take a snapshot of the entries; since only this thread removes them or changes their data, the pixels stay valid after we release the lock.
+	G_LOCK (s_imageCache);
+	s_bSaveScheduled = FALSE;
+	guint n = g_hash_table_size (s_hImageCache);
+	GldiImageCacheItem *pItems = g_new (GldiImageCacheItem, n);
+	GHashTableIter iter;
+	gpointer key, value;
+	guint i = 0;
+	g_hash_table_iter_init (&iter, s_hImageCache);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		pItems[i].cKey = g_strdup (key);
+		pItems[i].pEntry = value;
+		memcpy (&pItems[i].entry, value, sizeof (GldiImageCacheEntry));
+		i ++;
+	}
+	cd_debug ("images cache: %d hits, %d misses", s_iNbHits, s_iNbMisses);
+	G_UNLOCK (s_imageCache);
+
+	//\______________ keep the most recently used images that fit in the file.
+	qsort (pItems, n, sizeof (GldiImageCacheItem), (GCompareFunc)_compare_items);
+	GldiImageCacheRecord *pRecords = g_new0 (GldiImageCacheRecord, n);
+	guint64 iOffset = sizeof (GldiImageCacheHeader);
+	guint64 iKeysSize = 0, iDataSize = 0;
+	guint iNbRecords = 0;
+	gsize iKeyLength, iImageSize;
+	for (i = 0; i < n; i ++)
+	{
+		iKeyLength = strlen (pItems[i].cKey);
+		iImageSize = _get_data_size (pItems[i].entry.iWidth, pItems[i].entry.iHeight);
+		if (iOffset + (iNbRecords + 1) * sizeof (GldiImageCacheRecord) + iKeysSize + iKeyLength + iDataSize + iImageSize + 16 > GLDI_IMAGE_CACHE_MAX_SIZE)
+			break;  // the next ones are even older.
+		pRecords[iNbRecords].iKeyLength = iKeyLength;
+		pRecords[iNbRecords].iKeyOffset = iKeysSize;  // relative for now
+		pRecords[iNbRecords].iDataOffset = iDataSize;
+		iKeysSize += iKeyLength;
+		iDataSize += (iImageSize + 15) & ~15;
+		iNbRecords ++;
+	}
+
+	guint64 iKeysOffset = iOffset + iNbRecords * sizeof (GldiImageCacheRecord);
+	guint64 iDataOffset = (iKeysOffset + iKeysSize + 15) & ~15;
+	GldiImageCacheEntry *pEntry;
+	for (i = 0; i < iNbRecords; i ++)
+	{
+		pEntry = &pItems[i].entry;
+		pRecords[i].iKeyOffset += iKeysOffset;
+		pRecords[i].iDataOffset += iDataOffset;
+		pRecords[i].iLastUse = pEntry->iLastUse;
+		pRecords[i].iWidth = pEntry->iWidth;
+		pRecords[i].iHeight = pEntry->iHeight;
+		pRecords[i].fImageWidth = pEntry->fImageWidth;
+		pRecords[i].fImageHeight = pEntry->fImageHeight;
+		pRecords[i].fZoomX = pEntry->fZoomX;
+		pRecords[i].fZoomY = pEntry->fZoomY;
+	}
+
+	//\______________ write a new file and replace the current one; the current mapping stays valid.
+	gchar *cCacheFile = _get_cache_file ();
+	gchar *cCacheDir = g_path_get_dirname (cCacheFile);
+	g_mkdir_with_parents (cCacheDir, 7*8*8+5*8+5);
+	gchar *cTmpFile = g_strdup_printf ("%s.tmp", cCacheFile);
+	FILE *f = fopen (cTmpFile, "wb");
+	gboolean bSuccess = (f != NULL);
+	if (f != NULL)
+	{
+		GldiImageCacheHeader header;
+		memset (&header, 0, sizeof (header));
+		memcpy (header.cMagic, GLDI_IMAGE_CACHE_MAGIC, sizeof (header.cMagic));
+		header.iNbRecords = iNbRecords;
+		static const guchar zeros[16] = {0};
+		bSuccess = (fwrite (&header, sizeof (header), 1, f) == 1);
+		if (bSuccess && iNbRecords != 0)
+			bSuccess = (fwrite (pRecords, sizeof (GldiImageCacheRecord), iNbRecords, f) == iNbRecords);
+		for (i = 0; bSuccess && i < iNbRecords; i ++)
+			bSuccess = (fwrite (pItems[i].cKey, 1, pRecords[i].iKeyLength, f) == pRecords[i].iKeyLength);
+		if (bSuccess && iDataOffset > iKeysOffset + iKeysSize)
+			bSuccess = (fwrite (zeros, 1, iDataOffset - iKeysOffset - iKeysSize, f) == iDataOffset - iKeysOffset - iKeysSize);
+		for (i = 0; bSuccess && i < iNbRecords; i ++)
+		{
+			iImageSize = _get_data_size (pRecords[i].iWidth, pRecords[i].iHeight);
+			bSuccess = (fwrite (pItems[i].entry.pData, 1, iImageSize, f) == iImageSize);
+			if (bSuccess && (iImageSize & 15))
+				bSuccess = (fwrite (zeros, 1, 16 - (iImageSize & 15), f) == 16 - (iImageSize & 15));
+		}
+		if (fclose (f) != 0)
+			bSuccess = FALSE;
+	}
+	if (bSuccess)
+		bSuccess = (g_rename (cTmpFile, cCacheFile) == 0);
+	if (! bSuccess)
+	{
+		cd_warning ("couldn't save the images cache into %s", cCacheFile);
+		g_remove (cTmpFile);
+	}
+	else  // serve the images from the new file, and forget the ones that didn't fit in it (the least recently used).
+	{
+		G_LOCK (s_imageCache);
+		GldiImageCacheMapping *pMapping = _map_cache_file ();
+		if (pMapping != NULL && ((GldiImageCacheHeader*)pMapping->pFile)->iNbRecords == iNbRecords
+		&& memcmp ((GldiImageCacheHeader*)pMapping->pFile + 1, pRecords, iNbRecords * sizeof (GldiImageCacheRecord)) == 0)  // it's still our file.
+		{
+			for (i = 0; i < iNbRecords; i ++)
+			{
+				pEntry = g_hash_table_lookup (s_hImageCache, pItems[i].cKey);
+				if (pEntry != pItems[i].pEntry || pEntry->pData != pItems[i].entry.pData)  // not the entry we wrote.
+					continue;
+				_release_entry_data (pEntry);
+				pEntry->pData = (const guchar*)pMapping->pFile + pRecords[i].iDataOffset;
+				pEntry->pMapping = pMapping;
+				pMapping->iRefCount ++;
+			}
+			for (i = iNbRecords; i < n; i ++)
+			{
+				if (g_hash_table_lookup (s_hImageCache, pItems[i].cKey) == pItems[i].pEntry)
+					g_hash_table_remove (s_hImageCache, pItems[i].cKey);
+			}
+		}
+		if (pMapping != NULL)
+			_unref_mapping (pMapping);
+		G_UNLOCK (s_imageCache);
+	}
+
+	g_free (cTmpFile);
+	g_free (cCacheDir);
+	g_free (cCacheFile);
+	g_free (pRecords);
+	for (i = 0; i < n; i ++)
+		g_free (pItems[i].cKey);
+	g_free (pItems);
+}
+
+static gboolean _on_cache_saved (G_GNUC_UNUSED gpointer data)
+{
+	G_LOCK (s_imageCache);
+	gboolean bSaveAgain = s_bSaveScheduled;  // some images have been added while we were saving.
+	G_UNLOCK (s_imageCache);
+	if (bSaveAgain)
+		gldi_task_launch_delayed (s_pSaveTask, GLDI_IMAGE_CACHE_SAVE_DELAY);
+	return FALSE;
+}
+
+static gboolean _schedule_save_idle (G_GNUC_UNUSED gpointer data)
+{
+	if (s_pSaveTask == NULL)
+		s_pSaveTask = gldi_task_new (0, (GldiGetDataAsyncFunc) _save_cache_file, (GldiUpdateSyncFunc) _on_cache_saved, NULL);
+	if (! gldi_task_is_running (s_pSaveTask))  // else it will be relaunched once it's done.
+		gldi_task_launch_delayed (s_pSaveTask, GLDI_IMAGE_CACHE_SAVE_DELAY);
+	return FALSE;
+}
+
+  //////////////
+ /// LOOKUP ///
+//////////////
+
+cairo_surface_t *cairo_dock_image_cache_lookup (const gchar *cImagePath, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY)
+{
+	gchar *cKey = _make_key (cImagePath, fMaxScale, iWidthConstraint, iHeightConstraint, iLoadingModifier);
+	if (cKey == NULL)
+		return NULL;
+
+	cairo_surface_t *pSurface = NULL;
+	G_LOCK (s_imageCache);
+	if (s_hImageCache == NULL)
+		_load_cache_file ();
+	GldiImageCacheEntry *pEntry = g_hash_table_lookup (s_hImageCache, cKey);
+	if (pEntry != NULL)
+	{
+		pSurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, pEntry->iWidth, pEntry->iHeight);
+		if (cairo_surface_status (pSurface) == CAIRO_STATUS_SUCCESS)
+		{
+			cairo_surface_flush (pSurface);
+			memcpy (cairo_image_surface_get_data (pSurface), pEntry->pData, _get_data_size (pEntry->iWidth, pEntry->iHeight));
+			cairo_surface_mark_dirty (pSurface);
+			*fImageWidth = pEntry->fImageWidth;
+			*fImageHeight = pEntry->fImageHeight;
+			if (fZoomX != NULL)
+				*fZoomX = pEntry->fZoomX;
+			if (fZoomY != NULL)
+				*fZoomY = pEntry->fZoomY;
+			pEntry->iLastUse = _get_current_time ();
+			s_iNbHits ++;
+		}
+		else
+		{
+			cairo_surface_destroy (pSurface);
+			pSurface = NULL;
+		}
+	}
+	else
+		s_iNbMisses ++;
+	G_UNLOCK (s_imageCache);
+
+	g_free (cKey);
+	return pSurface;
+}
+
+void cairo_dock_image_cache_store (const gchar *cImagePath, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, cairo_surface_t *pSurface, double fImageWidth, double fImageHeight, double fZoomX, double fZoomY)
+{
+	if (pSurface == NULL || cairo_surface_get_type (pSurface) != CAIRO_SURFACE_TYPE_IMAGE
+	|| cairo_image_surface_get_format (pSurface) != CAIRO_FORMAT_ARGB32)
+		return;
+	int iWidth = cairo_image_surface_get_width (pSurface);
+	int iHeight = cairo_image_surface_get_height (pSurface);
+	gsize iSize = _get_data_size (iWidth, iHeight);
+	if (iWidth <= 0 || iHeight <= 0 || iSize > GLDI_IMAGE_CACHE_MAX_IMAGE_SIZE
+	|| cairo_image_surface_get_stride (pSurface) != cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, iWidth))
+		return;
+	gchar *cKey = _make_key (cImagePath, fMaxScale, iWidthConstraint, iHeightConstraint, iLoadingModifier);
+	if (cKey == NULL)
+		return;
+
+	GldiImageCacheEntry *pEntry = g_new0 (GldiImageCacheEntry, 1);
+	cairo_surface_flush (pSurface);
+	pEntry->pData = g_memdup (cairo_image_surface_get_data (pSurface), iSize);
+	pEntry->iWidth = iWidth;
+	pEntry->iHeight = iHeight;
+	pEntry->fImageWidth = fImageWidth;
+	pEntry->fImageHeight = fImageHeight;
+	pEntry->fZoomX = fZoomX;
+	pEntry->fZoomY = fZoomY;
+	pEntry->iLastUse = _get_current_time ();
+
+	G_LOCK (s_imageCache);
+	if (s_hImageCache == NULL)
+		_load_cache_file ();
+	if (g_hash_table_lookup (s_hImageCache, cKey) == NULL  // another thread may have rendered the same image in the meantime; the saving thread may be reading the first one, so keep it.
+	&& s_iPendingSize + iSize <= GLDI_IMAGE_CACHE_MAX_PENDING_SIZE)  // else wait for the next save to release some memory.
+	{
+		s_iPendingSize += iSize;
+		g_hash_table_insert (s_hImageCache, cKey, pEntry);
+		cKey = NULL;
+		pEntry = NULL;
+		if (! s_bSaveScheduled)
+		{
+			s_bSaveScheduled = TRUE;
+			g_idle_add (_schedule_save_idle, NULL);  // the Task must be launched from the main thread.
+		}
+	}
+	G_UNLOCK (s_imageCache);
+
+	if (pEntry != NULL)
+	{
+		g_free ((guchar*)pEntry->pData);  // not counted in the pending size.
+		g_free (pEntry);
+	}
+	g_free (cKey);
+}
+
+  /////////////
+ /// FLUSH ///
+/////////////
+
+void cairo_dock_image_cache_flush (void)
+{
+	if (s_pSaveTask != NULL)
+		gldi_task_stop (s_pSaveTask);  // wait for the current save, and cancel the next one.
+	G_LOCK (s_imageCache);
+	gboolean bPending = (s_hImageCache != NULL && s_iPendingSize != 0);
+	G_UNLOCK (s_imageCache);
+	if (bPending)  // some new images have not been written yet, do it now or they'll be lost.
+	{
+		cd_debug ("writing the images cache before leaving");
+		_save_cache_file (NULL);
+	}
+}
@@ -0,0 +1,72 @@
+/*
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __CAIRO_DOCK_IMAGE_CACHE__
+#define  __CAIRO_DOCK_IMAGE_CACHE__
+
+#include <glib.h>
+#include <cairo.h>
+
+#include "cairo-dock-struct.h"
+#include "cairo-dock-surface-factory.h"  // CairoDockLoadImageModifier
+G_BEGIN_DECLS
+
+/**
+*@file cairo-dock-image-cache.h This class keeps the images rendered by \ref cairo_dock_create_surface_from_image on the disk, so that they don't have to be rendered again on the next startup.
+*
+* The rendered images (premultiplied ARGB) are stored in a single file in the user's cache folder, which is mapped in memory the first time the cache is used. An image is identified by its path, its modification time, and the parameters it was rendered with, so a modified image is never taken from the cache.
+* When the file grows too big, the images that have not been used for the longest time are evicted, from the file and from the memory.
+* A new image is kept in memory until the file is written, then it's read from the file; if too many new images are waiting to be written, the next ones are not cached.
+* All the functions can be called from any thread.
+*/
+
+/** Get an image from the cache.
+*@param cImagePath complete path to the image.
+*@param fMaxScale maximum zoom of the icon.
+*@param iWidthConstraint constraint on the width, or 0 to not constraint it.
+*@param iHeightConstraint constraint on the height, or 0 to not constraint it.
+*@param iLoadingModifier a mask of different loading modifiers.
+*@param fImageWidth will be filled with the width of the image (hors zoom).
+*@param fImageHeight will be filled with the height of the image (hors zoom).
+*@param fZoomX if non NULL, will be filled with the zoom that has been applied on width.
+*@param fZoomY if non NULL, will be filled with the zoom that has been applied on height.
+*@return a newly allocated image surface, or NULL if the image is not in the cache.
+*/
+cairo_surface_t *cairo_dock_image_cache_lookup (const gchar *cImagePath, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY);
+
+/** Store a rendered image into the cache. Only image surfaces can be stored; the cache is written on the disk a few seconds later, in a thread.
+*@param cImagePath complete path to the image.
+*@param fMaxScale maximum zoom of the icon.
+*@param iWidthConstraint constraint on the width.
+*@param iHeightConstraint constraint on the height.
+*@param iLoadingModifier a mask of different loading modifiers.
+*@param pSurface the rendered image.
+*@param fImageWidth width of the image (hors zoom).
+*@param fImageHeight height of the image (hors zoom).
+*@param fZoomX zoom that has been applied on width.
+*@param fZoomY zoom that has been applied on height.
+*/
+void cairo_dock_image_cache_store (const gchar *cImagePath, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, cairo_surface_t *pSurface, double fImageWidth, double fImageHeight, double fZoomX, double fZoomY);
+
+/** Write the images that are not yet in the cache file, without waiting for the next save. It's done when the icons manager is unloaded, so that the images rendered just before leaving are not lost.
+*/
+void cairo_dock_image_cache_flush (void);
+
+G_END_DECLS
+#endif
@@ -17,6 +17,14 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#define _GNU_SOURCE  // dladdr, Dl_info
+#include <string.h>  // memmove
+#include <stdlib.h>  // qsort
+
+#include "gldi-config.h"
+#ifdef HAVE_DLADDR
+#include <dlfcn.h>  // dladdr
+#endif
 #include "cairo-dock-struct.h"
 #include "cairo-dock-manager.h"
 #include "cairo-dock-log.h"
@@ -28,7 +36,6 @@
  * GLDI_OBJECT_IS_xxx obj->mgr == pMgr || mgr->parent->mrg == pMgr || ...
  * */
 
-
 void gldi_object_set_manager (GldiObject *pObject, GldiObjectManager *pMgr)
 {
 	pObject->mgr = pMgr;
@@ -86,16 +93,16 @@ void gldi_object_unref (GldiObject *pObject)
 			pMgr = pMgr->object.mgr;
 		}
 		
-		// clear notifications
-		GPtrArray *pNotificationsTab = pObject->pNotificationsTab;
+		// clear notifications; the broadcasts in progress on the object hold a ref on the tab, they will free it when they're done.
+		GArray *pNotificationsTab = pObject->pNotificationsTab;
 		guint i;
 		for (i = 0; i < pNotificationsTab->len; i ++)
 		{
-			GSList *pNotificationRecordList = g_ptr_array_index (pNotificationsTab, i);
-			g_slist_foreach (pNotificationRecordList, (GFunc)g_free, NULL);
-			g_slist_free (pNotificationRecordList);
+			GldiNotificationList *pList = &g_array_index (pNotificationsTab, GldiNotificationList, i);
+			pList->iNbRecords = 0;  // no more callback will be called
+			pList->bDestroyed = TRUE;
 		}
-		g_ptr_array_free (pNotificationsTab, TRUE);
+		g_array_unref (pNotificationsTab);
 		
 		// free memory
 		g_free (pObject);
@@ -150,24 +157,62 @@ gboolean gldi_object_is_manager_child (GldiObject *pObject, GldiObjectManager *p
 }
 
 
+void gldi_object_compact_notification_list (GldiNotificationList *pList)
+{
+	guint i, n = 0;
+	for (i = 0; i < pList->iNbRecords; i ++)
+	{
+		if (pList->pRecords[i].pFunction != NULL)
+			pList->pRecords[n++] = pList->pRecords[i];
+	}
+	pList->iNbRecords = n;
+	pList->bHasHoles = FALSE;
+}
+
+void gldi_object_clear_notification_list (GldiNotificationList *pList)
+{
+	g_free (pList->pRecords);
+}
+
+static void _insert_record (GldiNotificationList *pList, GldiNotificationFunc pFunction, gboolean bRunFirst, gpointer pUserData)
+{
+	if (pList->bHasHoles && pList->iDepth == 0)
+		gldi_object_compact_notification_list (pList);
+	if (pList->iNbRecords == pList->iSize)
+	{
+		pList->iSize = MAX (4, 2 * pList->iSize);
+		pList->pRecords = g_renew (GldiNotificationRecord, pList->pRecords, pList->iSize);
+	}
+	GldiNotificationRecord *pNotificationRecord;
+	if (bRunFirst)
+	{
+		memmove (pList->pRecords + 1, pList->pRecords, pList->iNbRecords * sizeof (GldiNotificationRecord));
+		pNotificationRecord = &pList->pRecords[0];
+		pList->iNbRunFirst ++;  // tells the broadcasts walking the list that the records have been shifted.
+	}
+	else
+	{
+		pNotificationRecord = &pList->pRecords[pList->iNbRecords];
+	}
+	pNotificationRecord->pFunction = pFunction;
+	pNotificationRecord->pUserData = pUserData;
+	pList->iNbRecords ++;
+}
+
 void gldi_object_register_notification (gpointer pObject, GldiNotificationType iNotifType, GldiNotificationFunc pFunction, gboolean bRunFirst, gpointer pUserData)
 {
 	g_return_if_fail (pObject != NULL);
 	// grab the notifications tab
-	GPtrArray *pNotificationsTab = GLDI_OBJECT(pObject)->pNotificationsTab;
-	if (!pNotificationsTab || pNotificationsTab->len < iNotifType)
+	GArray *pNotificationsTab = GLDI_OBJECT(pObject)->pNotificationsTab;
+	if (!pNotificationsTab || pNotificationsTab->len <= iNotifType)
 	{
 		cd_warning ("someone tried to register to an inexisting notification (%d) on an object of type '%s'", iNotifType, gldi_object_get_type(pObject));
 		return ;  // don't try to create/resize the notifications tab, since noone will emit this notification.
 	}
 	
-	// add a record
-	GldiNotificationRecord *pNotificationRecord = g_new (GldiNotificationRecord, 1);
-	pNotificationRecord->pFunction = pFunction;
-	pNotificationRecord->pUserData = pUserData;
-	
-	GSList *pNotificationRecordList = g_ptr_array_index (pNotificationsTab, iNotifType);
-	pNotificationsTab->pdata[iNotifType] = (bRunFirst ? g_slist_prepend : g_slist_append) (pNotificationRecordList, pNotificationRecord);
+	// add a record, even if the notification is being broadcasted: the broadcast walks the records by index and re-reads the array after each callback.
+	GldiNotificationList *pList = &g_array_index (pNotificationsTab, GldiNotificationList, iNotifType);
+	_insert_record (pList, pFunction, bRunFirst, pUserData);
 }
 
 
@@ -175,20 +220,239 @@ void gldi_object_remove_notification (gpointer pObject, GldiNotificationType iNo
 {
 	g_return_if_fail (pObject != NULL);
 	// grab the notifications tab
-	GPtrArray *pNotificationsTab = GLDI_OBJECT(pObject)->pNotificationsTab;
+	GArray *pNotificationsTab = GLDI_OBJECT(pObject)->pNotificationsTab;
+	g_return_if_fail (pNotificationsTab != NULL && iNotifType < pNotificationsTab->len);
 	
 	// remove the record
-	GSList *pNotificationRecordList = g_ptr_array_index (pNotificationsTab, iNotifType);
+	GldiNotificationList *pList = &g_array_index (pNotificationsTab, GldiNotificationList, iNotifType);
 	GldiNotificationRecord *pNotificationRecord;
-	GSList *nr;
-	for (nr = pNotificationRecordList; nr != NULL; nr = nr->next)
+	guint i;
+	for (i = 0; i < pList->iNbRecords; i ++)
 	{
-		pNotificationRecord = nr->data;
+		pNotificationRecord = &pList->pRecords[i];
 		if (pNotificationRecord->pFunction == pFunction && pNotificationRecord->pUserData == pUserData)
 		{
-			pNotificationsTab->pdata[iNotifType] = g_slist_delete_link (pNotificationRecordList, nr);
-			g_free (pNotificationRecord);
+			if (pList->iDepth != 0)  // the notification is being broadcasted, just leave a hole, it will be compacted at the end of the broadcast.
+			{
+				pNotificationRecord->pFunction = NULL;
+				pList->bHasHoles = TRUE;
+			}
+			else
+			{
+				pList->iNbRecords --;
+				memmove (pNotificationRecord, pNotificationRecord + 1, (pList->iNbRecords - i) * sizeof (GldiNotificationRecord));
+			}
 			break;
 		}
 	}
 }
+
+
+  ////////////////
+ /// PROFILER ///
+////////////////
+
+#define GLDI_PROFILER_NB_ENTRIES 1024  // max number of (manager, notification, callback); there are usually a few hundreds.
+#define GLDI_PROFILER_HISTORY_SIZE 512  // number of calls kept in the ring buffer
+
+typedef struct {
+	const gchar *cManagerName;  // NULL <=> empty entry
+	GldiNotificationType iNotifType;
+	GldiNotificationFunc pFunction;
+	guint iNbCalls;
+	gint64 iTotalTime;
+	gint64 iMaxTime;
+	} GldiProfilerEntry;
+
+typedef struct {
+	gint64 iTime;
+	GldiProfilerEntry *pEntry;
+	gint64 iDuration;
+	} GldiProfilerSample;
+
+gboolean g_bNotificationProfiling = FALSE;
+// everything is pre-allocated, so that recording a call never allocates memory.
+static GldiProfilerEntry *s_pProfilerEntries = NULL;  // open-addressing hash table
+static GldiProfilerSample *s_pProfilerHistory = NULL;  // ring buffer
+static guint s_iHistoryIndex = 0;  // next sample to be written
+static guint s_iNbSamples = 0;
+
+void gldi_object_set_notification_profiling (gboolean bEnable)
+{
+	if (bEnable && s_pProfilerEntries == NULL)
+	{
+		s_pProfilerEntries = g_new0 (GldiProfilerEntry, GLDI_PROFILER_NB_ENTRIES);
+		s_pProfilerHistory = g_new0 (GldiProfilerSample, GLDI_PROFILER_HISTORY_SIZE);
+	}
+	g_bNotificationProfiling = bEnable;
+}
+
+void gldi_object_reset_notification_profile (void)
+{
+	if (s_pProfilerEntries == NULL)
+		return;
+	memset (s_pProfilerEntries, 0, GLDI_PROFILER_NB_ENTRIES * sizeof (GldiProfilerEntry));
+	memset (s_pProfilerHistory, 0, GLDI_PROFILER_HISTORY_SIZE * sizeof (GldiProfilerSample));
+	s_iHistoryIndex = 0;
+	s_iNbSamples = 0;
+}
+
+void gldi_object_profile_notification (const gchar *cManagerName, GldiNotificationType iNotifType, GldiNotificationFunc pFunction, gint64 iDuration)
+{
+	if (s_pProfilerEntries == NULL)  // not enabled through 'gldi_object_set_notification_profiling'
+		return;
+	// find the entry (linear probing)
+	guint h = (GPOINTER_TO_UINT (pFunction) >> 4) ^ (GPOINTER_TO_UINT (cManagerName) >> 3) ^ (iNotifType * 2654435761u);
+	guint i, n;
+	GldiProfilerEntry *pEntry = NULL;
+	for (n = 0; n < GLDI_PROFILER_NB_ENTRIES; n ++)
+	{
+		i = (h + n) % GLDI_PROFILER_NB_ENTRIES;
+		pEntry = &s_pProfilerEntries[i];
+		if (pEntry->cManagerName == NULL)  // new entry
+		{
+			pEntry->cManagerName = cManagerName;
+			pEntry->iNotifType = iNotifType;
+			pEntry->pFunction = pFunction;
+			break;
+		}
+		if (pEntry->pFunction == pFunction && pEntry->iNotifType == iNotifType && pEntry->cManagerName == cManagerName)
+			break;
+	}
+	if (n == GLDI_PROFILER_NB_ENTRIES)  // table is full, drop the call.
+		return;
+	
+	// update the stats
+	pEntry->iNbCalls ++;
+	pEntry->iTotalTime += iDuration;
+	if (iDuration > pEntry->iMaxTime)
+		pEntry->iMaxTime = iDuration;
+	
+	// and record the call in the history
+	GldiProfilerSample *pSample = &s_pProfilerHistory[s_iHistoryIndex];
+	pSample->iTime = g_get_monotonic_time ();
+	pSample->pEntry = pEntry;
+	pSample->iDuration = iDuration;
+	s_iHistoryIndex = (s_iHistoryIndex + 1) % GLDI_PROFILER_HISTORY_SIZE;
+	if (s_iNbSamples < GLDI_PROFILER_HISTORY_SIZE)
+		s_iNbSamples ++;
+}
+
+static void _append_function_name (GString *sDump, GldiNotificationFunc pFunction)
+{
+	#ifdef HAVE_DLADDR
+	Dl_info info;
+	if (dladdr ((gpointer)pFunction, &info) != 0)
+	{
+		if (info.dli_sname != NULL)
+		{
+			g_string_append (sDump, info.dli_sname);
+		}
+		else  // static functions have no symbol, in this case we give the library and the offset.
+		{
+			gchar *cLibName = g_path_get_basename (info.dli_fname);
+			g_string_append_printf (sDump, "%s+%p", cLibName, (gpointer)((gchar*)pFunction - (gchar*)info.dli_fbase));
+			g_free (cLibName);
+		}
+		return;
+	}
+	#endif
+	g_string_append_printf (sDump, "%p", (gpointer)pFunction);
+}
+
+static int _compare_entries (const GldiProfilerEntry *e1, const GldiProfilerEntry *e2)
+{
+	return (e1->iTotalTime < e2->iTotalTime ? 1 : e1->iTotalTime > e2->iTotalTime ? -1 : 0);
+}
+
+gchar *gldi_object_dump_notification_profile (void)
+{
+	GString *sDump = g_string_new ("");
+	if (s_pProfilerEntries == NULL)
+		return g_string_free (sDump, FALSE);
+	
+	// sort the entries by total time, the most expensive first
+	GldiProfilerEntry *pEntries = g_new (GldiProfilerEntry, GLDI_PROFILER_NB_ENTRIES);
+	memcpy (pEntries, s_pProfilerEntries, GLDI_PROFILER_NB_ENTRIES * sizeof (GldiProfilerEntry));
+	qsort (pEntries, GLDI_PROFILER_NB_ENTRIES, sizeof (GldiProfilerEntry), (GCompareFunc)_compare_entries);
+	
+	GldiProfilerEntry *pEntry;
+	guint i;
+	for (i = 0; i < GLDI_PROFILER_NB_ENTRIES; i ++)
+	{
+		pEntry = &pEntries[i];
+		if (pEntry->cManagerName == NULL)
+			continue;
+		g_string_append_printf (sDump, "%s\t%u\t", pEntry->cManagerName, pEntry->iNotifType);
+		_append_function_name (sDump, pEntry->pFunction);
+		g_string_append_printf (sDump, "\t%u\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\n", pEntry->iNbCalls, pEntry->iTotalTime, pEntry->iMaxTime);
+	}
+	g_free (pEntries);
+	return g_string_free (sDump, FALSE);
+}
+
+gchar *gldi_object_dump_notification_history (void)
+{
+	GString *sDump = g_string_new ("");
+	if (s_pProfilerHistory == NULL)
+		return g_string_free (sDump, FALSE);
+	
+	GldiProfilerSample *pSample;
+	guint i, n;
+	for (n = 0; n < s_iNbSamples; n ++)  // oldest first
+	{
+		i = (s_iHistoryIndex + GLDI_PROFILER_HISTORY_SIZE - s_iNbSamples + n) % GLDI_PROFILER_HISTORY_SIZE;
+		pSample = &s_pProfilerHistory[i];
+		g_string_append_printf (sDump, "%" G_GINT64_FORMAT "\t%s\t%u\t", pSample->iTime, pSample->pEntry->cManagerName, pSample->pEntry->iNotifType);
+		_append_function_name (sDump, pSample->pEntry->pFunction);
+		g_string_append_printf (sDump, "\t%" G_GINT64_FORMAT "\n", pSample->iDuration);
+	}
+	return g_string_free (sDump, FALSE);
+}
+
+
+  /////////////////
+ /// SELF-TEST ///
+/////////////////
+
+#define GLDI_NOTIFICATION_SELF_TEST NB_NOTIFICATIONS_OBJECT  // a notification of our own, that no one else listens to
+static GldiObjectManager s_testMgr;
+static guint s_iNbTestCalls = 0;
+static guint s_iNbTestCallsAfterDestroy = 0;
+static gboolean s_bTestObjectDestroyed = FALSE;
+
+static gboolean _on_self_test_destroy (G_GNUC_UNUSED gpointer data, GldiObject *pObject)
+{
+	s_iNbTestCalls ++;
+	gldi_object_unref (pObject);  // the object is destroyed in the middle of its own notification.
+	s_bTestObjectDestroyed = TRUE;
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+static gboolean _on_self_test_count (G_GNUC_UNUSED gpointer data, G_GNUC_UNUSED GldiObject *pObject)
+{
+	s_iNbTestCalls ++;
+	if (s_bTestObjectDestroyed)
+		s_iNbTestCallsAfterDestroy ++;
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+void gldi_object_test_destroy_during_notification (guint *iNbCalls, guint *iNbCallsAfterDestroy)
+{
+	if (s_testMgr.cName == NULL)
+	{
+		s_testMgr.cName = "SelfTest";
+		s_testMgr.iObjectSize = sizeof (GldiObject);
+		gldi_object_install_notifications (&s_testMgr, GLDI_NOTIFICATION_SELF_TEST + 1);
+		gldi_object_register_notification (&s_testMgr, GLDI_NOTIFICATION_SELF_TEST, (GldiNotificationFunc) _on_self_test_count, GLDI_RUN_AFTER, NULL);
+	}
+	GldiObject *pObject = gldi_object_new (&s_testMgr, NULL);
+	gldi_object_register_notification (pObject, GLDI_NOTIFICATION_SELF_TEST, (GldiNotificationFunc) _on_self_test_destroy, GLDI_RUN_AFTER, NULL);
+	gldi_object_register_notification (pObject, GLDI_NOTIFICATION_SELF_TEST, (GldiNotificationFunc) _on_self_test_count, GLDI_RUN_AFTER, NULL);
+	gldi_object_register_notification (pObject, GLDI_NOTIFICATION_SELF_TEST, (GldiNotificationFunc) _on_self_test_count, GLDI_RUN_AFTER, NULL);
+	
+	s_iNbTestCalls = s_iNbTestCallsAfterDestroy = 0;
+	s_bTestObjectDestroyed = FALSE;
+	gldi_object_notify (pObject, GLDI_NOTIFICATION_SELF_TEST, pObject);
+	
+	*iNbCalls = s_iNbTestCalls;
+	*iNbCallsAfterDestroy = s_iNbTestCallsAfterDestroy;
+}
@@ -41,7 +41,7 @@ G_BEGIN_DECLS
 /// Definition of an Object.
 struct _GldiObject {
 	gint ref;
-	GPtrArray *pNotificationsTab;
+	GArray *pNotificationsTab;  // array of GldiNotificationList, indexed by the type of notification
 	GldiObjectManager *mgr;
 	GList *mgrs;  // sorted in reverse order
 };
@@ -113,10 +113,21 @@ gboolean gldi_object_is_manager_child (GldiObject *pObject, GldiObjectManager *p
 typedef gboolean (* GldiNotificationFunc) (gpointer pUserData, ...);
 
 typedef struct {
-	GldiNotificationFunc pFunction;
+	GldiNotificationFunc pFunction;  // NULL if the record has been removed during a notification
 	gpointer pUserData;
 	} GldiNotificationRecord;
 
+/// Callbacks registered for a given notification on a given object, stored contiguously in the order they're called.
+typedef struct {
+	GldiNotificationRecord *pRecords;
+	guint iNbRecords;
+	guint iSize;  // number of allocated records
+	gboolean bHasHoles;  // TRUE if some records have been removed during a notification and not yet compacted
+	guint iDepth;  // number of broadcasts currently walking the records
+	guint iNbRunFirst;  // number of records ever inserted at the beginning; lets a broadcast know that the records have been shifted under its feet
+	gboolean bDestroyed;  // TRUE if the object has been destroyed by one of the callbacks; the broadcast stops there
+	} GldiNotificationList;
+
 typedef guint GldiNotificationType;
 
 /// Use this in \ref gldi_object_register_notification to be called before the core.
@@ -131,12 +142,13 @@ typedef guint GldiNotificationType;
 
 
 #define gldi_object_install_notifications(pObject, iNbNotifs) do {\
-	GPtrArray *pNotificationsTab = (GLDI_OBJECT(pObject))->pNotificationsTab;\
+	GArray *pNotificationsTab = (GLDI_OBJECT(pObject))->pNotificationsTab;\
 	if (pNotificationsTab == NULL) {\
-		pNotificationsTab = g_ptr_array_new ();\
+		pNotificationsTab = g_array_new (FALSE, TRUE, sizeof (GldiNotificationList));\
+		g_array_set_clear_func (pNotificationsTab, (GDestroyNotify) gldi_object_clear_notification_list);\
 		(GLDI_OBJECT(pObject))->pNotificationsTab = pNotificationsTab; }\
 	if (pNotificationsTab->len < iNbNotifs)\
-		g_ptr_array_set_size (pNotificationsTab, iNbNotifs); } while (0)
+		g_array_set_size (pNotificationsTab, iNbNotifs); } while (0)
 
 /** Register an action to be called when a given notification is broadcasted from a given object.
 *@param pObject the object (Icon, Container, Manager).
@@ -144,11 +156,12 @@ typedef guint GldiNotificationType;
 *@param pFunction callback.
 *@param bRunFirst GLDI_RUN_FIRST to be called before Cairo-Dock, GLDI_RUN_AFTER to be called after.
 *@param pUserData data to be passed as the first parameter of the callback.
+Note: it can be called during a notification; if it is the same notification, the callback is called in the current broadcast if it runs after, and not if it runs first.
 */
 void gldi_object_register_notification (gpointer pObject, GldiNotificationType iNotifType, GldiNotificationFunc pFunction, gboolean bRunFirst, gpointer pUserData);
 
 /** Remove a callback from the list of callbacks of a given object for a given notification and a given data.
-Note: it is safe to remove the callback when it is called, but not another one.
+Note: it is safe to remove any callback during a notification; it won't be called any more.
 *@param pObject the object (Icon, Container, Manager) for which the action has been registered.
 *@param iNotifType type of the notification.
 *@param pFunction callback.
@@ -157,26 +170,56 @@ Note: it is safe to remove the callback when it is called, but not another one.
 void gldi_object_remove_notification (gpointer pObject, GldiNotificationType iNotifType, GldiNotificationFunc pFunction, gpointer pUserData);
 
 
-#define __notify(pNotificationRecordList, bStop, ...) do {\
-	GldiNotificationRecord *pNotificationRecord;\
-	GSList *pElement = pNotificationRecordList, *pNextElement;\
-	while (pElement != NULL && ! bStop) {\
-		pNotificationRecord = pElement->data;\
-		pNextElement = pElement->next;\
-		bStop = pNotificationRecord->pFunction (pNotificationRecord->pUserData, ##__VA_ARGS__);\
-		pElement = pNextElement; }\
-	} while (0)
+// removes the holes left by the callbacks removed while the list was walked; done at the end of the outermost broadcast on the list.
+void gldi_object_compact_notification_list (GldiNotificationList *pList);
+
+// frees the records of a list; called when the notifications tab is freed, that is to say when the object is destroyed and no broadcast holds the tab any more.
+void gldi_object_clear_notification_list (GldiNotificationList *pList);
+
+// when the profiler is enabled, each call to a callback is timed and recorded; when disabled, it only costs a test.
+extern gboolean g_bNotificationProfiling;
+void gldi_object_profile_notification (const gchar *cManagerName, GldiNotificationType iNotifType, GldiNotificationFunc pFunction, gint64 iDuration);
 
-#define __notify_on_object(pObject, iNotifType, ...) \
+#define __call_notification_record(pRecord, cManagerName, iNotifType, ...) \
+	__extension__ ({\
+	gboolean _r;\
+	if (G_UNLIKELY (g_bNotificationProfiling)) {\
+		GldiNotificationFunc _f = (pRecord)->pFunction;\
+		const gchar *_cMgrName = (cManagerName);  /* get it before the call, the object may not survive it */\
+		gint64 _t0 = g_get_monotonic_time ();\
+		_r = _f ((pRecord)->pUserData, ##__VA_ARGS__);\
+		gldi_object_profile_notification (_cMgrName, iNotifType, _f, g_get_monotonic_time () - _t0); }\
+	else {\
+		_r = (pRecord)->pFunction ((pRecord)->pUserData, ##__VA_ARGS__); }\
+	_r; })
+
+#define __notify_on_object_full(pObject, bIsManager, iNotifType, ...) \
 	__extension__ ({\
 	gboolean _stop = FALSE;\
-	GPtrArray *pNotificationsTab = (pObject)->pNotificationsTab;\
+	GArray *pNotificationsTab = (pObject)->pNotificationsTab;\
 	if (pNotificationsTab && iNotifType < pNotificationsTab->len) {\
-		GSList *pNotificationRecordList = g_ptr_array_index (pNotificationsTab, iNotifType);\
-		__notify (pNotificationRecordList, _stop, ##__VA_ARGS__);} \
+		GldiNotificationList *_pList = &g_array_index (pNotificationsTab, GldiNotificationList, iNotifType);\
+		GldiNotificationRecord *_pRecord;\
+		guint _i, _n;\
+		g_array_ref (pNotificationsTab);  /* a callback may destroy the object, keep its tab alive until we're done with it */\
+		_pList->iDepth ++;\
+		for (_i = 0; ! _stop && _i < _pList->iNbRecords; _i ++) {\
+			_pRecord = &_pList->pRecords[_i];\
+			if (_pRecord->pFunction != NULL) {\
+				_n = _pList->iNbRunFirst;\
+				_stop = __call_notification_record (_pRecord, (bIsManager ? ((GldiObjectManager*)(pObject))->cName : gldi_object_get_type (pObject)), iNotifType, ##__VA_ARGS__);\
+				_pList = &g_array_index (pNotificationsTab, GldiNotificationList, iNotifType);  /* the tab may have been resized */\
+				_i += _pList->iNbRunFirst - _n; }}  /* skip the callbacks registered in front of us meanwhile */\
+		if (-- _pList->iDepth == 0 && _pList->bHasHoles)\
+			gldi_object_compact_notification_list (_pList);\
+		if (_pList->bDestroyed)\
+			_stop = TRUE;  /* don't pass a destroyed object to the managers */\
+		g_array_unref (pNotificationsTab); }\
 	else {_stop = TRUE;}\
 	_stop; })
 
+#define __notify_on_object(pObject, iNotifType, ...) __notify_on_object_full (pObject, FALSE, iNotifType, ##__VA_ARGS__)
+
 /** Broadcast a notification on a given object, and on all its managers.
 *@param pObject the object (Icon, Container, Manager, ...).
 *@param iNotifType type of the notification.
@@ -185,12 +228,41 @@ void gldi_object_remove_notification (gpointer pObject, GldiNotificationType iNo
 #define gldi_object_notify(pObject, iNotifType, ...) \
 	__extension__ ({\
 	gboolean _bStop = FALSE;\
+	gboolean _bIsMgr = FALSE;  /* the first hop is the object itself, the next ones are its managers */\
 	GldiObject *_obj = GLDI_OBJECT (pObject);\
+	GldiObject *_next;\
 	while (_obj && !_bStop) {\
-		_bStop = __notify_on_object (_obj, iNotifType, ##__VA_ARGS__);\
-		_obj = GLDI_OBJECT (_obj->mgr); }\
+		_next = GLDI_OBJECT (_obj->mgr);  /* get it before the broadcast, the object may not survive it */\
+		_bStop = __notify_on_object_full (_obj, _bIsMgr, iNotifType, ##__VA_ARGS__);\
+		_obj = _next;\
+		_bIsMgr = TRUE; }\
 	})
 
+/** Enable or disable the notifications profiler. When enabled, the number of calls, the cumulated and the maximum time spent in each callback of each notification are recorded, as well as the last calls.
+*@param bEnable TRUE to enable it
+*/
+void gldi_object_set_notification_profiling (gboolean bEnable);
+
+/** Reset all the data collected by the notifications profiler.
+*/
+void gldi_object_reset_notification_profile (void);
+
+/** Dump the statistics of the notifications profiler, one line per (manager, notification, callback), sorted by cumulated time: "manager notification callback calls total(us) max(us)", separated by tabs.
+*@return a newly allocated string.
+*/
+gchar *gldi_object_dump_notification_profile (void);
+
+/** Dump the last calls recorded by the notifications profiler, oldest first: "time(us) manager notification callback duration(us)", separated by tabs.
+*@return a newly allocated string.
+*/
+gchar *gldi_object_dump_notification_history (void);
+
+/** Check that an object can be destroyed by one of its own callbacks: a throwaway object is destroyed by the first of its 3 callbacks, and a callback is registered on its manager. None of the other callbacks should be called after that.
+*@param iNbCalls returns the number of callbacks that have been called (1 is expected)
+*@param iNbCallsAfterDestroy returns the number of callbacks that have been called after the object has been destroyed (0 is expected)
+*/
+void gldi_object_test_destroy_during_notification (guint *iNbCalls, guint *iNbCallsAfterDestroy);
+
 
 
 #define	GLDI_STR_HELPER(x) #x
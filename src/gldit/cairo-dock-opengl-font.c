@@ -18,7 +18,8 @@
 */
 
 #include <math.h>
-#include <pango/pango.h>
+#include <string.h>
+#include <pango/pangocairo.h>
 #include <cairo.h>
 #include <GL/gl.h>
 
@@ -26,6 +27,8 @@
 #include "cairo-dock-draw.h"  // cairo_dock_create_drawing_context_generic
 #include "cairo-dock-log.h"
 #include "cairo-dock-draw-opengl.h"
+#include "cairo-dock-style-facility.h"  // GldiTextDescription
+#include "cairo-dock-style-manager.h"  // gldi_style_colors_set_text_color
 
 #include "cairo-dock-opengl-font.h"
 
@@ -176,64 +179,339 @@ CairoDockGLFont *cairo_dock_load_bitmap_font (const gchar *cFontDescription, int
 	return pFont;
 }*/
 
-CairoDockGLFont *cairo_dock_load_textured_font (const gchar *cFontDescription, int first, int count)
+
+  ///////////////////
+ /// GLYPH ATLAS ///
+///////////////////
+
+#define CD_GLYPH_ATLAS_SIZE 512  // large enough for a few hundreds glyphs of a usual text size.
+#define CD_GLYPH_PADDING 1  // transparent pixels around each glyph, so that the linear filtering doesn't bleed over the neighbours.
+
+typedef struct {
+	gint x, y;  // position in the atlas, or -1 if the glyph is not (yet) in the atlas.
+	gint iWidth, iHeight;  // size of the glyph's image (0 for blank glyphs like spaces).
+	gint iOffsetX, iOffsetY;  // position of the image relatively to the pen, from the top of the line.
+	gdouble fAdvance;
+} CairoDockGLGlyph;
+
+typedef struct {
+	GLuint iTexture;
+	gint iPenX, iPenY, iRowHeight;  // the glyphs are packed in rows.
+	GHashTable *pGlyphs;  // unichar -> glyph
+	PangoLayout *pLayout;
+	gint iLineHeight;
+	gint iBaseline;
+	GldiTextDescription *pTextDescription;  // NULL for a plain white font.
+	gdouble fScale;
+	gint x, y, iWidth, iHeight, iCap;  // frame of the decorated texts, drawn once into the atlas and stretched in its middle.
+} CairoDockGLGlyphAtlas;
+
+typedef struct {
+	CairoDockGLFont font;
+	gint iRefCount;
+	CairoDockGLGlyphAtlas *pAtlas;  // NULL for a font loaded from an image.
+} CairoDockGLFontPrivate;
+
+static GArray *s_pTextVertices = NULL;  // u,v,x,y of the quads being drawn, re-used for each text.
+
+static void _render_text (CairoDockGLGlyphAtlas *pAtlas, cairo_t *pCairoContext, double x, double y)
 {
-	g_return_val_if_fail (g_pPrimaryContainer != NULL && count > 0, NULL);
-	if (first < 32)  // 32 = ' '
+	GldiTextDescription *pTextDescription = pAtlas->pTextDescription;
+	if (pTextDescription && pTextDescription->bOutlined)
 	{
-		count -= (32 - first);
-		first = 32;
-	}
-	gchar *cPool = g_new0 (gchar, 4*count + 1);
-	int i, j=0;
-	guchar c;
-	for (i = 0; i < count; i ++)
-	{
-		c = first + i;
-		if (c > 254)
-		{
-			count=i;
-			break;
-		}
-		if ((c > 126 && c < 126 + 37) || (c == 173))  // le 173 est un caractere bizarre (sa taille est nulle).
+		cairo_push_group (pCairoContext);
+		cairo_set_source_rgb (pCairoContext, 0.2, 0.2, 0.2);
+		int i;
+		for (i = 0; i < 2; i++)
 		{
-			cPool[j++] = ' ';
+			cairo_move_to (pCairoContext, x, y + 2*i-1);
+			pango_cairo_show_layout (pCairoContext, pAtlas->pLayout);
 		}
-		else
+		for (i = 0; i < 2; i++)
 		{
-			j += MAX (0, sprintf (cPool+j, "%lc", c));  // les caracteres ASCII >128 doivent etre convertis en multi-octets.
+			cairo_move_to (pCairoContext, x + 2*i-1, y);
+			pango_cairo_show_layout (pCairoContext, pAtlas->pLayout);
 		}
+		cairo_pop_group_to_source (pCairoContext);
+		cairo_paint (pCairoContext);
 	}
-	cd_debug ("%s (%d + %d -> '%s')", __func__, first, count, cPool);
-	/*iconv_t cd = iconv_open("UTF-8", "ISO-8859-1");
-	gchar *outbuf = g_new0 (gchar, count*4+1);
-	gchar *outbuf0 = outbuf, *inbuf0 = cPool;
-	size_t inbytesleft = count;
-	size_t outbytesleft = count*4;
-	size_t size = iconv (cd,
-		&cPool, &inbytesleft,
-		&outbuf, &outbytesleft);
-	cd_debug ("%d bytes left, %d bytes written => '%s'", inbytesleft, outbytesleft, outbuf0);
-	g_free (inbuf0);
-	cPool = outbuf0;
-	iconv_close (cd);*/
-	
-	int iWidth, iHeight;
+	
+	if (pTextDescription == NULL)  // white, so that it can be colorized with glColor.
+		cairo_set_source_rgb (pCairoContext, 1., 1., 1.);
+	else if (pTextDescription->bUseDefaultColors)
+		gldi_style_colors_set_text_color (pCairoContext);
+	else
+		gldi_color_set_cairo_rgb (pCairoContext, &pTextDescription->fColorStart);
+	cairo_move_to (pCairoContext, x, y);
+	pango_cairo_show_layout (pCairoContext, pAtlas->pLayout);
+}
+
+static void _upload_image (CairoDockGLGlyphAtlas *pAtlas, cairo_surface_t *pSurface, int x, int y)
+{
+	cairo_surface_flush (pSurface);
+	glBindTexture (GL_TEXTURE_2D, pAtlas->iTexture);
+	glPixelStorei (GL_UNPACK_ROW_LENGTH, cairo_image_surface_get_stride (pSurface) / 4);
+	glTexSubImage2D (GL_TEXTURE_2D, 0,
+		x, y,
+		cairo_image_surface_get_width (pSurface),
+		cairo_image_surface_get_height (pSurface),
+		GL_BGRA,
+		GL_UNSIGNED_BYTE,
+		cairo_image_surface_get_data (pSurface));
+	glPixelStorei (GL_UNPACK_ROW_LENGTH, 0);
+}
+
+static gboolean _reserve_space (CairoDockGLGlyphAtlas *pAtlas, int w, int h, int *x, int *y)
+{
+	if (pAtlas->iPenX + w > CD_GLYPH_ATLAS_SIZE)  // next row
+	{
+		pAtlas->iPenX = 0;
+		pAtlas->iPenY += pAtlas->iRowHeight;
+		pAtlas->iRowHeight = 0;
+	}
+	if (pAtlas->iPenY + h > CD_GLYPH_ATLAS_SIZE || w > CD_GLYPH_ATLAS_SIZE)  // the atlas is full
+		return FALSE;
+	*x = pAtlas->iPenX;
+	*y = pAtlas->iPenY;
+	pAtlas->iPenX += w;
+	pAtlas->iRowHeight = MAX (pAtlas->iRowHeight, h);
+	return TRUE;
+}
+
+static void _draw_frame_into_atlas (CairoDockGLGlyphAtlas *pAtlas)
+{
+	// same frame as cairo_dock_create_surface_from_text_full(), with the shortest possible straight part; it will be stretched to the width of the text.
+	GldiTextDescription *pTextDescription = pAtlas->pTextDescription;
+	int iSize = gldi_text_description_get_size (pTextDescription);
+	double fRadius = (pTextDescription->bUseDefaultColors ? MIN (myStyleParam.iCornerRadius * .75, iSize/2) : pAtlas->fScale * MAX (pTextDescription->iMargin, MIN (6, iSize/2)));
+	int iOutlineMargin = 2*pTextDescription->iMargin * pAtlas->fScale + (pTextDescription->bOutlined ? 2 : 0);
+	double fLineWidth = 1;
+	int iCap = ceil (fRadius + fLineWidth) + 1;
+	int w = 2 * iCap + 1;
+	int h = pAtlas->iLineHeight + iOutlineMargin + 2*fLineWidth;
+	if (! _reserve_space (pAtlas, w + 2*CD_GLYPH_PADDING, h + 2*CD_GLYPH_PADDING, &pAtlas->x, &pAtlas->y))
+		return;
+	pAtlas->x += CD_GLYPH_PADDING;
+	pAtlas->y += CD_GLYPH_PADDING;
+	pAtlas->iWidth = w;
+	pAtlas->iHeight = h;
+	pAtlas->iCap = iCap;
+	
+	cairo_surface_t *pSurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, w, h);
+	cairo_t *pCairoContext = cairo_create (pSurface);
+	cairo_dock_draw_rounded_rectangle (pCairoContext, fRadius, fLineWidth, w - 2 * fRadius - fLineWidth, h - fLineWidth);
+	if (pTextDescription->bUseDefaultColors)
+		gldi_style_colors_set_bg_color (pCairoContext);
+	else
+		gldi_color_set_cairo (pCairoContext, &pTextDescription->fBackgroundColor);
+	cairo_fill_preserve (pCairoContext);
+	if (pTextDescription->bUseDefaultColors)
+		gldi_style_colors_set_line_color (pCairoContext);
+	else
+		gldi_color_set_cairo (pCairoContext, &pTextDescription->fLineColor);
+	cairo_set_line_width (pCairoContext, fLineWidth);
+	cairo_stroke (pCairoContext);
+	cairo_destroy (pCairoContext);
+	
+	_upload_image (pAtlas, pSurface, pAtlas->x, pAtlas->y);
+	cairo_surface_destroy (pSurface);
+}
+
+static void _forget_glyph_position (G_GNUC_UNUSED gpointer key, CairoDockGLGlyph *pGlyph, G_GNUC_UNUSED gpointer data)
+{
+	pGlyph->x = pGlyph->y = -1;
+}
+static void _reset_atlas (CairoDockGLGlyphAtlas *pAtlas)
+{
+	// clear the texture, the glyphs will be drawn again when needed; their metrics are kept.
+	guchar *pBlank = g_new0 (guchar, CD_GLYPH_ATLAS_SIZE * CD_GLYPH_ATLAS_SIZE * 4);
+	glBindTexture (GL_TEXTURE_2D, pAtlas->iTexture);
+	glTexSubImage2D (GL_TEXTURE_2D, 0, 0, 0, CD_GLYPH_ATLAS_SIZE, CD_GLYPH_ATLAS_SIZE, GL_BGRA, GL_UNSIGNED_BYTE, pBlank);
+	g_free (pBlank);
+	g_hash_table_foreach (pAtlas->pGlyphs, (GHFunc)_forget_glyph_position, NULL);
+	pAtlas->iPenX = pAtlas->iPenY = pAtlas->iRowHeight = 0;
+	
+	if (pAtlas->pTextDescription != NULL && ! pAtlas->pTextDescription->bNoDecorations)
+		_draw_frame_into_atlas (pAtlas);
+}
+
+static CairoDockGLGlyphAtlas *_create_atlas (PangoFontDescription *fd, GldiTextDescription *pTextDescription, double fScale)
+{
 	cairo_t *pCairoContext = cairo_dock_create_drawing_context_generic (g_pPrimaryContainer);
-	GLuint iTexture = cairo_dock_create_texture_from_text_simple (cPool, cFontDescription, pCairoContext, &iWidth, &iHeight);
+	PangoLayout *pLayout = pango_cairo_create_layout (pCairoContext);
 	cairo_destroy (pCairoContext);
-	g_free (cPool);
+	pango_layout_set_font_description (pLayout, fd);
 	
-	CairoDockGLFont *pFont = g_new0 (CairoDockGLFont, 1);
-	pFont->iTexture = iTexture;
+	CairoDockGLGlyphAtlas *pAtlas = g_new0 (CairoDockGLGlyphAtlas, 1);
+	pAtlas->pLayout = pLayout;
+	pAtlas->pGlyphs = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+	pAtlas->pTextDescription = (pTextDescription ? gldi_text_description_duplicate (pTextDescription) : NULL);
+	pAtlas->fScale = fScale;
+	
+	// metrics of a line, the same for all the glyphs of the font.
+	PangoRectangle log;
+	pango_layout_set_text (pLayout, "Ag", -1);
+	pango_layout_get_pixel_extents (pLayout, NULL, &log);
+	pAtlas->iLineHeight = log.height;
+	pAtlas->iBaseline = pango_layout_get_baseline (pLayout) / PANGO_SCALE;
+	
+	glGenTextures (1, &pAtlas->iTexture);
+	glBindTexture (GL_TEXTURE_2D, pAtlas->iTexture);
+	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA, CD_GLYPH_ATLAS_SIZE, CD_GLYPH_ATLAS_SIZE, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+	_reset_atlas (pAtlas);
+	return pAtlas;
+}
+
+static void _free_atlas (CairoDockGLGlyphAtlas *pAtlas)
+{
+	_cairo_dock_delete_texture (pAtlas->iTexture);
+	g_hash_table_destroy (pAtlas->pGlyphs);
+	g_object_unref (pAtlas->pLayout);
+	if (pAtlas->pTextDescription)
+		gldi_text_description_free (pAtlas->pTextDescription);
+	g_free (pAtlas);
+}
+
+static inline int _get_glyph_margin (CairoDockGLGlyphAtlas *pAtlas)
+{
+	return CD_GLYPH_PADDING + (pAtlas->pTextDescription && pAtlas->pTextDescription->bOutlined ? 1 : 0);  // outlined => +1 all around the letters.
+}
+
+static CairoDockGLGlyph *_get_glyph (CairoDockGLGlyphAtlas *pAtlas, gunichar c)
+{
+	CairoDockGLGlyph *pGlyph = g_hash_table_lookup (pAtlas->pGlyphs, GUINT_TO_POINTER (c));
+	if (pGlyph != NULL)
+		return pGlyph;
+	
+	gchar utf8[6];
+	pango_layout_set_text (pAtlas->pLayout, utf8, g_unichar_to_utf8 (c, utf8));
+	PangoRectangle ink, log;
+	pango_layout_get_pixel_extents (pAtlas->pLayout, &ink, &log);
+	int m = _get_glyph_margin (pAtlas);
+	
+	pGlyph = g_new0 (CairoDockGLGlyph, 1);
+	pGlyph->x = pGlyph->y = -1;
+	if (ink.width > 0 && ink.height > 0)
+	{
+		pGlyph->iWidth = ink.width + 2*m;
+		pGlyph->iHeight = ink.height + 2*m;
+	}
+	pGlyph->iOffsetX = ink.x - m;
+	pGlyph->iOffsetY = ink.y - m + pAtlas->iBaseline - pango_layout_get_baseline (pAtlas->pLayout) / PANGO_SCALE;  // a fallback font may have another baseline.
+	pGlyph->fAdvance = log.width;
+	g_hash_table_insert (pAtlas->pGlyphs, GUINT_TO_POINTER (c), pGlyph);
+	return pGlyph;
+}
+
+static gboolean _put_glyph_in_atlas (CairoDockGLGlyphAtlas *pAtlas, gunichar c, CairoDockGLGlyph *pGlyph)
+{
+	if (pGlyph->x >= 0 || pGlyph->iWidth == 0)  // already there, or nothing to draw.
+		return TRUE;
+	if (! _reserve_space (pAtlas, pGlyph->iWidth, pGlyph->iHeight, &pGlyph->x, &pGlyph->y))
+	{
+		pGlyph->x = pGlyph->y = -1;
+		return FALSE;
+	}
+	
+	gchar utf8[6];
+	pango_layout_set_text (pAtlas->pLayout, utf8, g_unichar_to_utf8 (c, utf8));
+	int iBaselineOffset = pAtlas->iBaseline - pango_layout_get_baseline (pAtlas->pLayout) / PANGO_SCALE;
+	cairo_surface_t *pSurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, pGlyph->iWidth, pGlyph->iHeight);
+	cairo_t *pCairoContext = cairo_create (pSurface);
+	_render_text (pAtlas, pCairoContext, - pGlyph->iOffsetX, - pGlyph->iOffsetY + iBaselineOffset);
+	cairo_destroy (pCairoContext);
+	_upload_image (pAtlas, pSurface, pGlyph->x, pGlyph->y);
+	cairo_surface_destroy (pSurface);
+	return TRUE;
+}
+
+static inline gunichar _get_next_char (const gchar **cText)
+{
+	const gchar *str = *cText;
+	gunichar c = g_utf8_get_char_validated (str, -1);
+	if (c == (gunichar)-1 || c == (gunichar)-2)  // not UTF-8, take it as Latin-1 like before.
+	{
+		*cText = str + 1;
+		return (guchar) *str;
+	}
+	*cText = g_utf8_next_char (str);
+	return c;
+}
+
+
+  ///////////////
+ /// LOADING ///
+///////////////
+
+static CairoDockGLFont *_new_font (CairoDockGLGlyphAtlas *pAtlas)
+{
+	CairoDockGLFontPrivate *pPrivate = g_new0 (CairoDockGLFontPrivate, 1);
+	pPrivate->iRefCount = 1;
+	pPrivate->pAtlas = pAtlas;
+	if (pAtlas)
+	{
+		pPrivate->font.iTexture = pAtlas->iTexture;
+		pPrivate->font.iCharHeight = pAtlas->iLineHeight;
+	}
+	return &pPrivate->font;
+}
+#define _get_font_atlas(pFont) ((CairoDockGLFontPrivate*)(pFont))->pAtlas
+
+CairoDockGLFont *cairo_dock_load_textured_font (const gchar *cFontDescription, int first, int count)
+{
+	g_return_val_if_fail (g_pPrimaryContainer != NULL && cFontDescription != NULL && count > 0, NULL);
+	if (first < 32)  // 32 = ' '
+	{
+		count -= (32 - first);
+		first = 32;
+	}
+	
+	PangoFontDescription *fd = pango_font_description_from_string (cFontDescription);
+	CairoDockGLGlyphAtlas *pAtlas = _create_atlas (fd, NULL, 1.);
+	pango_font_description_free (fd);
+	
+	CairoDockGLFont *pFont = _new_font (pAtlas);
 	pFont->iNbChars = count;
 	pFont->iCharBase = first;
 	pFont->iNbRows = 1;
 	pFont->iNbColumns = count;
-	pFont->iCharWidth = (double)iWidth / count;
-	pFont->iCharHeight = iHeight;
 	
-	cd_debug ("%d char / %d pixels => %.3f", count, iWidth, (double)iWidth / count);
+	// load the given characters right away; any other character will be loaded when it's first drawn.
+	CairoDockGLGlyph *pGlyph;
+	double fWidth = 0;
+	int i, n = 0;
+	gunichar c;
+	for (i = 0; i < count; i ++)
+	{
+		c = first + i;
+		if ((c > 126 && c < 126 + 37) || (c == 173))  // control characters, and 173 which is a weird character (its size is null).
+			continue;
+		pGlyph = _get_glyph (pAtlas, c);
+		_put_glyph_in_atlas (pAtlas, c, pGlyph);
+		fWidth += pGlyph->fAdvance;
+		n ++;
+	}
+	pFont->iCharWidth = (n != 0 ? fWidth / n : 0);
+	
+	cd_debug ("%d char => %.3f pixels", n, pFont->iCharWidth);
+	return pFont;
+}
+
+CairoDockGLFont *cairo_dock_load_gl_font_from_text_description (GldiTextDescription *pTextDescription, double fScale)
+{
+	g_return_val_if_fail (g_pPrimaryContainer != NULL && pTextDescription != NULL, NULL);
+	PangoFontDescription *pDesc = gldi_text_description_get_description (pTextDescription);
+	g_return_val_if_fail (pDesc != NULL, NULL);
+	
+	PangoFontDescription *fd = pango_font_description_copy (pDesc);
+	pango_font_description_set_absolute_size (fd, fScale * gldi_text_description_get_size (pTextDescription) * PANGO_SCALE);
+	CairoDockGLGlyphAtlas *pAtlas = _create_atlas (fd, pTextDescription, fScale);
+	pango_font_description_free (fd);
+	
+	CairoDockGLFont *pFont = _new_font (pAtlas);
+	pFont->iNbRows = 1;
 	return pFont;
 }
 
@@ -243,7 +521,7 @@ CairoDockGLFont *cairo_dock_load_textured_font_from_image (const gchar *cImagePa
 	GLuint iTexture = cairo_dock_create_texture_from_image_full (cImagePath, &fImageWidth, &fImageHeight);
 	g_return_val_if_fail (iTexture != 0, NULL);
 	
-	CairoDockGLFont *pFont = g_new0 (CairoDockGLFont, 1);
+	CairoDockGLFont *pFont = _new_font (NULL);
 	pFont->iTexture = iTexture;
 	pFont->iNbChars = 256;
 	pFont->iCharBase = 0;
@@ -254,158 +532,286 @@ CairoDockGLFont *cairo_dock_load_textured_font_from_image (const gchar *cImagePa
 	return pFont;
 }
 
+CairoDockGLFont *cairo_dock_ref_gl_font (CairoDockGLFont *pFont)
+{
+	g_return_val_if_fail (pFont != NULL, NULL);
+	((CairoDockGLFontPrivate*)pFont)->iRefCount ++;
+	return pFont;
+}
+
 void cairo_dock_free_gl_font (CairoDockGLFont *pFont)
 {
 	if (pFont == NULL)
 		return ;
-	if (pFont->iListBase != 0)
-		glDeleteLists (pFont->iListBase, pFont->iNbChars);
-	if (pFont->iTexture != 0)
+	CairoDockGLFontPrivate *pPrivate = (CairoDockGLFontPrivate*)pFont;
+	pPrivate->iRefCount --;
+	if (pPrivate->iRefCount > 0)
+		return;
+	if (pPrivate->pAtlas != NULL)
+		_free_atlas (pPrivate->pAtlas);  // the texture belongs to the atlas.
+	else if (pFont->iTexture != 0)
 		_cairo_dock_delete_texture (pFont->iTexture);
-	g_free (pFont);
+	g_free (pPrivate);
 }
 
 
-void cairo_dock_get_gl_text_extent (const gchar *cText, CairoDockGLFont *pFont, int *iWidth, int *iHeight)
+  ///////////////
+ /// DRAWING ///
+///////////////
+
+static void _get_text_extent (const gchar *cText, CairoDockGLFont *pFont, double *fWidth, int *iHeight)
 {
-	if (pFont == NULL || cText == NULL)
-	{
-		*iWidth = 0;
-		*iHeight = 0;
-		return ;
-	}
-	int i, w=0, wmax=0, h=pFont->iCharHeight;
-	for (i = 0; cText[i] != '\0'; i ++)
+	CairoDockGLGlyphAtlas *pAtlas = _get_font_atlas (pFont);
+	double w = 0, wmax = 0;
+	int h = pFont->iCharHeight;
+	gunichar c;
+	while (*cText != '\0')
 	{
-		if (cText[i] == '\n')
+		c = _get_next_char (&cText);
+		if (c == '\n')
 		{
 			h += pFont->iCharHeight + 1;
 			wmax = MAX (wmax, w);
 			w = 0;
 		}
+		else if (pAtlas)
+			w += _get_glyph (pAtlas, c)->fAdvance;
 		else
 			w += pFont->iCharWidth;
 	}
-	
-	*iWidth = MAX (wmax, w);
+	*fWidth = MAX (wmax, w);
 	*iHeight = h;
 }
 
+void cairo_dock_get_gl_text_extent (const gchar *cText, CairoDockGLFont *pFont, int *iWidth, int *iHeight)
+{
+	if (pFont == NULL || cText == NULL)
+	{
+		*iWidth = 0;
+		*iHeight = 0;
+		return ;
+	}
+	double fWidth;
+	_get_text_extent (cText, pFont, &fWidth, iHeight);
+	*iWidth = ceil (fWidth);
+}
 
-void cairo_dock_draw_gl_text (const guchar *cText, CairoDockGLFont *pFont)
+static inline void _add_vertex (GLfloat u, GLfloat v, GLfloat x, GLfloat y)
+{
+	GLfloat vertex[4] = {u, v, x, y};
+	g_array_append_vals (s_pTextVertices, vertex, 4);
+}
+static void _add_quad (double x, double y, double w, double h, double u, double v, double du, double dv)  // (x,y) = top-left corner.
+{
+	_add_vertex (u, v, x, y);
+	_add_vertex (u+du, v, x+w, y);
+	_add_vertex (u+du, v+dv, x+w, y-h);
+	_add_vertex (u, v+dv, x, y-h);
+}
+
+static inline void _begin_quads (void)
 {
-	int n = strlen ((char *) cText);
-	if (pFont->iListBase != 0)
+	if (s_pTextVertices == NULL)
+		s_pTextVertices = g_array_new (FALSE, FALSE, sizeof (GLfloat));
+	g_array_set_size (s_pTextVertices, 0);
+}
+
+static gboolean _add_text_quads (const gchar *cText, CairoDockGLFont *pFont, double x0, double y0, double fZoomX)  // (x0,y0) = bottom-left corner of the first line.
+{
+	CairoDockGLGlyphAtlas *pAtlas = _get_font_atlas (pFont);
+	CairoDockGLGlyph *pGlyph;
+	double x = x0, y = y0;
+	int j;
+	gunichar c;
+	while (*cText != '\0')
 	{
-		if (pFont->iCharBase == 0 && strchr ((char *) cText, '\n') == NULL)  // version optimisee ou on a charge tous les caracteres.
+		c = _get_next_char (&cText);
+		if (c == '\n')
 		{
-			glDisable (GL_TEXTURE_2D);
-			glListBase (pFont->iListBase);
-			glCallLists (n, GL_UNSIGNED_BYTE, (unsigned char *)cText);
-			glListBase (0);
+			x = x0;
+			y += pFont->iCharHeight + 1;
+			continue;
 		}
-		else
+		if (pAtlas)
 		{
-			int i, j;
-			for (i = 0; i < n; i ++)
-			{
-				if (cText[i] == '\n')
-				{
-					GLfloat rpos[4];
-					glGetFloatv (GL_CURRENT_RASTER_POSITION, rpos);
-					glRasterPos2f (rpos[0], rpos[1] + pFont->iCharHeight + 1);
-					continue;
-				}
-				if (cText[i] < pFont->iCharBase || cText[i] >= pFont->iCharBase + pFont->iNbChars)
-					continue;
-				j = cText[i] - pFont->iCharBase;
-				glCallList (pFont->iListBase + j);
-			}
+			pGlyph = _get_glyph (pAtlas, c);
+			if (! _put_glyph_in_atlas (pAtlas, c, pGlyph))
+				return FALSE;
+			if (pGlyph->iWidth != 0)
+				_add_quad (x + pGlyph->iOffsetX * fZoomX, y + pFont->iCharHeight - pGlyph->iOffsetY,
+					pGlyph->iWidth * fZoomX, pGlyph->iHeight,
+					(double)pGlyph->x / CD_GLYPH_ATLAS_SIZE, (double)pGlyph->y / CD_GLYPH_ATLAS_SIZE,
+					(double)pGlyph->iWidth / CD_GLYPH_ATLAS_SIZE, (double)pGlyph->iHeight / CD_GLYPH_ATLAS_SIZE);
+			x += pGlyph->fAdvance * fZoomX;
 		}
-	}
-	else if (pFont->iTexture != 0)
-	{
-		_cairo_dock_enable_texture ();
-		_cairo_dock_set_blend_pbuffer ();  // rend mieux pour les textes
-		glBindTexture (GL_TEXTURE_2D, pFont->iTexture);
-		double u, v, du=1./pFont->iNbColumns, dv=1./pFont->iNbRows, w=pFont->iCharWidth, h=pFont->iCharHeight, x=.5*w, y=.5*h;
-		int i, j;
-		for (i = 0; i < n; i ++)
+		else
 		{
-			if (cText[i] == '\n')
-			{
-				x = .5*pFont->iCharWidth;
-				y += pFont->iCharHeight + 1;
-				continue;
-			}
-			if (cText[i] < pFont->iCharBase || cText[i] >= pFont->iCharBase + pFont->iNbChars)
+			if (c < (gunichar)pFont->iCharBase || c >= (gunichar)(pFont->iCharBase + pFont->iNbChars))
 				continue;
-			
-			j = cText[i] - pFont->iCharBase;
-			u = (double) (j%pFont->iNbColumns) / pFont->iNbColumns;
-			v = (double) (j/pFont->iNbColumns) / pFont->iNbRows;
-			_cairo_dock_apply_current_texture_portion_at_size_with_offset (u, v, du, dv, w, h, x, y);
-			x += pFont->iCharWidth;
+			j = c - pFont->iCharBase;
+			_add_quad (x, y + pFont->iCharHeight,
+				pFont->iCharWidth * fZoomX, pFont->iCharHeight,
+				(double) (j%pFont->iNbColumns) / pFont->iNbColumns, (double) (j/pFont->iNbColumns) / pFont->iNbRows,
+				1./pFont->iNbColumns, 1./pFont->iNbRows);
+			x += pFont->iCharWidth * fZoomX;
 		}
-		_cairo_dock_disable_texture ();
 	}
+	return TRUE;
+}
+
+static void _build_text_quads (const gchar *cText, CairoDockGLFont *pFont, double x0, double y0, double fZoomX)
+{
+	guint n = s_pTextVertices->len;
+	if (! _add_text_quads (cText, pFont, x0, y0, fZoomX))  // the atlas is full: make room for the glyphs of this text and try again.
+	{
+		g_array_set_size (s_pTextVertices, n);
+		_reset_atlas (_get_font_atlas (pFont));
+		if (! _add_text_quads (cText, pFont, x0, y0, fZoomX))
+			cd_warning ("the text '%s' has too many different characters to be drawn at once", cText);
+	}
+}
+
+static void _draw_quads (GLuint iTexture)
+{
+	if (s_pTextVertices->len == 0)
+		return;
+	glBindTexture (GL_TEXTURE_2D, iTexture);
+	glEnableClientState (GL_VERTEX_ARRAY);
+	glEnableClientState (GL_TEXTURE_COORD_ARRAY);
+	GLfloat *v = (GLfloat*) s_pTextVertices->data;
+	glTexCoordPointer (2, GL_FLOAT, 4 * sizeof (GLfloat), v);
+	glVertexPointer (2, GL_FLOAT, 4 * sizeof (GLfloat), v + 2);
+	glDrawArrays (GL_QUADS, 0, s_pTextVertices->len / 4);
+	glDisableClientState (GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState (GL_VERTEX_ARRAY);
+	g_array_set_size (s_pTextVertices, 0);
+}
+
+void cairo_dock_draw_gl_text (const guchar *cText, CairoDockGLFont *pFont)
+{
+	g_return_if_fail (pFont != NULL && cText != NULL);
+	_cairo_dock_enable_texture ();
+	_cairo_dock_set_blend_pbuffer ();  // rend mieux pour les textes
+	_begin_quads ();
+	_build_text_quads ((const gchar *) cText, pFont, 0., 0., 1.);  // all the characters in 1 draw call.
+	_draw_quads (pFont->iTexture);
+	_cairo_dock_disable_texture ();
 }
 
 void cairo_dock_draw_gl_text_in_area (const guchar *cText, CairoDockGLFont *pFont, int iWidth, int iHeight, gboolean bCentered)
 {
 	g_return_if_fail (pFont != NULL && cText != NULL);
-	if (pFont->iListBase != 0)  // marche po sur du raster.
+	int w, h;
+	cairo_dock_get_gl_text_extent ((char *) cText, pFont, &w, &h);
+	if (w == 0 || h == 0)
+		return;
+	
+	double zx, zy;
+	if (fabs ((double)iWidth/w) < fabs ((double)iHeight/h))  // on autorise les dimensions negatives pour pouvoir retourner le texte.
 	{
-		cd_warning ("can't resize raster ! use a textured font inside.");
+		zx = (double)iWidth/w;
+		zy = (iWidth*iHeight > 0 ? zx : -zx);
 	}
 	else
 	{
-		int w, h;
-		cairo_dock_get_gl_text_extent ((char *) cText, pFont, &w, &h);
-		
-		double zx, zy;
-		if (fabs ((double)iWidth/w) < fabs ((double)iHeight/h))  // on autorise les dimensions negatives pour pouvoir retourner le texte.
-		{
-			zx = (double)iWidth/w;
-			zy = (iWidth*iHeight > 0 ? zx : -zx);
-		}
-		else
-		{
-			zy = (double)iHeight/h;
-			zx = (iWidth*iHeight > 0 ? zy : -zy);
-		}
-		
-		glScalef (zx, zy, 1.);
-		if (bCentered)
-			glTranslatef (-w/2, -h/2, 0.);
-		cairo_dock_draw_gl_text (cText, pFont);
+		zy = (double)iHeight/h;
+		zx = (iWidth*iHeight > 0 ? zy : -zy);
 	}
+	
+	glScalef (zx, zy, 1.);
+	if (bCentered)
+		glTranslatef (-w/2, -h/2, 0.);
+	cairo_dock_draw_gl_text (cText, pFont);
 }
 
 void cairo_dock_draw_gl_text_at_position (const guchar *cText, CairoDockGLFont *pFont, int x, int y)
 {
 	g_return_if_fail (pFont != NULL && cText != NULL);
-	if (pFont->iListBase != 0)
-	{
-		glRasterPos2f (x, y);
-	}
-	else
-	{
-		glTranslatef (x, y, 0);
-	}
+	glTranslatef (x, y, 0);
 	cairo_dock_draw_gl_text (cText, pFont);
 }
 
 void cairo_dock_draw_gl_text_at_position_in_area (const guchar *cText, CairoDockGLFont *pFont, int x, int y, int iWidth, int iHeight, gboolean bCentered)
 {
 	g_return_if_fail (pFont != NULL && cText != NULL);
-	if (pFont->iListBase != 0)  // marche po sur du raster.
+	glTranslatef (x, y, 0);
+	cairo_dock_draw_gl_text_in_area (cText, pFont, iWidth, iHeight, bCentered);
+}
+
+
+  ///////////////////////
+ /// DECORATED TEXTS ///
+///////////////////////
+
+static inline int _get_outline_margin (CairoDockGLGlyphAtlas *pAtlas)
+{
+	GldiTextDescription *pTextDescription = pAtlas->pTextDescription;
+	return 2*pTextDescription->iMargin * pAtlas->fScale + (pTextDescription->bOutlined ? 2 : 0);
+}
+
+void cairo_dock_get_gl_decorated_text_extent (const gchar *cText, CairoDockGLFont *pFont, int iMaxWidth, int *iWidth, int *iHeight)
+{
+	CairoDockGLGlyphAtlas *pAtlas = (pFont ? _get_font_atlas (pFont) : NULL);
+	if (pAtlas == NULL || pAtlas->pTextDescription == NULL || cText == NULL)
 	{
-		cd_warning ("can't resize raster ! use a textured font inside.");
+		*iWidth = 0;
+		*iHeight = 0;
+		return ;
 	}
-	else
+	// same sizes as cairo_dock_create_surface_from_text_full().
+	double fTextWidth;
+	int iTextHeight;
+	_get_text_extent (cText, pFont, &fTextWidth, &iTextHeight);
+	int iLogWidth = ceil (fTextWidth);
+	int iOutlineMargin = _get_outline_margin (pAtlas);
+	double fZoomX = ((iMaxWidth != 0 && iLogWidth + iOutlineMargin > iMaxWidth) ? (double)iMaxWidth / (iLogWidth + iOutlineMargin) : 1.);
+	double fLineWidth = 1;
+	*iWidth = (iLogWidth + iOutlineMargin) * fZoomX + 2*fLineWidth;
+	if (! pAtlas->pTextDescription->bNoDecorations)
+	{
+		*iWidth = MAX (*iWidth, pAtlas->iWidth);
+		if (iMaxWidth != 0 && *iWidth > iMaxWidth)
+			*iWidth = iMaxWidth;
+	}
+	*iHeight = iTextHeight + iOutlineMargin + 2*fLineWidth;
+}
+
+void cairo_dock_draw_gl_decorated_text (const gchar *cText, CairoDockGLFont *pFont, int iWidth, int iHeight)
+{
+	CairoDockGLGlyphAtlas *pAtlas = (pFont ? _get_font_atlas (pFont) : NULL);
+	g_return_if_fail (pAtlas != NULL && pAtlas->pTextDescription != NULL && cText != NULL);
+	
+	double fTextWidth;
+	int iTextHeight;
+	_get_text_extent (cText, pFont, &fTextWidth, &iTextHeight);
+	_begin_quads ();
+	
+	// the frame, stretched in its middle; it's always at the beginning of the atlas, so it doesn't move if the atlas is reset while adding the glyphs.
+	if (! pAtlas->pTextDescription->bNoDecorations && pAtlas->iWidth != 0)
 	{
-		glTranslatef (x, y, 0);
-		cairo_dock_draw_gl_text_in_area (cText, pFont, iWidth, iHeight, bCentered);
+		double x = -iWidth/2., y = iHeight/2.;
+		double u = (double)pAtlas->x / CD_GLYPH_ATLAS_SIZE, v = (double)pAtlas->y / CD_GLYPH_ATLAS_SIZE, dv = (double)pAtlas->iHeight / CD_GLYPH_ATLAS_SIZE;
+		if (iWidth >= pAtlas->iWidth)
+		{
+			double du = (double)pAtlas->iCap / CD_GLYPH_ATLAS_SIZE, umid = (pAtlas->x + pAtlas->iCap + .5) / CD_GLYPH_ATLAS_SIZE;
+			_add_quad (x, y, pAtlas->iCap, iHeight, u, v, du, dv);
+			_add_quad (x + pAtlas->iCap, y, iWidth - 2*pAtlas->iCap, iHeight, umid, v, 0., dv);
+			_add_quad (x + iWidth - pAtlas->iCap, y, pAtlas->iCap, iHeight, (double)(pAtlas->x + pAtlas->iWidth - pAtlas->iCap) / CD_GLYPH_ATLAS_SIZE, v, du, dv);
+		}
+		else  // the text has been limited to a width smaller than the frame.
+		{
+			_add_quad (x, y, iWidth, iHeight, u, v, (double)pAtlas->iWidth / CD_GLYPH_ATLAS_SIZE, dv);
+		}
 	}
+	
+	// then the text, centered like in cairo_dock_create_surface_from_text_full().
+	int iLogWidth = ceil (fTextWidth);
+	int iOutlineMargin = _get_outline_margin (pAtlas);
+	double fLineWidth = 1;
+	double fZoomX = MIN (1., (iWidth - 2*fLineWidth) / (iLogWidth + iOutlineMargin));  // the width was limited => squeeze the text.
+	int dx = (iWidth - iLogWidth * fZoomX)/2;  // pour se centrer.
+	int dy = (iHeight - iTextHeight)/2;
+	_build_text_quads (cText, pFont, -iWidth/2. + dx, iHeight/2. - dy - pFont->iCharHeight, fZoomX);
+	
+	_draw_quads (pFont->iTexture);
 }
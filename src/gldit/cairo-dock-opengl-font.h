@@ -33,8 +33,10 @@ G_BEGIN_DECLS
 *@file cairo-dock-opengl-font.h This class provides different ways to draw text directly in OpenGL.
 * \ref cairo_dock_create_texture_from_text_simple lets you draw any text in any font, by creating a texture from a Pango font description. This is a convenient function but not very fast.
 * For a more efficient way, you load a font into a CairoDockGLFont with either :
-* \ref cairo_dock_load_textured_font to load a subset of a Mono font into textures.
+* \ref cairo_dock_load_textured_font to load a font into a texture atlas,
+* \ref cairo_dock_load_gl_font_from_text_description to load a font with the colors and outline of a text description.
 * You then use \ref cairo_dock_draw_gl_text_at_position to draw the text.
+* The glyphs are rendered by Pango the first time they are needed and kept in the atlas, so that drawing a text costs no texture upload and only 1 draw call. Each glyph is placed according to its advance, without shaping : use \ref cairo_dock_create_texture_from_text_simple for scripts that need it.
 */
 
 /** Create a texture from a text. The text is drawn in white, so that you can later colorize it with a mere glColor.
@@ -49,7 +51,7 @@ GLuint cairo_dock_create_texture_from_text_simple (const gchar *cText, const gch
 
 /// Structure used to load a font for OpenGL text rendering.
 struct _CairoDockGLFont {
-	GLuint iListBase;
+	GLuint iListBase;  // not used any more.
 	GLuint iTexture;
 	gint iNbRows;
 	gint iNbColumns;
@@ -67,7 +69,7 @@ struct _CairoDockGLFont {
 */
 //CairoDockGLFont *cairo_dock_load_bitmap_font (const gchar *cFontDescription, int first, int count);
 
-/** Load a font into textures. You can then render your text like a normal texture (zoom, etc). The drawback is that only a mono font can be used with this function.
+/** Load a font into a texture atlas. You can then render your text like a normal texture (zoom, etc). The characters are drawn in white, so that you can colorize them with a mere glColor. Any UTF-8 character can be drawn, the other ones are added to the atlas when they're first drawn.
 *@param cFontDescription a description of the font, for instance "Monospace Bold 12"
 *@param first first character to load.
 *@param count number of characters to load.
@@ -75,13 +77,26 @@ struct _CairoDockGLFont {
 */
 CairoDockGLFont *cairo_dock_load_textured_font (const gchar *cFontDescription, int first, int count);
 
+/** Load a font into a texture atlas, with the colors, outline and frame of a text description. The text can then be drawn with \ref cairo_dock_draw_gl_decorated_text, and looks like the one made by \ref cairo_dock_create_surface_from_text_full (markups are not supported).
+*@param pTextDescription a text description
+*@param fScale scale at which the text is rendered, like the fMaxScale of \ref cairo_dock_create_surface_from_text_full.
+*@return a newly allocated opengl font.
+*/
+CairoDockGLFont *cairo_dock_load_gl_font_from_text_description (GldiTextDescription *pTextDescription, double fScale);
+
 /** Like the previous function, but loads the characters from an image. The image must be squared and contain the 256 extended ASCII characters in the alphabetic order.
 *@param cImagePath path to the image.
 *@return a newly allocated opengl font.
 */
 CairoDockGLFont *cairo_dock_load_textured_font_from_image (const gchar *cImagePath);
 
-/** Free an opengl font.
+/** Take a reference on an opengl font, to be released with \ref cairo_dock_free_gl_font.
+*@param pFont the font.
+*@return the font.
+*/
+CairoDockGLFont *cairo_dock_ref_gl_font (CairoDockGLFont *pFont);
+
+/** Free an opengl font, or release a reference on it.
 *@param pFont the font.
 */
 void cairo_dock_free_gl_font (CairoDockGLFont *pFont);
@@ -94,7 +109,7 @@ void cairo_dock_free_gl_font (CairoDockGLFont *pFont);
 */
 void cairo_dock_get_gl_text_extent (const gchar *cText, CairoDockGLFont *pFont, int *iWidth, int *iHeight);
 
-/** Render a text for a given font. In the case of a bitmap font, the current raster position is used. In the case of a texture font, the current model view is used.
+/** Render a text for a given font, at the origin of the current model view.
 *@param cText the text
 *@param pFont the font.
 */
@@ -128,6 +143,23 @@ void cairo_dock_draw_gl_text_in_area (const guchar *cText, CairoDockGLFont *pFon
 */
 void cairo_dock_draw_gl_text_at_position_in_area (const guchar *cText, CairoDockGLFont *pFont, int x, int y, int iWidth, int iHeight, gboolean bCentered);
 
+/** Compute the size of a text drawn with \ref cairo_dock_draw_gl_decorated_text; it's the same as the size given by \ref cairo_dock_create_surface_from_text_full.
+*@param cText the text
+*@param pFont a font loaded with \ref cairo_dock_load_gl_font_from_text_description.
+*@param iMaxWidth maximum width of the text, or 0 to not limit it.
+*@param iWidth a pointer that will be filled with the width of the text.
+*@param iHeight a pointer that will be filled with the height of the text.
+*/
+void cairo_dock_get_gl_decorated_text_extent (const gchar *cText, CairoDockGLFont *pFont, int iMaxWidth, int *iWidth, int *iHeight);
+
+/** Render a text with its frame, centered on the current position. The texture must be enabled beforehand; the current blending and color are used.
+*@param cText the text
+*@param pFont a font loaded with \ref cairo_dock_load_gl_font_from_text_description.
+*@param iWidth width of the text, given by \ref cairo_dock_get_gl_decorated_text_extent.
+*@param iHeight height of the text, given by \ref cairo_dock_get_gl_decorated_text_extent.
+*/
+void cairo_dock_draw_gl_decorated_text (const gchar *cText, CairoDockGLFont *pFont, int iWidth, int iHeight);
+
 
 G_END_DECLS
 #endif
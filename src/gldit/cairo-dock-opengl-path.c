@@ -18,14 +18,18 @@
 */
 
 #include <math.h>
+#include <string.h>  // memcmp
 #include <GL/gl.h>
 
 #include "cairo-dock-struct.h"
 #include "cairo-dock-icon-facility.h"  // cairo_dock_generate_string_path_opengl
 #include "cairo-dock-dock-factory.h"
 #include "cairo-dock-separator-manager.h"
+#include "cairo-dock-opengl.h"  // bVboAvailable
 #include "cairo-dock-opengl-path.h"
 
+extern CairoDockGLConfig g_openglConfig;
+
 #define _CD_PATH_DIM 2
 #define _cd_gl_path_set_nth_vertex_x(pPath, _x, i) pPath->pVertices[_CD_PATH_DIM*(i)] = _x
 #define _cd_gl_path_set_nth_vertex_y(pPath, _y, i) pPath->pVertices[_CD_PATH_DIM*(i)+1] = _y
@@ -55,6 +59,9 @@ void cairo_dock_free_gl_path (CairoDockGLPath *pPath)
 {
 	if (!pPath)
 		return;
+	g_return_if_fail (! pPath->bOwnedByCache);  // a path of the cache is still used by it.
+	if (pPath->iVbo != 0)
+		glDeleteBuffers (1, &pPath->iVbo);
 	g_free (pPath->pVertices);
 	g_free (pPath);
 }
@@ -178,10 +185,27 @@ static inline void _draw_current_path (int iNbPoints, gboolean bClosePath)
 	glDisable (GL_LINE_SMOOTH);
 	glDisable (GL_BLEND);
 }
+static inline void _set_path_vertices (const CairoDockGLPath *pPath)
+{
+	if (pPath->iVbo != 0)  // the vertices are already on the GPU.
+	{
+		glBindBuffer (GL_ARRAY_BUFFER, pPath->iVbo);
+		glVertexPointer (_CD_PATH_DIM, GL_FLOAT, 0, NULL);  // offset in the buffer
+	}
+	else
+		glVertexPointer (_CD_PATH_DIM, GL_FLOAT, 0, pPath->pVertices);
+}
+static inline void _unset_path_vertices (const CairoDockGLPath *pPath)
+{
+	if (pPath->iVbo != 0)
+		glBindBuffer (GL_ARRAY_BUFFER, 0);  // so that the other client arrays are read from the memory again.
+}
+
 void cairo_dock_stroke_gl_path (const CairoDockGLPath *pPath, gboolean bClosePath)
 {
-	glVertexPointer (_CD_PATH_DIM, GL_FLOAT, 0, pPath->pVertices);
+	_set_path_vertices (pPath);
 	_draw_current_path (pPath->iCurrentPt, bClosePath);
+	_unset_path_vertices (pPath);
 }
 
 void cairo_dock_fill_gl_path (const CairoDockGLPath *pPath, GLuint iTexture)
@@ -220,8 +244,9 @@ void cairo_dock_fill_gl_path (const CairoDockGLPath *pPath, GLuint iTexture)
 	
 	//\__________________ On dessine le cadre.
 	glEnableClientState (GL_VERTEX_ARRAY);
-	glVertexPointer (_CD_PATH_DIM, GL_FLOAT, 0, pPath->pVertices);
+	_set_path_vertices (pPath);
 	glDrawArrays (GL_TRIANGLE_FAN, 0, pPath->iCurrentPt);  // GL_POLYGON / GL_TRIANGLE_FAN
+	_unset_path_vertices (pPath);
 	glDisableClientState (GL_VERTEX_ARRAY);
 	
 	//\__________________ On desactive l'antialiasing et la texture.
@@ -240,12 +265,118 @@ void cairo_dock_fill_gl_path (const CairoDockGLPath *pPath, GLuint iTexture)
 }
 
 
+// PATHS CACHE //
+
+// The paths below only depend on a few parameters (size of the dock, radius, position of the icons), which don't change from one frame to the next most of the time. So we keep the last ones, along with their vertices on the GPU, and only compute them again when their parameters change (for instance when a dock is resized).
+// The paths are owned by the cache and given as const to the callers, which must not free nor modify them (freeing one is refused).
+#define CD_GL_PATH_CACHE_SIZE 16
+#define CD_GL_PATH_MAX_PARAMS 5
+
+typedef enum {
+	CD_GL_PATH_RECTANGLE,
+	CD_GL_PATH_TRAPEZE,
+	CD_GL_PATH_STRING
+	} CDGLPathType;
+
+typedef struct {
+	gboolean bValid;
+	CDGLPathType iType;
+	gconstpointer pOwner;  // the dock of a string, NULL otherwise
+	double fParams[CD_GL_PATH_MAX_PARAMS];
+	GLfloat *pPoints;  // the points the path goes through (centers of the icons of a string), NULL otherwise
+	guint iNbPoints;
+	guint iAllocatedPoints;
+	double fExtraWidth;  // of a trapeze
+	guint iLastUse;
+	CairoDockGLPath *pPath;
+	} CDGLPathCacheEntry;
+
+static CDGLPathCacheEntry s_pathCache[CD_GL_PATH_CACHE_SIZE];
+static guint s_iPathCacheClock = 0;
+static CDGLPathCacheEntry s_uncachedPath;  // a path computed each time, that doesn't take a place in the cache.
+
+// get the path matching the given parameters; if there is none, *bNew is set to TRUE and the path has to be computed into the returned entry.
+static CDGLPathCacheEntry *_get_cached_path (CDGLPathType iType, gconstpointer pOwner, const double *fParams, int iNbParams, const GLfloat *pPoints, guint iNbPoints, gboolean *bNew)
+{
+	CDGLPathCacheEntry *pEntry, *pOwnSlot = NULL, *pOldest = NULL;
+	int i;
+	s_iPathCacheClock ++;
+	for (i = 0; i < CD_GL_PATH_CACHE_SIZE; i ++)
+	{
+		pEntry = &s_pathCache[i];
+		if (pEntry->bValid && pEntry->iType == iType && pEntry->pOwner == pOwner
+		&& memcmp (pEntry->fParams, fParams, iNbParams * sizeof (double)) == 0
+		&& pEntry->iNbPoints == iNbPoints
+		&& (iNbPoints == 0 || memcmp (pEntry->pPoints, pPoints, iNbPoints * sizeof (GLfloat)) == 0))
+		{
+			pEntry->iLastUse = s_iPathCacheClock;
+			*bNew = FALSE;
+			return pEntry;
+		}
+		if (pOwner != NULL && pEntry->bValid && pEntry->iType == iType && pEntry->pOwner == pOwner)
+			pOwnSlot = pEntry;
+		if (pOldest == NULL || pEntry->iLastUse < pOldest->iLastUse)
+			pOldest = pEntry;
+	}
+	
+	pEntry = (pOwnSlot != NULL ? pOwnSlot : pOldest);  // a dock has only 1 string, so replace its previous one; else replace the least recently used path.
+	pEntry->bValid = TRUE;
+	pEntry->iType = iType;
+	pEntry->pOwner = pOwner;
+	memcpy (pEntry->fParams, fParams, iNbParams * sizeof (double));
+	if (iNbPoints > pEntry->iAllocatedPoints)
+	{
+		pEntry->pPoints = g_renew (GLfloat, pEntry->pPoints, iNbPoints);
+		pEntry->iAllocatedPoints = iNbPoints;
+	}
+	if (iNbPoints != 0)
+		memcpy (pEntry->pPoints, pPoints, iNbPoints * sizeof (GLfloat));
+	pEntry->iNbPoints = iNbPoints;
+	pEntry->iLastUse = s_iPathCacheClock;
+	*bNew = TRUE;
+	return pEntry;
+}
+
+// rewind the path of an entry, making sure it can hold the given number of vertices.
+static void _reset_cached_path (CDGLPathCacheEntry *pEntry, int iNbVertices, double x0, double y0, int iWidth, int iHeight)
+{
+	if (pEntry->pPath != NULL && pEntry->pPath->iNbPoints < iNbVertices)
+	{
+		pEntry->pPath->bOwnedByCache = FALSE;
+		cairo_dock_free_gl_path (pEntry->pPath);
+		pEntry->pPath = NULL;
+	}
+	if (pEntry->pPath == NULL)
+	{
+		pEntry->pPath = cairo_dock_new_gl_path (iNbVertices, x0, y0, iWidth, iHeight);
+		pEntry->pPath->bOwnedByCache = TRUE;
+	}
+	else
+	{
+		cairo_dock_gl_path_move_to (pEntry->pPath, x0, y0);
+		cairo_dock_gl_path_set_extent (pEntry->pPath, iWidth, iHeight);
+	}
+}
+
+// send the vertices of a newly computed path to the GPU, so that they're not sent again each time it's drawn.
+static void _upload_cached_path (CDGLPathCacheEntry *pEntry)
+{
+	CairoDockGLPath *pPath = pEntry->pPath;
+	if (! g_openglConfig.bVboAvailable)
+		return;
+	if (pPath->iVbo == 0)
+		glGenBuffers (1, &pPath->iVbo);
+	glBindBuffer (GL_ARRAY_BUFFER, pPath->iVbo);
+	glBufferData (GL_ARRAY_BUFFER, pPath->iCurrentPt * _CD_PATH_DIM * sizeof (GLfloat), pPath->pVertices, GL_STATIC_DRAW);
+	glBindBuffer (GL_ARRAY_BUFFER, 0);
+}
+
+
 // HELPER FUNCTIONS //
 
 #define DELTA_ROUND_DEGREE 3
-const CairoDockGLPath *cairo_dock_generate_rectangle_path (double fFrameWidth, double fTotalHeight, double fRadius, gboolean bRoundedBottomCorner)
+static void _compute_rectangle_path (CDGLPathCacheEntry *pEntry, double fFrameWidth, double fTotalHeight, double fRadius, gboolean bRoundedBottomCorner)
 {
-	static CairoDockGLPath *pPath = NULL;
 	double fTotalWidth = fFrameWidth + 2 * fRadius;
 	double fFrameHeight = MAX (0, fTotalHeight - 2 * fRadius);
 	double w = fFrameWidth / 2;
@@ -253,17 +384,9 @@ const CairoDockGLPath *cairo_dock_generate_rectangle_path (double fFrameWidth, d
 	double r = fRadius;
 	
 	int iNbPoins1Round = 90/10;
-	if (pPath == NULL)
-	{
-		pPath = cairo_dock_new_gl_path ((iNbPoins1Round+1)*4+1, w+r, h, fTotalWidth, fTotalHeight);  // on commence au centre droit pour avoir une bonne triangulation du polygone, et en raisonnant par rapport au centre du rectangle.
-		///pPath = cairo_dock_new_gl_path ((iNbPoins1Round+1)*4+1, 0, 0, fTotalWidth, fTotalHeight);  // on commence au centre pour avoir une bonne triangulation
-	}
-	else
-	{
-		cairo_dock_gl_path_move_to (pPath, w+r, h);
-		///cairo_dock_gl_path_move_to (pPath, 0, 0);
-		cairo_dock_gl_path_set_extent (pPath, fTotalWidth, fTotalHeight);
-	}
+	_reset_cached_path (pEntry, (iNbPoins1Round+1)*4+1, w+r, h, fTotalWidth, fTotalHeight);  // on commence au centre droit pour avoir une bonne triangulation du polygone, et en raisonnant par rapport au centre du rectangle.
+	///pPath = cairo_dock_new_gl_path ((iNbPoins1Round+1)*4+1, 0, 0, fTotalWidth, fTotalHeight);  // on commence au centre pour avoir une bonne triangulation
+	CairoDockGLPath *pPath = pEntry->pPath;
 	//cairo_dock_gl_path_move_to (pPath, 0., h+r);
 	//cairo_dock_gl_path_rel_line_to (pPath, -w, 0.);
 	
@@ -283,14 +406,38 @@ const CairoDockGLPath *cairo_dock_generate_rectangle_path (double fFrameWidth, d
 		cairo_dock_gl_path_rel_line_to (pPath, fTotalWidth, 0.);
 	}
 	//cairo_dock_gl_path_arc (pPath, iNbPoins1Round, w, h, r, 0.,     +G_PI/2);  // coin haut droit.
-	
-	return pPath;
+}
+
+const CairoDockGLPath *cairo_dock_generate_rectangle_path (double fFrameWidth, double fTotalHeight, double fRadius, gboolean bRoundedBottomCorner)
+{
+	double fParams[4] = {fFrameWidth, fTotalHeight, fRadius, bRoundedBottomCorner};
+	gboolean bNew;
+	CDGLPathCacheEntry *pEntry = _get_cached_path (CD_GL_PATH_RECTANGLE, NULL, fParams, 4, NULL, 0, &bNew);
+	if (bNew)
+	{
+		_compute_rectangle_path (pEntry, fFrameWidth, fTotalHeight, fRadius, bRoundedBottomCorner);
+		_upload_cached_path (pEntry);
+	}
+	return pEntry->pPath;
+}
+
+const CairoDockGLPath *cairo_dock_generate_uncached_rectangle_path (double fFrameWidth, double fTotalHeight, double fRadius, gboolean bRoundedBottomCorner)
+{
+	_compute_rectangle_path (&s_uncachedPath, fFrameWidth, fTotalHeight, fRadius, bRoundedBottomCorner);  // drawn once, so not sent to the GPU (its VBO stays 0).
+	return s_uncachedPath.pPath;
 }
 
 
 const CairoDockGLPath *cairo_dock_generate_trapeze_path (double fUpperFrameWidth, double fTotalHeight, double fRadius, gboolean bRoundedBottomCorner, double fInclination, double *fExtraWidth)
 {
-	static CairoDockGLPath *pPath = NULL;
+	double fParams[5] = {fUpperFrameWidth, fTotalHeight, fRadius, bRoundedBottomCorner, fInclination};
+	gboolean bNew;
+	CDGLPathCacheEntry *pEntry = _get_cached_path (CD_GL_PATH_TRAPEZE, NULL, fParams, 5, NULL, 0, &bNew);
+	if (! bNew)
+	{
+		*fExtraWidth = pEntry->fExtraWidth;
+		return pEntry->pPath;
+	}
 	
 	double a = atan (fInclination);  // /|
 	double cosa = 1. / sqrt (1 + fInclination * fInclination);
@@ -307,13 +454,9 @@ const CairoDockGLPath *cairo_dock_generate_trapeze_path (double fUpperFrameWidth
 	
 	int iNbPoins1Round = 70/DELTA_ROUND_DEGREE;  // pour une inclinaison classique (~30deg), les coins du haut feront moins d'1/4 de tour.
 	int iNbPoins1Curve = 10;
-	if (pPath == NULL)
-		pPath = cairo_dock_new_gl_path ((iNbPoins1Round+1)*2 + (iNbPoins1Curve+1)*2 + 1, 0., fTotalHeight/2, fTotalWidth, fTotalHeight);
-	else
-	{
-		cairo_dock_gl_path_move_to (pPath, 0., fTotalHeight/2);
-		cairo_dock_gl_path_set_extent (pPath, fTotalWidth, fTotalHeight);
-	}
+	_reset_cached_path (pEntry, (iNbPoins1Round+1)*2 + (iNbPoins1Curve+1)*2 + 1, 0., fTotalHeight/2, fTotalWidth, fTotalHeight);
+	CairoDockGLPath *pPath = pEntry->pPath;
+	pEntry->fExtraWidth = *fExtraWidth;
 	cairo_dock_gl_path_arc (pPath, iNbPoins1Round, -w, h, r, G_PI/2, G_PI/2 - a);  // coin haut gauche. 90 -> 180-a
 	
 	if (bRoundedBottomCorner)
@@ -349,6 +492,7 @@ const CairoDockGLPath *cairo_dock_generate_trapeze_path (double fUpperFrameWidth
 	
 	cairo_dock_gl_path_arc (pPath, iNbPoins1Round, w, h, r, a, G_PI/2 - a);  // coin haut droit. a -> 90
 	
+	_upload_cached_path (pEntry);
 	return pPath;
 }
 
@@ -371,10 +515,6 @@ const CairoDockGLPath *cairo_dock_generate_trapeze_path (double fUpperFrameWidth
 #define NB_VERTEX_PER_ICON_PAIR 10
 const CairoDockGLPath *cairo_dock_generate_string_path_opengl (CairoDock *pDock, gboolean bIsLoop, gboolean bForceConstantSeparator)
 {
-	static CairoDockGLPath *pPath = NULL;
-	if (pPath == NULL)
-		pPath = cairo_dock_new_gl_path (100*NB_VERTEX_PER_ICON_PAIR + 1, 0., 0., 0., 0.);
-	
 	GList *ic, *next_ic, *next2_ic, *pFirstDrawnElement = pDock->icons;
 	Icon *pIcon, *pNextIcon, *pNext2Icon;
 	double x0,y0, x1,y1, x2,y2;  // centres des icones P0, P1, P2, en coordonnees opengl.
@@ -382,8 +522,32 @@ const CairoDockGLPath *cairo_dock_generate_string_path_opengl (CairoDock *pDock,
 	double dx, dy;  // direction au niveau de l'icone courante P0.
 	double dx_, dy_;  // direction au niveau de l'icone suivante P1.
 	double x0_,y0_, x1_,y1_;  // points de controle entre P0 et P1.
+	
+	// the string only depends on the centers of the icons, so only compute it again if one of them has moved.
+	static GArray *pCenters = NULL;
+	if (pCenters == NULL)
+		pCenters = g_array_new (FALSE, FALSE, sizeof (GLfloat));
+	g_array_set_size (pCenters, 0);
+	GLfloat c[2];
+	for (ic = pFirstDrawnElement; ic != NULL; ic = ic->next)
+	{
+		pIcon = ic->data;
+		_get_icon_center (pIcon,x0,y0);
+		c[0] = x0;
+		c[1] = y0;
+		g_array_append_vals (pCenters, c, 2);
+	}
+	double fParams[4] = {bIsLoop, pDock->container.bIsHorizontal, pDock->container.iWidth, pDock->container.iHeight};
+	gboolean bNew;
+	CDGLPathCacheEntry *pEntry = _get_cached_path (CD_GL_PATH_STRING, pDock, fParams, 4, (GLfloat*)pCenters->data, pCenters->len, &bNew);
+	if (! bNew)
+		return pEntry->pPath;
+	
+	_reset_cached_path (pEntry, MAX (pCenters->len/2, 100) * NB_VERTEX_PER_ICON_PAIR + 1, 0., 0., 0., 0.);
+	CairoDockGLPath *pPath = pEntry->pPath;
 	if (pFirstDrawnElement == NULL)
 	{
+		_upload_cached_path (pEntry);
 		return pPath;
 	}
 	
@@ -455,6 +619,7 @@ const CairoDockGLPath *cairo_dock_generate_string_path_opengl (CairoDock *pDock,
 	}
 	while (ic != pFirstDrawnElement);
 	
+	_upload_cached_path (pEntry);
 	return pPath;
 }
 
@@ -35,6 +35,8 @@ struct _CairoDockGLPath {
 	GLfloat *pVertices;
 	int iCurrentPt;
 	int iWidth, iHeight;
+	GLuint iVbo;  // buffer holding a copy of the vertices on the GPU, or 0; only set on the paths returned by the cairo_dock_generate_xxx_path functions.
+	gboolean bOwnedByCache;  // TRUE for the paths returned by the cairo_dock_generate_xxx_path functions, which must not be freed.
 	};
 
 /** Create a new path. It will start at the point (x0, y0). If you want to be abe to fill it with a texture, you can specify here the dimension of the path's husk.
@@ -148,10 +150,30 @@ void cairo_dock_stroke_gl_path (const CairoDockGLPath *pPath, gboolean bClosePat
 void cairo_dock_fill_gl_path (const CairoDockGLPath *pPath, GLuint iTexture);
 
 
+/** Get the path of a rectangle with rounded corners, centered on the origin. The last paths are kept along with their vertices on the GPU, so calling this function each frame with the same parameters costs nearly nothing. The path belongs to the cache: it must not be freed nor modified, and is only valid until the next call to one of the cairo_dock_generate_xxx_path functions.
+*@param fFrameWidth width of the rectangle, without the corners.
+*@param fTotalHeight height of the rectangle, including the corners.
+*@param fRadius radius of the corners (can be 0).
+*@param bRoundedBottomCorner whether the bottom corners are rounded too.
+*@return the path.
+*/
 const CairoDockGLPath *cairo_dock_generate_rectangle_path (double fFrameWidth, double fTotalHeight, double fRadius, gboolean bRoundedBottomCorner);
 
+/** Like \ref cairo_dock_generate_rectangle_path, but the path is not kept in the cache, so that it doesn't evict the other paths. Use it for a rectangle whose size changes often (like a progress bar). The path must not be freed nor modified either, and is only valid until the next call to this function.
+*@param fFrameWidth width of the rectangle, without the corners.
+*@param fTotalHeight height of the rectangle, including the corners.
+*@param fRadius radius of the corners (can be 0).
+*@param bRoundedBottomCorner whether the bottom corners are rounded too.
+*@return the path.
+*/
+const CairoDockGLPath *cairo_dock_generate_uncached_rectangle_path (double fFrameWidth, double fTotalHeight, double fRadius, gboolean bRoundedBottomCorner);
+
+/** Get the path of the frame of a dock, whose sides are inclined. Like \ref cairo_dock_generate_rectangle_path, the path belongs to the cache.
+*/
 const CairoDockGLPath *cairo_dock_generate_trapeze_path (double fUpperFrameWidth, double fTotalHeight, double fRadius, gboolean bRoundedBottomCorner, double fInclination, double *fExtraWidth);
 
+/** Get the path going through the icons of a dock. Like \ref cairo_dock_generate_rectangle_path, the path belongs to the cache; a dock has only 1 path in it.
+*/
 const CairoDockGLPath *cairo_dock_generate_string_path_opengl (CairoDock *pDock, gboolean bIsLoop, gboolean bForceConstantSeparator);
 
 void cairo_dock_draw_current_path_opengl (double fLineWidth, double *fLineColor, int iNbVertex);
@@ -48,6 +48,7 @@ struct _CairoDockGLConfig {
 	void (*bindTexImage) (EGLDisplay *display, EGLSurface drawable, int buffer);  // texture from pixmap
 	void (*releaseTexImage) (EGLDisplay *display, EGLSurface drawable, int buffer);  // texture from pixmap
 	#endif
+	gboolean bVboAvailable;
 };
 
 struct _GldiGLManagerBackend {
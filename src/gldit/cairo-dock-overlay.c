@@ -26,6 +26,7 @@
 #include "cairo-dock-icon-facility.h"
 #include "cairo-dock-draw.h"
 #include "cairo-dock-draw-opengl.h"
+#include "cairo-dock-opengl-font.h"  // cairo_dock_draw_gl_decorated_text
 #include "cairo-dock-image-buffer.h"
 #include "cairo-dock-log.h"
 #define _MANAGER_DEF_
@@ -118,6 +119,34 @@ CairoOverlay *cairo_dock_add_overlay_from_texture (Icon *pIcon, GLuint iTexture,
 	return gldi_overlay_new (&attr);
 }
 
+CairoOverlay *cairo_dock_add_overlay_from_text (Icon *pIcon, const gchar *cText, GldiTextDescription *pTextDescription, double fMaxScale, int iMaxWidth, CairoOverlayPosition iPosition, gpointer data)
+{
+	CairoOverlayAttr attr;
+	memset (&attr, 0, sizeof (CairoOverlayAttr));
+	attr.iPosition = iPosition;
+	attr.pIcon = pIcon;
+	attr.data = data;
+	attr.cText = cText;
+	attr.pTextDescription = pTextDescription;
+	attr.fMaxScale = fMaxScale;
+	attr.iMaxWidth = iMaxWidth;
+	return gldi_overlay_new (&attr);
+}
+
+CairoOverlay *cairo_dock_add_overlay_from_gl_text (Icon *pIcon, const gchar *cText, CairoDockGLFont *pFont, int iWidth, int iHeight, CairoOverlayPosition iPosition, gpointer data)
+{
+	CairoOverlayAttr attr;
+	memset (&attr, 0, sizeof (CairoOverlayAttr));
+	attr.iPosition = iPosition;
+	attr.pIcon = pIcon;
+	attr.data = data;
+	attr.cText = cText;
+	attr.pFont = pFont;
+	attr.iWidth = iWidth;
+	attr.iHeight = iHeight;
+	return gldi_overlay_new (&attr);
+}
+
 
 void cairo_dock_remove_overlay_at_position (Icon *pIcon, CairoOverlayPosition iPosition, gpointer data)
 {
@@ -276,7 +305,7 @@ void cairo_dock_draw_icon_overlays_opengl (Icon *pIcon, double fRatio)
 	for (ov = pIcon->pOverlays; ov != NULL; ov = ov->next)
 	{
 		p = ov->data;
-		if (! p->image.iTexture)
+		if (! p->image.iTexture && ! p->cText)
 			continue;
 		glPushMatrix ();
 		
@@ -298,7 +327,13 @@ void cairo_dock_draw_icon_overlays_opengl (Icon *pIcon, double fRatio)
 		glTranslatef (x, y, 0.);
 		
 		// draw.
-		_cairo_dock_apply_texture_at_size (p->image.iTexture, wo, ho);
+		if (p->cText)
+		{
+			glScalef ((double) wo / p->image.iWidth, (double) ho / p->image.iHeight, 1.);
+			cairo_dock_draw_gl_decorated_text (p->cText, p->pFont, p->image.iWidth, p->image.iHeight);
+		}
+		else
+			_cairo_dock_apply_texture_at_size (p->image.iTexture, wo, ho);
 		
 		glPopMatrix ();
 	}
@@ -349,6 +384,7 @@ static void cairo_dock_print_overlay_on_icon (Icon *pIcon, CairoOverlay *pOverla
 	}
 	else if (pIcon->image.pSurface != NULL && pOverlay->image.pSurface != NULL)
 	{
+		cairo_dock_image_buffer_make_private (&pIcon->image);
 		cairo_t *pCairoContext = cairo_create (pIcon->image.pSurface);
 		g_return_if_fail (cairo_status (pCairoContext) == CAIRO_STATUS_SUCCESS);
 		
@@ -428,6 +464,17 @@ static void init_object (GldiObject *obj, gpointer attr)
 	{
 		cairo_dock_load_image_buffer_from_texture (&pOverlay->image, cattr->iTexture, 1, 1);  // size will be used to draw it if the scale is set to 0.
 	}
+	else if (cattr->cText != NULL && cattr->pFont != NULL)
+	{
+		pOverlay->cText = g_strdup (cattr->cText);
+		pOverlay->pFont = cairo_dock_ref_gl_font (cattr->pFont);
+		pOverlay->image.iWidth = cattr->iWidth;  // no surface nor texture, only the size.
+		pOverlay->image.iHeight = cattr->iHeight;
+	}
+	else if (cattr->cText != NULL && cattr->pTextDescription != NULL)
+	{
+		cairo_dock_load_image_buffer_from_text (&pOverlay->image, cattr->cText, cattr->pTextDescription, cattr->fMaxScale, cattr->iMaxWidth);  // the image may be shared with other overlays.
+	}
 	
 	if (cattr->data != NULL)
 	{
@@ -448,6 +495,8 @@ static void reset_object (GldiObject *obj)
 	
 	// free data
 	cairo_dock_unload_image_buffer (&pOverlay->image);
+	g_free (pOverlay->cText);
+	cairo_dock_free_gl_font (pOverlay->pFont);
 }
 
 void gldi_register_overlays_manager (void)
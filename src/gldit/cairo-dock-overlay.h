@@ -69,6 +69,11 @@ struct _CairoOverlayAttr {
 	cairo_surface_t *pSurface;
 	int iWidth, iHeight;
 	GLuint iTexture;
+	const gchar *cText;
+	CairoDockGLFont *pFont;
+	GldiTextDescription *pTextDescription;
+	gdouble fMaxScale;
+	int iMaxWidth;
 };
 
 // signals
@@ -91,6 +96,10 @@ struct _CairoOverlay {
 	Icon *pIcon;
 	/// data used to identify an overlay
 	gpointer data;
+	/// text drawn directly in OpenGL instead of the image buffer, or NULL.
+	gchar *cText;
+	/// font the text is drawn with.
+	CairoDockGLFont *pFont;
 } ;
 
 
@@ -127,6 +136,30 @@ CairoOverlay *cairo_dock_add_overlay_from_surface (Icon *pIcon, cairo_surface_t
  */
 CairoOverlay *cairo_dock_add_overlay_from_texture (Icon *pIcon, GLuint iTexture, CairoOverlayPosition iPosition, gpointer data);
 
+/** Add an overlay on an icon from a text. The image of the text is taken from the cache of texts if it has been rendered recently (see \ref cairo_dock_load_image_buffer_from_text).
+ *@param pIcon the icon
+ *@param cText the text
+ *@param pTextDescription description of the text
+ *@param fMaxScale maximum zoom of the text
+ *@param iMaxWidth maximum width of the text, or 0 to not limit it
+ *@param iPosition position where to display the overlay
+ *@param data data that will be used to look for the overlay in \ref cairo_dock_remove_overlay_at_position; if NULL, then this function can't be used
+ *@return the overlay.
+ */
+CairoOverlay *cairo_dock_add_overlay_from_text (Icon *pIcon, const gchar *cText, GldiTextDescription *pTextDescription, double fMaxScale, int iMaxWidth, CairoOverlayPosition iPosition, gpointer data);
+
+/** Add an overlay on an icon from a text, that will be drawn directly in OpenGL with a font; this way, changing the text doesn't need to create a new texture. Only works in OpenGL.
+ *@param pIcon the icon
+ *@param cText the text
+ *@param pFont a font loaded with \ref cairo_dock_load_gl_font_from_text_description; the overlay takes a reference on it.
+ *@param iWidth width of the text, given by \ref cairo_dock_get_gl_decorated_text_extent
+ *@param iHeight height of the text, given by \ref cairo_dock_get_gl_decorated_text_extent
+ *@param iPosition position where to display the overlay
+ *@param data data that will be used to look for the overlay in \ref cairo_dock_remove_overlay_at_position; if NULL, then this function can't be used
+ *@return the overlay.
+ */
+CairoOverlay *cairo_dock_add_overlay_from_gl_text (Icon *pIcon, const gchar *cText, CairoDockGLFont *pFont, int iWidth, int iHeight, CairoOverlayPosition iPosition, gpointer data);
+
 
 /** Set the scale of an overlay; by default it's 0.5
  *@param pOverlay the overlay
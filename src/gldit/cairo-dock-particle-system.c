@@ -23,138 +23,143 @@
 #include <cairo.h>
 
 #include "cairo-dock-draw-opengl.h"
+#include "cairo-dock-opengl.h"  // bVboAvailable
 #include "cairo-dock-particle-system.h"
 
+extern CairoDockGLConfig g_openglConfig;
+
 static GLfloat s_pCornerCoords[8] = {0.0, 0.0,
 	0.0, 1.0,
 	1.0, 1.0,
 	1.0, 0.0};
 
-void cairo_dock_render_particles_full (CairoParticleSystem *pParticleSystem, int iDepth)
+static inline void _set_particle_vertices (GLfloat *vertices, GLfloat x, GLfloat y, GLfloat z, GLfloat w, GLfloat h)
+{
+	vertices[0] = x - w;
+	vertices[1] = y + h;
+	vertices[2] = z;
+	vertices[3] = x - w;
+	vertices[4] = y - h;
+	vertices[5] = z;
+	vertices[6] = x + w;
+	vertices[7] = y - h;
+	vertices[8] = z;
+	vertices[9] = x + w;
+	vertices[10] = y + h;
+	vertices[11] = z;
+}
+
+static inline void _set_particle_colors (GLfloat *colors, GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+	int i;
+	for (i = 0; i < 4; i ++, colors += 4)
+	{
+		colors[0] = r;
+		colors[1] = g;
+		colors[2] = b;
+		colors[3] = a;
+	}
+}
+
+static int _fill_particles_arrays (CairoParticleSystem *pParticleSystem, int iDepth)  // returns the number of vertices to draw.
 {
-	_cairo_dock_enable_texture ();
-	
-	if (pParticleSystem->bAddLuminance)
-		_cairo_dock_set_blend_over ();
-		//glBlendFunc (GL_SRC_ALPHA, GL_ONE);
-	else
-		_cairo_dock_set_blend_alpha ();
-	
-	glBindTexture(GL_TEXTURE_2D, pParticleSystem->iTexture);
-	
 	GLfloat *vertices = pParticleSystem->pVertices;
-	///GLfloat *coords = pParticleSystem->pCoords;
 	GLfloat *colors = pParticleSystem->pColors;
 	GLfloat *vertices2 = &pParticleSystem->pVertices[pParticleSystem->iNbParticles * 4 * 3];
-	///GLfloat *coords2 = &pParticleSystem->pCoords[pParticleSystem->iNbParticles * 4 * 2];
 	GLfloat *colors2 = &pParticleSystem->pColors[pParticleSystem->iNbParticles * 4 * 4];
 	
-	GLfloat x,y,z;
-	GLfloat w, h;
-	GLfloat fHeight = pParticleSystem->fHeight;
+	// y goes from the bottom or from the top of the system.
+	GLfloat fScaleX = pParticleSystem->fWidth / 2;
+	GLfloat fOffsetY = (pParticleSystem->bDirectionUp ? 0. : pParticleSystem->fHeight);
+	GLfloat fScaleY = (pParticleSystem->bDirectionUp ? pParticleSystem->fHeight : - pParticleSystem->fHeight);
+	gboolean bAddLight = pParticleSystem->bAddLight;
 	
-	int numActive = 0;
+	GLfloat x, y, w, h;
 	CairoParticle *p;
-	int i;
+	int i, n = 0;  // n = number of particles drawn; they are packed at the beginning of the arrays.
 	for (i = 0; i < pParticleSystem->iNbParticles; i ++)
 	{
 		p = &pParticleSystem->pParticles[i];
 		if (p->iLife == 0 || iDepth * p->z < 0)
 			continue;
 		
-		numActive += 4;
 		w = p->fWidth * p->fSizeFactor;
 		h = p->fHeight * p->fSizeFactor;
-		x = p->x * pParticleSystem->fWidth / 2;
-		y = p->y * pParticleSystem->fHeight;
-		z = p->z;
-		
-		vertices[0] = x - w;
-		vertices[2] = z;
-		vertices[3] = x - w;
-		vertices[5] = z;
-		vertices[6] = x + w;
-		vertices[8] = z;
-		vertices[9] = x + w;
-		vertices[11] = z;
-		if (pParticleSystem->bDirectionUp)
-		{
-			vertices[1] = y + h;
-			vertices[4] = y - h;
-			vertices[7] = y - h;
-			vertices[10] = y + h;
-		}
-		else
-		{
-			vertices[1] = fHeight - y + h;
-			vertices[4] = fHeight - y - h;
-			vertices[7] = fHeight - y - h;
-			vertices[10] = fHeight - y + h;
-		}
-		vertices += 12;
-		
-		///memcpy (coords, s_pCornerCoords, sizeof (s_pCornerCoords));
-		///coords += 8;
-
-		colors[0] = p->color[0];
-		colors[1] = p->color[1];
-		colors[2] = p->color[2];
-		colors[3] = p->color[3];
-		memcpy (colors + 4, colors, 4*sizeof (GLfloat));
-		memcpy (colors + 8, colors, 8*sizeof (GLfloat));
-		colors += 16;
+		x = p->x * fScaleX;
+		y = fOffsetY + p->y * fScaleY;
+		_set_particle_vertices (vertices + 12*n, x, y, p->z, w, h);
+		_set_particle_colors (colors + 16*n, p->color[0], p->color[1], p->color[2], p->color[3]);
 		
-		if (pParticleSystem->bAddLight)
+		if (bAddLight)  // a smaller white halo on top of the particle.
 		{
-			w/=1.6;
-			h/=1.6;
-			vertices2[0] = x - w;
-			vertices2[2] = z;
-			vertices2[3] = x - w;
-			vertices2[5] = z;
-			vertices2[6] = x + w;
-			vertices2[8] = z;
-			vertices2[9] = x + w;
-			vertices2[11] = z;
-			if (pParticleSystem->bDirectionUp)
-			{
-				vertices2[1] = y + h;
-				vertices2[4] = y - h;
-				vertices2[7] = y - h;
-				vertices2[10] = y + h;
-			}
-			else
-			{
-				vertices2[1] = fHeight - y + h;
-				vertices2[4] = fHeight - y - h;
-				vertices2[7] = fHeight - y - h;
-				vertices2[10] = fHeight - y + h;
-			}
-			vertices2 += 12;
-			
-			///memcpy (coords2, s_pCornerCoords, sizeof (s_pCornerCoords));
-			///coords2 += 8;
-			
-			colors2[0] = 1;
-			colors2[1] = 1;
-			colors2[2] = 1;
-			colors2[3] = colors[3];
-			memcpy (colors2 + 4, colors2, 4*sizeof (GLfloat));
-			memcpy (colors2 + 8, colors2, 8*sizeof (GLfloat));
-			colors2 += 16;
+			_set_particle_vertices (vertices2 + 12*n, x, y, p->z, w * .625, h * .625);  // 1/1.6
+			_set_particle_colors (colors2 + 16*n, 1., 1., 1., p->color[3]);
 		}
+		n ++;
 	}
 	
+	if (bAddLight && n < pParticleSystem->iNbParticles)  // move the halos right after the particles, so that they're all drawn at once.
+	{
+		memmove (vertices + 12*n, vertices2, 12*n*sizeof (GLfloat));
+		memmove (colors + 16*n, colors2, 16*n*sizeof (GLfloat));
+	}
+	return (bAddLight ? 8*n : 4*n);
+}
+
+void cairo_dock_render_particles_full (CairoParticleSystem *pParticleSystem, int iDepth)
+{
+	int iNbVertices = _fill_particles_arrays (pParticleSystem, iDepth);
+	if (iNbVertices == 0)
+		return;
+	
+	_cairo_dock_enable_texture ();
+	
+	if (pParticleSystem->bAddLuminance)
+		_cairo_dock_set_blend_over ();
+		//glBlendFunc (GL_SRC_ALPHA, GL_ONE);
+	else
+		_cairo_dock_set_blend_alpha ();
+	
+	glBindTexture(GL_TEXTURE_2D, pParticleSystem->iTexture);
+	
 	glEnableClientState(GL_COLOR_ARRAY);
 	glEnableClientState (GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState (GL_VERTEX_ARRAY);
 	
-	glTexCoordPointer(2, GL_FLOAT, 2 * sizeof(GLfloat), pParticleSystem->pCoords);
-	glVertexPointer(3, GL_FLOAT, 3 * sizeof(GLfloat), pParticleSystem->pVertices);
-	glColorPointer(4, GL_FLOAT, 4 * sizeof(GLfloat), pParticleSystem->pColors);
-
-	glDrawArrays(GL_QUADS, 0, pParticleSystem->bAddLight ? numActive*2 : numActive);
-
+	if (g_openglConfig.bVboAvailable)
+	{
+		if (pParticleSystem->iBuffer == 0)  // the texture coordinates never change, upload them once.
+		{
+			glGenBuffers (1, &pParticleSystem->iCoordsBuffer);
+			glBindBuffer (GL_ARRAY_BUFFER, pParticleSystem->iCoordsBuffer);
+			glBufferData (GL_ARRAY_BUFFER, pParticleSystem->iNbParticles * 4 * 2 * sizeof(GLfloat)*2, pParticleSystem->pCoords, GL_STATIC_DRAW);
+			glGenBuffers (1, &pParticleSystem->iBuffer);
+		}
+		glBindBuffer (GL_ARRAY_BUFFER, pParticleSystem->iCoordsBuffer);
+		glTexCoordPointer(2, GL_FLOAT, 2 * sizeof(GLfloat), NULL);
+		
+		// vertices and colors go into the same buffer, in 1 upload.
+		GLsizeiptr iVerticesSize = iNbVertices * 3 * sizeof(GLfloat);
+		GLsizeiptr iColorsSize = iNbVertices * 4 * sizeof(GLfloat);
+		glBindBuffer (GL_ARRAY_BUFFER, pParticleSystem->iBuffer);
+		glBufferData (GL_ARRAY_BUFFER, iVerticesSize + iColorsSize, NULL, GL_STREAM_DRAW);  // drop the previous content, so that we don't wait for the GPU to be done with it.
+		glBufferSubData (GL_ARRAY_BUFFER, 0, iVerticesSize, pParticleSystem->pVertices);
+		glBufferSubData (GL_ARRAY_BUFFER, iVerticesSize, iColorsSize, pParticleSystem->pColors);
+		glVertexPointer(3, GL_FLOAT, 3 * sizeof(GLfloat), NULL);
+		glColorPointer(4, GL_FLOAT, 4 * sizeof(GLfloat), (GLvoid*) iVerticesSize);  // offset in the buffer
+	}
+	else
+	{
+		glTexCoordPointer(2, GL_FLOAT, 2 * sizeof(GLfloat), pParticleSystem->pCoords);
+		glVertexPointer(3, GL_FLOAT, 3 * sizeof(GLfloat), pParticleSystem->pVertices);
+		glColorPointer(4, GL_FLOAT, 4 * sizeof(GLfloat), pParticleSystem->pColors);
+	}
+	
+	glDrawArrays(GL_QUADS, 0, iNbVertices);
+	
+	if (g_openglConfig.bVboAvailable)
+		glBindBuffer (GL_ARRAY_BUFFER, 0);  // so that the other client arrays are read from the memory again.
+	
 	glDisableClientState(GL_COLOR_ARRAY);
 	glDisableClientState (GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState (GL_VERTEX_ARRAY);
@@ -200,6 +205,12 @@ void cairo_dock_free_particle_system (CairoParticleSystem *pParticleSystem)
 	
 	g_free (pParticleSystem->pParticles);
 	
+	if (pParticleSystem->iBuffer != 0)
+	{
+		glDeleteBuffers (1, &pParticleSystem->iBuffer);
+		glDeleteBuffers (1, &pParticleSystem->iCoordsBuffer);
+	}
+	
 	free (pParticleSystem->pVertices);
 	free (pParticleSystem->pCoords);
 	free (pParticleSystem->pColors);
@@ -74,6 +74,8 @@ typedef struct _CairoParticleSystem {
 	gboolean bDirectionUp;
 	gboolean bAddLuminance;
 	gboolean bAddLight;
+	GLuint iBuffer;  // vertices and colors, uploaded at each frame.
+	GLuint iCoordsBuffer;  // texture coordinates, uploaded once.
 	} CairoParticleSystem;
 
 /// Function that re-initializes a particle when its life is over.
@@ -428,6 +428,8 @@ typedef struct _CairoIconContainerRenderer CairoIconContainerRenderer;
 
 typedef struct _CairoDockTransition CairoDockTransition;
 
+typedef struct _CairoDockWaveStats CairoDockWaveStats;
+
 typedef struct _CairoDockPackage CairoDockPackage;
 
 typedef struct _CairoDockGroupKeyWidget CairoDockGroupKeyWidget;
@@ -440,6 +442,9 @@ typedef struct _CairoDockGLPath CairoDockGLPath;
 
 typedef struct _CairoDockImageBuffer CairoDockImageBuffer;
 
+typedef struct _CairoDockSharedImagesStats CairoDockSharedImagesStats;
+typedef struct _CairoDockTextCacheStats CairoDockTextCacheStats;
+
 typedef struct _CairoOverlay CairoOverlay;
 
 typedef struct _GldiTask GldiTask;
@@ -20,6 +20,9 @@
 #include <string.h>
 #include <math.h>
 #include <pango/pango.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "cairo-dock-log.h"
 #include "cairo-dock-draw.h"
@@ -30,6 +33,8 @@
 #include "cairo-dock-icon-manager.h"  // cairo_dock_search_icon_s_path
 #include "cairo-dock-dialog-manager.h"
 #include "cairo-dock-style-manager.h"
+#include "cairo-dock-task.h"
+#include "cairo-dock-image-cache.h"
 #include "cairo-dock-surface-factory.h"
 
 extern GldiContainer *g_pPrimaryContainer;
@@ -186,10 +191,10 @@ static inline cairo_t *_get_source_context (void)
 	return pSourceContext;  // Note: we can't keep the context alive and reuse it later, because under Wayland it will make the container invisible
 }
 
-cairo_surface_t *cairo_dock_create_blank_surface (int iWidth, int iHeight)
+static cairo_surface_t *_create_blank_surface (int iWidth, int iHeight, gboolean bImageSurface)  // an image surface can be made outside of the main thread.
 {
 	cairo_t *pSourceContext = NULL;
-	if (! g_bUseOpenGL)
+	if (! g_bUseOpenGL && ! bImageSurface)
 		pSourceContext = _get_source_context ();
 	cairo_surface_t *pSurface;
 	if (pSourceContext != NULL && cairo_status (pSourceContext) == CAIRO_STATUS_SUCCESS)
@@ -204,6 +209,10 @@ cairo_surface_t *cairo_dock_create_blank_surface (int iWidth, int iHeight)
 	cairo_destroy (pSourceContext);
 	return pSurface;
 }
+cairo_surface_t *cairo_dock_create_blank_surface (int iWidth, int iHeight)
+{
+	return _create_blank_surface (iWidth, iHeight, FALSE);
+}
 
 static inline void _apply_orientation_and_scale (cairo_t *pCairoContext, CairoDockLoadImageModifier iLoadingModifier, double fImageWidth, double fImageHeight, double fZoomX, double fZoomY, double fUsefulWidth, double fUsefulheight)
 {
@@ -261,10 +270,63 @@ static inline void _apply_orientation_and_scale (cairo_t *pCairoContext, CairoDo
 }
 
 
+// Pre-multiply the pixels of an X icon by their alpha (necessary for libcairo), and pack them as 32 bits ARGB. The X buffer holds one pixel per gulong (so 64 bits on most architectures), and the result is written in place, at the beginning of the buffer (it's ok since sizeof(gulong) >= sizeof(gint), so each pixel is written at or before the place it was read).
+// x/255 is computed as (x + 1 + (x >> 8)) >> 8, which is exact for x = c * a (x <= 255*255).
+static inline guint32 _premultiply_pixel (guint32 pixel)
+{
+	guint32 alpha = pixel >> 24;
+	guint32 rb = (pixel & 0x00FF00FF) * alpha;  // red and blue at once, they can't overflow on each other.
+	guint32 g = (pixel & 0x0000FF00) * alpha;
+	rb = ((rb + 0x00010001 + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+	g = ((g + 0x00000100 + ((g >> 8) & 0x00FFFF00)) >> 8) & 0x0000FF00;
+	return (pixel & 0xFF000000) | rb | g;
+}
+
+static void _premultiply_xicon_pixels (const gulong *pXIconPixels, guint32 *pPixelBuffer, int n)
+{
+	int i = 0;
+	#ifdef __SSE2__
+	const __m128i zero = _mm_setzero_si128 ();
+	const __m128i one = _mm_set1_epi16 (1);
+	const __m128i alpha_mask = _mm_set1_epi32 (0xFF000000);
+	__m128i px, lo, hi, alo, ahi;
+	for (; i + 4 <= n; i += 4)
+	{
+		// load 4 pixels, dropping the upper half of the gulongs on 64 bits.
+		if (sizeof (gulong) == 8)
+		{
+			__m128i p01 = _mm_loadu_si128 ((const __m128i*) &pXIconPixels[i]);
+			__m128i p23 = _mm_loadu_si128 ((const __m128i*) &pXIconPixels[i+2]);
+			px = _mm_unpacklo_epi64 (_mm_shuffle_epi32 (p01, _MM_SHUFFLE (2, 0, 2, 0)), _mm_shuffle_epi32 (p23, _MM_SHUFFLE (2, 0, 2, 0)));
+		}
+		else
+			px = _mm_loadu_si128 ((const __m128i*) &pXIconPixels[i]);
+		
+		// widen to 16 bits per channel and multiply by the alpha of each pixel.
+		lo = _mm_unpacklo_epi8 (px, zero);
+		hi = _mm_unpackhi_epi8 (px, zero);
+		alo = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (lo, _MM_SHUFFLE (3, 3, 3, 3)), _MM_SHUFFLE (3, 3, 3, 3));
+		ahi = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (hi, _MM_SHUFFLE (3, 3, 3, 3)), _MM_SHUFFLE (3, 3, 3, 3));
+		lo = _mm_mullo_epi16 (lo, alo);
+		hi = _mm_mullo_epi16 (hi, ahi);
+		
+		// divide by 255.
+		lo = _mm_srli_epi16 (_mm_add_epi16 (_mm_add_epi16 (lo, one), _mm_srli_epi16 (lo, 8)), 8);
+		hi = _mm_srli_epi16 (_mm_add_epi16 (_mm_add_epi16 (hi, one), _mm_srli_epi16 (hi, 8)), 8);
+		
+		// pack back to 8 bits and restore the alpha.
+		px = _mm_or_si128 (_mm_andnot_si128 (alpha_mask, _mm_packus_epi16 (lo, hi)), _mm_and_si128 (px, alpha_mask));
+		_mm_storeu_si128 ((__m128i*) &pPixelBuffer[i], px);
+	}
+	#endif
+	for (; i < n; i ++)
+		pPixelBuffer[i] = _premultiply_pixel ((guint32) pXIconPixels[i]);
+}
+
 cairo_surface_t *cairo_dock_create_surface_from_xicon_buffer (gulong *pXIconBuffer, int iBufferNbElements, int iWidth, int iHeight)
 {
-	//\____________________ On recupere la plus grosse des icones presentes dans le tampon (meilleur rendu).
-	int iIndex = 0, iBestIndex = 0;
+	//\____________________ On recupere la plus petite des icones au moins aussi grandes que la taille demandee (meilleur rendu, et moins de pixels a traiter), ou a defaut la plus grosse.
+	int iIndex = 0, iBestIndex = -1, iLargestIndex = 0;
 	while (iIndex + 2 < iBufferNbElements)
 	{
 		if (pXIconBuffer[iIndex] == 0 || pXIconBuffer[iIndex+1] == 0)  // precaution au cas ou un buffer foirreux nous serait retourne, on risque de boucler sans fin.
@@ -274,10 +336,15 @@ cairo_surface_t *cairo_dock_create_surface_from_xicon_buffer (gulong *pXIconBuff
 				return NULL;
 			break;
 		}
-		if (pXIconBuffer[iIndex] > pXIconBuffer[iBestIndex])
+		if (pXIconBuffer[iIndex] > pXIconBuffer[iLargestIndex])
+			iLargestIndex = iIndex;
+		if (pXIconBuffer[iIndex] >= (gulong)iWidth && pXIconBuffer[iIndex+1] >= (gulong)iHeight
+		&& (iBestIndex < 0 || pXIconBuffer[iIndex] * pXIconBuffer[iIndex+1] < pXIconBuffer[iBestIndex] * pXIconBuffer[iBestIndex+1]))
 			iBestIndex = iIndex;
 		iIndex += 2 + pXIconBuffer[iIndex] * pXIconBuffer[iIndex+1];
 	}
+	if (iBestIndex < 0)  // all icons are smaller than the requested size
+		iBestIndex = iLargestIndex;
 
 	//\____________________ On pre-multiplie chaque composante par le alpha (necessaire pour libcairo).
 	int w = pXIconBuffer[iBestIndex];
@@ -285,28 +352,14 @@ cairo_surface_t *cairo_dock_create_surface_from_xicon_buffer (gulong *pXIconBuff
 	iBestIndex += 2;
 	//g_print ("%s (%dx%d)\n", __func__, w, h);
 	
-	int i, n = w * h;
+	int n = w * h;
 	if (iBestIndex + n > iBufferNbElements)  // precaution au cas ou le nombre d'elements dans le buffer serait incorrect.
 	{
 		cd_warning ("This icon is broken !\nThis means that one of the current applications has sent a buggy icon to X.");
 		return NULL;
 	}
-	gint pixel, alpha, red, green, blue;
-	float fAlphaFactor;
-	gint *pPixelBuffer = (gint *) &pXIconBuffer[iBestIndex];  // on va ecrire le resultat du filtre directement dans le tableau fourni en entree. C'est ok car sizeof(gulong) >= sizeof(gint), donc le tableau de pixels est plus petit que le buffer fourni en entree. merci a Hannemann pour ses tests et ses screenshots ! :-)
-	for (i = 0; i < n; i ++)
-	{
-		pixel = (gint) pXIconBuffer[iBestIndex+i];
-		alpha = (pixel & 0xFF000000) >> 24;
-		red   = (pixel & 0x00FF0000) >> 16;
-		green = (pixel & 0x0000FF00) >> 8;
-		blue  = (pixel & 0x000000FF);
-		fAlphaFactor = (float) alpha / 255;
-		red *= fAlphaFactor;
-		green *= fAlphaFactor;
-		blue *= fAlphaFactor;
-		pPixelBuffer[i] = (pixel & 0xFF000000) + (red << 16) + (green << 8) + blue;
-	}
+	guint32 *pPixelBuffer = (guint32 *) &pXIconBuffer[iBestIndex];  // on va ecrire le resultat du filtre directement dans le tableau fourni en entree. C'est ok car sizeof(gulong) >= sizeof(gint), donc le tableau de pixels est plus petit que le buffer fourni en entree. merci a Hannemann pour ses tests et ses screenshots ! :-)
+	_premultiply_xicon_pixels (&pXIconBuffer[iBestIndex], pPixelBuffer, n);
 
 	//\____________________ On cree la surface a partir du tampon.
 	int iStride = w * sizeof (gint);  // nbre d'octets entre le debut de 2 lignes.
@@ -348,7 +401,7 @@ cairo_surface_t *cairo_dock_create_surface_from_xicon_buffer (gulong *pXIconBuff
 }
 
 
-cairo_surface_t *cairo_dock_create_surface_from_pixbuf (GdkPixbuf *pixbuf, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY)
+static cairo_surface_t *_create_surface_from_pixbuf (GdkPixbuf *pixbuf, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY, gboolean bImageSurface)
 {
 	*fImageWidth = gdk_pixbuf_get_width (pixbuf);
 	*fImageHeight = gdk_pixbuf_get_height (pixbuf);
@@ -398,9 +451,10 @@ cairo_surface_t *cairo_dock_create_surface_from_pixbuf (GdkPixbuf *pixbuf, doubl
 		h,
 		iRowstride);
 
-	cairo_surface_t *pNewSurface = cairo_dock_create_blank_surface (
+	cairo_surface_t *pNewSurface = _create_blank_surface (
 		ceil ((*fImageWidth) * fMaxScale),
-		ceil ((*fImageHeight) * fMaxScale));
+		ceil ((*fImageHeight) * fMaxScale),
+		bImageSurface);
 	cairo_t *pCairoContext = cairo_create (pNewSurface);
 	
 	double fUsefulWidth = w * fIconWidthSaturationFactor;  // a part dans le cas fill && keep ratio, c'est la meme chose que fImageWidth et fImageHeight.
@@ -427,8 +481,13 @@ cairo_surface_t *cairo_dock_create_surface_from_pixbuf (GdkPixbuf *pixbuf, doubl
 	return pNewSurface;
 }
 
+cairo_surface_t *cairo_dock_create_surface_from_pixbuf (GdkPixbuf *pixbuf, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY)
+{
+	return _create_surface_from_pixbuf (pixbuf, fMaxScale, iWidthConstraint, iHeightConstraint, iLoadingModifier, fImageWidth, fImageHeight, fZoomX, fZoomY, FALSE);
+}
 
-cairo_surface_t *cairo_dock_create_surface_from_image (const gchar *cImagePath, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY)
+
+static cairo_surface_t *_create_surface_from_image (const gchar *cImagePath, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY, gboolean bImageSurface)
 {
 	//g_print ("%s (%s, %dx%dx%.2f, %d)\n", __func__, cImagePath, iWidthConstraint, iHeightConstraint, fMaxScale, iLoadingModifier);
 	g_return_val_if_fail (cImagePath != NULL, NULL);
@@ -474,7 +533,27 @@ cairo_surface_t *cairo_dock_create_surface_from_image (const gchar *cImagePath,
 	}
 	
 	bIsPNG = FALSE;  /// libcairo 1.6 - 1.8 est bugguee !!!...
-	if (bIsSVG)
+	if (bIsSVG && (surface_ini = cairo_dock_image_cache_lookup (cImagePath, fMaxScale, iWidthConstraint, iHeightConstraint, iLoadingModifier, fImageWidth, fImageHeight, &fIconWidthSaturationFactor, &fIconHeightSaturationFactor)) != NULL)  // rendering a SVG is slow, so it has probably been done already on a previous startup.
+	{
+		if (bImageSurface || g_bUseOpenGL)
+		{
+			pNewSurface = surface_ini;
+		}
+		else  // copy it on a surface similar to the X one.
+		{
+			pNewSurface = _create_blank_surface (
+				cairo_image_surface_get_width (surface_ini),
+				cairo_image_surface_get_height (surface_ini),
+				FALSE);
+			pCairoContext = cairo_create (pNewSurface);
+			cairo_set_operator (pCairoContext, CAIRO_OPERATOR_SOURCE);
+			cairo_set_source_surface (pCairoContext, surface_ini, 0, 0);
+			cairo_paint (pCairoContext);
+			cairo_destroy (pCairoContext);
+			cairo_surface_destroy (surface_ini);
+		}
+	}
+	else if (bIsSVG)
 	{
 		rsvg_handle = rsvg_handle_new_from_file (cImagePath, &erreur);
 		if (erreur != NULL)
@@ -500,9 +579,10 @@ cairo_surface_t *cairo_dock_create_surface_from_image (const gchar *cImagePath,
 				&fIconWidthSaturationFactor,
 				&fIconHeightSaturationFactor);
 			
-			pNewSurface = cairo_dock_create_blank_surface (
+			pNewSurface = _create_blank_surface (
 				ceil ((*fImageWidth) * fMaxScale),
-				ceil ((*fImageHeight) * fMaxScale));
+				ceil ((*fImageHeight) * fMaxScale),
+				bImageSurface);
 
 			pCairoContext = cairo_create (pNewSurface);
 			double fUsefulWidth = w * fIconWidthSaturationFactor;  // a part dans le cas fill && keep ratio, c'est la meme chose que fImageWidth et fImageHeight.
@@ -516,6 +596,11 @@ cairo_surface_t *cairo_dock_create_surface_from_image (const gchar *cImagePath,
 			rsvg_handle_render_cairo (rsvg_handle, pCairoContext);
 			cairo_destroy (pCairoContext);
 			g_object_unref (rsvg_handle);
+			
+			cairo_dock_image_cache_store (cImagePath, fMaxScale, iWidthConstraint, iHeightConstraint, iLoadingModifier,
+				pNewSurface,
+				*fImageWidth, *fImageHeight,
+				fIconWidthSaturationFactor, fIconHeightSaturationFactor);  // only image surfaces are kept.
 		}
 	}
 	else if (bIsPNG)
@@ -535,9 +620,10 @@ cairo_surface_t *cairo_dock_create_surface_from_image (const gchar *cImagePath,
 				&fIconWidthSaturationFactor,
 				&fIconHeightSaturationFactor);
 			
-			pNewSurface = cairo_dock_create_blank_surface (
+			pNewSurface = _create_blank_surface (
 				ceil ((*fImageWidth) * fMaxScale),
-				ceil ((*fImageHeight) * fMaxScale));
+				ceil ((*fImageHeight) * fMaxScale),
+				bImageSurface);
 			pCairoContext = cairo_create (pNewSurface);
 			cairo_set_operator (pCairoContext, CAIRO_OPERATOR_SOURCE);
 			cairo_set_source_rgba (pCairoContext, 0., 0., 0., 0.);
@@ -567,7 +653,7 @@ cairo_surface_t *cairo_dock_create_surface_from_image (const gchar *cImagePath,
 			g_error_free (erreur);
 			return NULL;
 		}
-		pNewSurface = cairo_dock_create_surface_from_pixbuf (pixbuf,
+		pNewSurface = _create_surface_from_pixbuf (pixbuf,
 			fMaxScale,
 			iWidthConstraint,
 			iHeightConstraint,
@@ -575,7 +661,8 @@ cairo_surface_t *cairo_dock_create_surface_from_image (const gchar *cImagePath,
 			fImageWidth,
 			fImageHeight,
 			&fIconWidthSaturationFactor,
-			&fIconHeightSaturationFactor);
+			&fIconHeightSaturationFactor,
+			bImageSurface);
 		g_object_unref (pixbuf);
 		
 	}
@@ -588,6 +675,69 @@ cairo_surface_t *cairo_dock_create_surface_from_image (const gchar *cImagePath,
 	return pNewSurface;
 }
 
+cairo_surface_t *cairo_dock_create_surface_from_image (const gchar *cImagePath, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY)
+{
+	return _create_surface_from_image (cImagePath, fMaxScale, iWidthConstraint, iHeightConstraint, iLoadingModifier, fImageWidth, fImageHeight, fZoomX, fZoomY, FALSE);
+}
+
+typedef struct {
+	gchar *cImagePath;
+	double fMaxScale;
+	int iWidthConstraint, iHeightConstraint;
+	CairoDockLoadImageModifier iLoadingModifier;
+	CairoDockImageLoadedFunc pCallback;
+	gpointer pUserData;
+	cairo_surface_t *pSurface;
+	double fImageWidth, fImageHeight;
+} CairoDockImageLoadingData;
+
+static void _load_image_async (CairoDockImageLoadingData *pData)  // thread
+{
+	pData->pSurface = _create_surface_from_image (pData->cImagePath,
+		pData->fMaxScale,
+		pData->iWidthConstraint,
+		pData->iHeightConstraint,
+		pData->iLoadingModifier,
+		&pData->fImageWidth,
+		&pData->fImageHeight,
+		NULL,
+		NULL,
+		TRUE);  // we can't use the main container's context from a thread, so we make an image surface, which is anyway what is needed to make a texture.
+}
+static gboolean _on_image_loaded (CairoDockImageLoadingData *pData)
+{
+	cairo_surface_t *pSurface = pData->pSurface;
+	pData->pSurface = NULL;  // the callback takes it
+	pData->pCallback (pSurface, pData->fImageWidth, pData->fImageHeight, pData->pUserData);
+	return FALSE;
+}
+static void _free_image_loading_data (CairoDockImageLoadingData *pData)
+{
+	if (pData->pSurface != NULL)
+		cairo_surface_destroy (pData->pSurface);
+	g_free (pData->cImagePath);
+	g_free (pData);
+}
+GldiTask *cairo_dock_create_surface_from_image_async (const gchar *cImagePath, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, CairoDockImageLoadedFunc pCallback, gpointer data)
+{
+	g_return_val_if_fail (cImagePath != NULL && pCallback != NULL, NULL);
+	CairoDockImageLoadingData *pData = g_new0 (CairoDockImageLoadingData, 1);
+	pData->cImagePath = g_strdup (cImagePath);
+	pData->fMaxScale = fMaxScale;
+	pData->iWidthConstraint = iWidthConstraint;
+	pData->iHeightConstraint = iHeightConstraint;
+	pData->iLoadingModifier = iLoadingModifier;
+	pData->pCallback = pCallback;
+	pData->pUserData = data;
+	GldiTask *pTask = gldi_task_new_full (0,
+		(GldiGetDataAsyncFunc) _load_image_async,
+		(GldiUpdateSyncFunc) _on_image_loaded,
+		(GFreeFunc) _free_image_loading_data,
+		pData);
+	gldi_task_launch (pTask);
+	return pTask;
+}
+
 cairo_surface_t *cairo_dock_create_surface_from_image_simple (const gchar *cImageFile, double fImageWidth, double fImageHeight)
 {
 	g_return_val_if_fail (cImageFile != NULL, NULL);
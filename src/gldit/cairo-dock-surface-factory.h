@@ -114,6 +114,21 @@ cairo_surface_t *cairo_dock_create_blank_surface (int iWidth, int iHeight);
 */
 cairo_surface_t *cairo_dock_create_surface_from_image (const gchar *cImagePath, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY);
 
+/// Definition of the function called when an image has been loaded asynchronously. The surface (possibly NULL if the image couldn't be loaded) is given to the callback.
+typedef void (* CairoDockImageLoadedFunc) (cairo_surface_t *pSurface, double fImageWidth, double fImageHeight, gpointer data);
+
+/** Same as \ref cairo_dock_create_surface_from_image, but the image is decoded in a thread, and the resulting surface is given to a callback on the main thread. The surface is always an image surface.
+*@param cImagePath complete path to the image.
+*@param fMaxScale maximum zoom of the icon.
+*@param iWidthConstraint constraint on the width, or 0 to not constraint it.
+*@param iHeightConstraint constraint on the height, or 0 to not constraint it.
+*@param iLoadingModifier a mask of different loading modifiers.
+*@param pCallback function called with the surface once the image is loaded.
+*@param data data passed to the callback.
+*@return the Task that loads the image. It is not freed once it's done; free it with \ref gldi_task_free once the callback has been called, or \ref gldi_task_discard to cancel the loading.
+*/
+GldiTask *cairo_dock_create_surface_from_image_async (const gchar *cImagePath, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, CairoDockImageLoadedFunc pCallback, gpointer data);
+
 /** Create a surface from any image, at a given size. If the image is given by its sole name, it is searched inside the current theme root folder.
 *@param cImageFile path or name of an image.
 *@param fImageWidth the desired surface width.
@@ -19,6 +19,16 @@
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>  // read, write
+
+#include "gldi-config.h"
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#else
+#include <fcntl.h>  // FD_CLOEXEC
+#include <glib-unix.h>  // g_unix_open_pipe
+#endif
 
 #include "cairo-dock-log.h"
 #include "cairo-dock-task.h"
@@ -28,20 +38,19 @@
 #define G_COND_INIT(a)   a = g_cond_new ()
 #define G_MUTEX_CLEAR(a) g_mutex_free (a)
 #define G_COND_CLEAR(a)  g_cond_free (a)
-#define G_THREAD_UNREF(t) g_free (t)
 #else
 #define G_MUTEX_INIT(a)  a = g_new (GMutex, 1); g_mutex_init (a)
 #define G_COND_INIT(a)   a = g_new (GCond, 1);  g_cond_init (a)
 #define G_MUTEX_CLEAR(a) g_mutex_clear (a); g_free (a)
 #define G_COND_CLEAR(a)  g_cond_clear (a);  g_free (a)
-#define G_THREAD_UNREF(t) if (t) g_thread_unref (t)
 #endif
 
 #define _schedule_next_iteration(pTask) do {\
-	if (pTask->iSidTimer == 0 && pTask->iPeriod)\
-		pTask->iSidTimer = g_timeout_add_seconds (pTask->iPeriod, (GSourceFunc) _launch_task_timer, pTask); } while (0)
+	if (pTask->iWheelSlot < 0 && pTask->iSidTimer == 0 && pTask->iPeriod)\
+		_add_task_in_wheel (pTask, pTask->iPeriod); } while (0)
 
 #define _cancel_next_iteration(pTask) do {\
+	_remove_task_from_wheel (pTask);\
 	if (pTask->iSidTimer != 0) {\
 		g_source_remove (pTask->iSidTimer);\
 		pTask->iSidTimer = 0; } } while (0)
@@ -57,103 +66,418 @@
 	G_MUTEX_CLEAR (pTask->pMutex);\
 	if (pTask->pCond) {\
 		G_COND_CLEAR (pTask->pCond); }\
-	G_THREAD_UNREF (pTask->pThread);\
 	g_free (pTask); } while (0)
 
-static gboolean _launch_task_timer (GldiTask *pTask)
+  ///////////////////
+ /// TIMER WHEEL ///
+///////////////////
+
+// All the periodic tasks are scheduled in a hierarchical timer wheel driven by a single timeout, so that the tasks due at the same second are run in the same wakeup, and a task can accept to be delayed a bit to be run along with other tasks (its "slack"). The resolution is 1s, which is the unit of the periods.
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)  // number of slots per level
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_NB_LEVELS 3  // level n has a granularity of 64^n seconds => up to 72h.
+#define WHEEL_MAX_DELTA ((1 << (WHEEL_NB_LEVELS * WHEEL_BITS)) - 1)
+#define GLDI_TASK_MAX_SLACK (WHEEL_SIZE - 1)  // the slack must fit into the first level.
+
+static GList *s_pWheel[WHEEL_NB_LEVELS * WHEEL_SIZE];  // list of tasks per slot.
+static gint64 s_iCurrentTick = 0;  // last tick processed by the wheel.
+static guint s_iSidWheel = 0;  // the only timer of the wheel.
+static gint64 s_iArmedTick = 0;  // tick at which the timer is expected to fire.
+static gboolean s_bWheelFiring = FALSE;  // TRUE while the wheel runs the due tasks; the timer is re-armed at the end.
+static guint s_iNbWheelWakeups = 0;  // number of times the timer of the wheel has fired, see gldi_task_get_nb_wheel_wakeups().
+// the period of a task in each frequency state is a multiple of its normal period; a task in a back-off state is not time-critical, so it accepts to be delayed by 1/10 of its period.
+static const int s_iFrequencyFactor[GLDI_TASK_NB_FREQUENCIES] = {1, 2, 4, 10};
+
+static gboolean _on_wheel_timer (gpointer data);
+
+static inline gint64 _get_current_tick (void)
 {
-	gldi_task_launch (pTask);
-	return TRUE;
+	return (g_get_monotonic_time () + G_USEC_PER_SEC / 2) / G_USEC_PER_SEC;  // round to the nearest second, since 'g_timeout_add_seconds' can fire a bit before or after the second.
 }
-static gboolean _check_for_update_idle (GldiTask *pTask)
+
+static void _insert_task_in_wheel (GldiTask *pTask)
 {
-	// process the data (we don't need to wait that the thread is over, so do it now, it will let more time for the thread to finish, and therfore often save a 'usleep').
-	if (pTask->bNeedsUpdate)  // data are ready to be processed -> perform the update
+	gint64 iDelta = pTask->iExpiryTick - s_iCurrentTick;  // relative to the position of the wheel, which may be a bit late on the current time.
+	if (iDelta > WHEEL_MAX_DELTA)
 	{
-		if (! pTask->bDiscard)  // of course if the task has been discarded before, don't do anything.
+		pTask->iExpiryTick = s_iCurrentTick + WHEEL_MAX_DELTA;
+		iDelta = WHEEL_MAX_DELTA;
+	}
+	else if (iDelta < 1)  // can't insert in the past.
+	{
+		pTask->iExpiryTick = s_iCurrentTick + 1;
+		iDelta = 1;
+	}
+	int iLevel = 0;
+	while (iDelta >= (1 << ((iLevel + 1) * WHEEL_BITS)))
+		iLevel ++;
+	int iSlot = iLevel * WHEEL_SIZE + ((pTask->iExpiryTick >> (iLevel * WHEEL_BITS)) & WHEEL_MASK);
+	s_pWheel[iSlot] = g_list_prepend (s_pWheel[iSlot], pTask);
+	pTask->iWheelSlot = iSlot;
+}
+
+static gint64 _get_next_expiry (void)  // -1 if the wheel is empty.
+{
+	gint64 iNextExpiry = -1;
+	GList *t;
+	GldiTask *pTask;
+	int iLevel, j, iSlot;
+	for (iLevel = 0; iLevel < WHEEL_NB_LEVELS; iLevel ++)
+	{
+		for (j = 1; j <= WHEEL_SIZE; j ++)  // first non-empty slot after the current position at this level.
 		{
-			pTask->bContinue = pTask->update (pTask->pSharedMemory);
+			iSlot = iLevel * WHEEL_SIZE + (((s_iCurrentTick >> (iLevel * WHEEL_BITS)) + j) & WHEEL_MASK);
+			if (s_pWheel[iSlot] != NULL)
+				break;
+		}
+		if (j > WHEEL_SIZE)
+			continue;
+		for (t = s_pWheel[iSlot]; t != NULL; t = t->next)  // the slots are in chronological order inside a level, but a task in an upper level may be due before a task in a lower one, since they are only cascaded when the wheel reaches their slot.
+		{
+			pTask = t->data;
+			if (iNextExpiry < 0 || pTask->iExpiryTick < iNextExpiry)
+				iNextExpiry = pTask->iExpiryTick;
 		}
-		pTask->bNeedsUpdate = FALSE;  // now update is done, we won't do it any more until the next iteration, even is we loop on this function.
+	}
+	return iNextExpiry;
+}
+
+static void _rearm_wheel (void)
+{
+	if (s_bWheelFiring)  // will be done at the end.
+		return;
+	gint64 iNextExpiry = _get_next_expiry ();
+	if (s_iSidWheel != 0)
+	{
+		if (iNextExpiry == s_iArmedTick)  // nothing to change.
+			return;
+		g_source_remove (s_iSidWheel);
+		s_iSidWheel = 0;
+	}
+	if (iNextExpiry < 0)  // no more task, no more wakeup.
+		return;
+	s_iArmedTick = iNextExpiry;
+	gint64 iDelay = iNextExpiry - _get_current_tick ();
+	s_iSidWheel = g_timeout_add_seconds (MAX (0, iDelay), _on_wheel_timer, NULL);
+}
+
+static void _add_task_in_wheel (GldiTask *pTask, int iPeriod)
+{
+	gboolean bWheelWasEmpty = (s_iSidWheel == 0 && ! s_bWheelFiring);
+	if (bWheelWasEmpty)  // the wheel has been idle, move it to the current time (there is no task to run in-between).
+		s_iCurrentTick = _get_current_tick ();
+	pTask->iWheelPeriod = iPeriod;
+	pTask->iDueTick = _get_current_tick () + iPeriod;
+	int iSlack = pTask->iSlack;
+	if (pTask->iFrequencyState != GLDI_TASK_FREQUENCY_NORMAL)
+		iSlack = MAX (iSlack, iPeriod / 10);
+	pTask->iExpiryTick = pTask->iDueTick + MIN (iSlack, GLDI_TASK_MAX_SLACK);
+	_insert_task_in_wheel (pTask);
+	_rearm_wheel ();
+}
+
+static void _remove_task_from_wheel (GldiTask *pTask)
+{
+	if (pTask->iWheelSlot < 0)
+		return;
+	s_pWheel[pTask->iWheelSlot] = g_list_remove (s_pWheel[pTask->iWheelSlot], pTask);
+	pTask->iWheelSlot = -1;
+	_rearm_wheel ();
+}
+
+static void _run_task_from_wheel (GldiTask *pTask)
+{
+	// re-schedule the task before launching it, since the launch may stop or discard it.
+	s_pWheel[pTask->iWheelSlot] = g_list_remove (s_pWheel[pTask->iWheelSlot], pTask);
+	pTask->iWheelSlot = -1;
+	_add_task_in_wheel (pTask, pTask->iWheelPeriod);
+	gldi_task_launch (pTask);
+}
+
+static void _cascade_wheel (int iLevel)
+{
+	int iSlot = iLevel * WHEEL_SIZE + ((s_iCurrentTick >> (iLevel * WHEEL_BITS)) & WHEEL_MASK);
+	GList *pTasks = s_pWheel[iSlot], *t;
+	s_pWheel[iSlot] = NULL;
+	for (t = pTasks; t != NULL; t = t->next)  // the tasks of this slot are now less than 64^level seconds ahead, move them to the lower levels.
+		_insert_task_in_wheel (t->data);
+	g_list_free (pTasks);
+}
+
+static gboolean _on_wheel_timer (G_GNUC_UNUSED gpointer data)
+{
+	s_iSidWheel = 0;
+	s_iNbWheelWakeups ++;
+	s_bWheelFiring = TRUE;
+	
+	//\_______________________ advance the wheel up to now, and run the tasks on the way.
+	gint64 iNow = _get_current_tick ();
+	int iSlot, iLevel, j;
+	while (s_iCurrentTick < iNow)
+	{
+		s_iCurrentTick ++;
+		for (iLevel = 1; iLevel < WHEEL_NB_LEVELS && (s_iCurrentTick & ((1 << (iLevel * WHEEL_BITS)) - 1)) == 0; iLevel ++)
+			_cascade_wheel (iLevel);
+		
+		iSlot = s_iCurrentTick & WHEEL_MASK;
+		while (s_pWheel[iSlot] != NULL)  // one by one, since running a task can remove other tasks from the wheel.
+			_run_task_from_wheel (s_pWheel[iSlot]->data);
 	}
 	
-	// finish the iteration, and possibly schedule the next one (the thread must be finished for this part).
-	if (g_mutex_trylock (pTask->pMutex))  // if the thread is over
+	//\_______________________ since we're awake, also run the tasks that are due but accepted to be delayed.
+	GList *t;
+	GldiTask *pTask;
+	for (j = 1; j <= GLDI_TASK_MAX_SLACK; j ++)
 	{
-		if (pTask->bDiscard)  // if the task has been discarded, it's the end of the journey for it.
+		iSlot = (s_iCurrentTick + j) & WHEEL_MASK;
+		_next_slot:
+		for (t = s_pWheel[iSlot]; t != NULL; t = t->next)
 		{
-			if (pTask->pCond)
+			pTask = t->data;
+			if (pTask->iDueTick <= iNow)
 			{
-				pTask->bRunThread = TRUE;
-				g_cond_signal (pTask->pCond);
-				g_mutex_unlock (pTask->pMutex);
-				g_thread_join (pTask->pThread); // unref the thread
+				_run_task_from_wheel (pTask);
+				goto _next_slot;  // the list has changed, walk it again.
 			}
-			else
-			{
-				g_mutex_unlock (pTask->pMutex);
-				G_THREAD_UNREF (pTask->pThread);
-			}
-			pTask->pThread = NULL;
-			_free_task (pTask);
-			return FALSE;
-		}
-		
-		if (! pTask->pCond)  // one-shot thread => the thread is over
-		{
-			G_THREAD_UNREF (pTask->pThread);
-			pTask->pThread = NULL;
 		}
+	}
+	
+	s_bWheelFiring = FALSE;
+	_rearm_wheel ();
+	return FALSE;
+}
+
+  ////////////
+ /// POOL ///
+////////////
+
+// minimum number of workers of the pool: some tasks (downloads, etc) spend most of their time waiting, so we don't want a 1 or 2-cores machine to serialize them.
+#define GLDI_TASK_POOL_MIN_THREADS 4
+
+static GThreadPool *s_pTaskPool = NULL;  // pool of threads shared by all the tasks, to run their 'get_data' callback.
+
+// tasks whose 'get_data' is over, waiting for their 'update' in the main loop. the workers push them and wake up the main loop through a file descriptor, so that the main loop only wakes up when there is actually something to do.
+static GQueue s_pCompletedTasks = G_QUEUE_INIT;
+static GMutex *s_pCompletedMutex = NULL;
+static GPollFD s_completion_poll_fd;
+static GSource *s_pCompletionSource = NULL;  // the source polling the fd; created once, along with the fd.
+static guint s_iNbCompletionWakeups = 0;  // number of times the main loop has been awaken by the workers.
+static gint s_iWakeupPending = 0;  // 1 if the fd has been written and not yet drained; avoids writing once per task when several tasks complete at once.
+#ifndef HAVE_SYS_EVENTFD_H
+static gint s_iWakeupWriteFd = -1;  // write end of the pipe, the read end is polled.
+#endif
+
+static void _get_data_in_pool (GldiTask *pTask, gpointer data);
+static void _finish_task (GldiTask *pTask);
+
+static void _wakeup_main_loop (void)
+{
+	if (! g_atomic_int_compare_and_exchange (&s_iWakeupPending, 0, 1))  // the main loop is already about to be awaken.
+		return;
+	#ifdef HAVE_SYS_EVENTFD_H
+	guint64 iValue = 1;
+	if (write (s_completion_poll_fd.fd, &iValue, sizeof (iValue)) < 0)
+	#else
+	guchar c = 0;
+	if (write (s_iWakeupWriteFd, &c, 1) < 0)
+	#endif
+		cd_warning ("couldn't wake up the main loop (%s)", g_strerror (errno));
+}
+
+static void _drain_wakeup_fd (void)
+{
+	g_atomic_int_set (&s_iWakeupPending, 0);  // reset it before draining, so that a task completing from now on will wake us up again.
+	#ifdef HAVE_SYS_EVENTFD_H
+	guint64 iValue;
+	while (read (s_completion_poll_fd.fd, &iValue, sizeof (iValue)) < 0 && errno == EINTR);  // the eventfd is reset by a single read; only retry if it was interrupted (EAGAIN means it was already drained).
+	#else
+	guchar buf[64];
+	ssize_t n;
+	do  // non-blocking pipe: read until it's empty (EAGAIN), retrying on EINTR.
+	{
+		n = read (s_completion_poll_fd.fd, buf, sizeof (buf));
+	} while (n > 0 || (n < 0 && errno == EINTR));
+	#endif
+}
+
+static gboolean _prepare (G_GNUC_UNUSED GSource *source, gint *timeout)
+{
+	*timeout = -1;  // no timeout for poll()
+	return FALSE;  // only the fd tells us when a task is over.
+}
+static gboolean _check (G_GNUC_UNUSED GSource *source)
+{
+	return (s_completion_poll_fd.revents & G_IO_IN);
+}
+static gboolean _dispatch (G_GNUC_UNUSED GSource *source, G_GNUC_UNUSED GSourceFunc callback, G_GNUC_UNUSED gpointer user_data)
+{
+	_drain_wakeup_fd ();
+	s_iNbCompletionWakeups ++;
+	
+	GldiTask *pTask;
+	while (TRUE)  // process all the tasks completed so far; a task may be stopped or discarded by the update of another one, so pop them one by one.
+	{
+		g_mutex_lock (s_pCompletedMutex);
+		pTask = g_queue_pop_head (&s_pCompletedTasks);
+		g_mutex_unlock (s_pCompletedMutex);
+		if (pTask == NULL)
+			break;
+		_finish_task (pTask);
+	}
+	return TRUE;  // keep the source alive
+}
+
+static gboolean _init_completion_source (void)
+{
+	if (s_pCompletionSource != NULL)  // already done (the pool may have failed to be created after it), don't leak the fd and the source.
+		return TRUE;
+	#ifdef HAVE_SYS_EVENTFD_H
+	s_completion_poll_fd.fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (s_completion_poll_fd.fd < 0)
+	{
+		cd_warning ("couldn't create an eventfd (%s)", g_strerror (errno));
+		return FALSE;
+	}
+	#else
+	GError *erreur = NULL;
+	gint fds[2];
+	if (! g_unix_open_pipe (fds, FD_CLOEXEC, &erreur))
+	{
+		cd_warning (erreur->message);
+		g_error_free (erreur);
+		return FALSE;
+	}
+	g_unix_set_fd_nonblocking (fds[0], TRUE, NULL);
+	g_unix_set_fd_nonblocking (fds[1], TRUE, NULL);
+	s_completion_poll_fd.fd = fds[0];
+	s_iWakeupWriteFd = fds[1];
+	#endif
+	G_MUTEX_INIT (s_pCompletedMutex);
+	
+	static GSourceFuncs source_funcs;
+	memset (&source_funcs,0, sizeof (GSourceFuncs));
+	source_funcs.prepare = _prepare;
+	source_funcs.check = _check;
+	source_funcs.dispatch = _dispatch;
+	source_funcs.finalize = NULL;
+	
+	GSource *source = g_source_new (&source_funcs, sizeof(GSource));
+	s_completion_poll_fd.events = G_IO_IN;
+	g_source_add_poll (source, &s_completion_poll_fd);
+	g_source_attach (source, NULL);  // NULL <-> main context
+	g_source_unref (source);  // the main context holds a reference on it.
+	s_pCompletionSource = source;
+	return TRUE;
+}
+
+static gboolean _push_task_in_pool (GldiTask *pTask)
+{
+	GError *erreur = NULL;
+	if (s_pTaskPool == NULL)  // first task ever -> create the pool, with as many workers as the number of cores.
+	{
+		if (! _init_completion_source ())
+			return FALSE;
 		
-		pTask->iSidUpdateIdle = 0;  // set it before the unlock, as it is accessed in the thread part
-		g_mutex_unlock (pTask->pMutex);
-		
-		// schedule the next iteration if necessary.
-		if (! pTask->bContinue)
+		#ifdef GLIB_VERSION_2_36
+		int iNbThreads = MAX (GLDI_TASK_POOL_MIN_THREADS, (int)g_get_num_processors ());
+		#else
+		int iNbThreads = GLDI_TASK_POOL_MIN_THREADS;
+		#endif
+		s_pTaskPool = g_thread_pool_new ((GFunc) _get_data_in_pool, NULL, iNbThreads, FALSE, &erreur);  // FALSE <=> non-exclusive, threads are spawned on demand and shared with the other non-exclusive pools.
+		if (erreur != NULL)
 		{
-			_cancel_next_iteration (pTask);
-		}
-		else
-		{
-			pTask->iFrequencyState = GLDI_TASK_FREQUENCY_NORMAL;
-			_schedule_next_iteration (pTask);
+			cd_warning (erreur->message);
+			g_error_free (erreur);
+			s_pTaskPool = NULL;
+			return FALSE;
 		}
-		pTask->bIsRunning = FALSE;
-		return FALSE;  // the update is now finished, quit.
+		cd_debug ("tasks will be run by a pool of %d threads", iNbThreads);
 	}
 	
-	// if the thread is not yet over, come back in 1ms.
-	g_usleep (1);  // we don't want to block the main loop until the thread is over; so just sleep 1ms to give it a chance to terminate. so it's a kind of 'sched_yield()' wihout blocking the main loop.
+	pTask->bQueued = TRUE;  // set it before the push, the worker may pick up the task right away.
+	g_thread_pool_push (s_pTaskPool, pTask, &erreur);
+	if (erreur != NULL)
+	{
+		cd_warning (erreur->message);
+		g_error_free (erreur);
+		pTask->bQueued = FALSE;
+		return FALSE;
+	}
 	return TRUE;
 }
-static gpointer _get_data_threaded (GldiTask *pTask)
+
+static void _wait_for_task_in_pool (GldiTask *pTask)
 {
 	g_mutex_lock (pTask->pMutex);
-	_run_thread:  // at this point the mutex is locked, either by the first execution of this function, or by 'g_cond_wait'
+	while (pTask->bQueued)
+		g_cond_wait (pTask->pCond, pTask->pMutex);  // releases the mutex, then takes it again when awakening.
+	g_mutex_unlock (pTask->pMutex);
 	
-	//\_______________________ get the data
-	_set_elapsed_time (pTask);
-	pTask->get_data (pTask->pSharedMemory);
+	// the worker has pushed the task in the completion queue, but its update will never happen now.
+	g_mutex_lock (s_pCompletedMutex);
+	g_queue_remove (&s_pCompletedTasks, pTask);
+	g_mutex_unlock (s_pCompletedMutex);
+}
+
+static void _finish_task (GldiTask *pTask)
+{
+	// the worker pushes the task just before releasing it, so at worst we wait for a few instructions here.
+	g_mutex_lock (pTask->pMutex);
+	g_mutex_unlock (pTask->pMutex);
 	
-	// and signal that data are ready to be processed.
-	pTask->bNeedsUpdate = TRUE;  // this is only accessed by the update fonction, which is triggered just after, so no need to protect this variable.
+	// process the data
+	if (pTask->bNeedsUpdate)  // data are ready to be processed -> perform the update
+	{
+		if (! pTask->bDiscard)  // of course if the task has been discarded before, don't do anything.
+		{
+			pTask->bContinue = pTask->update (pTask->pSharedMemory);
+		}
+		pTask->bNeedsUpdate = FALSE;
+	}
 	
-	//\_______________________ call the update function from the main loop
-	if (pTask->iSidUpdateIdle == 0)
-		pTask->iSidUpdateIdle = g_idle_add ((GSourceFunc) _check_for_update_idle, pTask);  // note that 'iSidUpdateIdle' can actually be set after the 'update' is called. that's why the 'update' have to wait for the mutex to finish its job.
+	// finish the iteration, and possibly schedule the next one.
+	if (pTask->bDiscard)  // if the task has been discarded, it's the end of the journey for it.
+	{
+		_free_task (pTask);
+		return;
+	}
+	
+	if (! pTask->bContinue)
+	{
+		_cancel_next_iteration (pTask);
+	}
+	else
+	{
+		pTask->iFrequencyState = GLDI_TASK_FREQUENCY_NORMAL;
+		_schedule_next_iteration (pTask);
+	}
+	pTask->bIsRunning = FALSE;
+}
+static void _get_data_in_pool (GldiTask *pTask, G_GNUC_UNUSED gpointer data)
+{
+	g_mutex_lock (pTask->pMutex);
 	
-	// sleep until the next iteration or just leave.
-	if (pTask->pCond)  // periodic task -> block until the condition becomes TRUE again.
+	//\_______________________ get the data
+	if (g_atomic_int_get (&pTask->bDiscard) == 0)  // the task may have been stopped or discarded while it was waiting in the queue.
 	{
-		pTask->bRunThread = FALSE;
-		while (! pTask->bRunThread)
-			g_cond_wait (pTask->pCond, pTask->pMutex);  // releases the mutex, then takes it again when awakening.
-		if (g_atomic_int_get (&pTask->bDiscard) == 0)
-			goto _run_thread;
+		_set_elapsed_time (pTask);
+		pTask->get_data (pTask->pSharedMemory);
+		
+		// and signal that data are ready to be processed.
+		pTask->bNeedsUpdate = TRUE;  // this is only accessed by the update fonction, which is triggered after the mutex is released, so no need to protect this variable.
 	}
+	
+	//\_______________________ call the update function from the main loop (even if discarded, since it's the update that frees the task).
+	g_mutex_lock (s_pCompletedMutex);
+	g_queue_push_tail (&s_pCompletedTasks, pTask);
+	g_mutex_unlock (s_pCompletedMutex);
+	_wakeup_main_loop ();
+	
+	// the worker is done with this task, wake up anybody waiting for it (see 'gldi_task_stop'). the task must not be touched after the unlock, since it can be freed by the update.
+	pTask->bQueued = FALSE;
+	g_cond_signal (pTask->pCond);
 	g_mutex_unlock (pTask->pMutex);
-	g_thread_exit (NULL);
-	return NULL;
 }
 void gldi_task_launch (GldiTask *pTask)
 {
@@ -172,36 +496,12 @@ void gldi_task_launch (GldiTask *pTask)
 			_schedule_next_iteration (pTask);
 		}
 	}
-	else  // launch the asynchronous work in a thread
+	else if (! pTask->bIsRunning)  // not queued, not running and no pending update -> hand the asynchronous work to the pool
 	{
-		if (pTask->pThread == NULL)  // no thread yet -> create and launch it
-		{
-			pTask->bIsRunning = TRUE;
-			GError *erreur = NULL;
-			#ifndef GLIB_VERSION_2_32
-			pTask->pThread = g_thread_create ((GThreadFunc) _get_data_threaded, pTask, TRUE, &erreur);  // TRUE <=> joinable
-			#else
-			pTask->pThread = g_thread_try_new ("Cairo-Dock Task", (GThreadFunc) _get_data_threaded, pTask, &erreur);
-			#endif
-			if (erreur != NULL)  // on n'a pas pu lancer le thread.
-			{
-				cd_warning (erreur->message);
-				g_error_free (erreur);
-				pTask->bIsRunning = FALSE;
-			}
-		}
-		else  // thread already exists; it's either running or sleeping or finished with a pending update
-		if (pTask->pCond && g_mutex_trylock (pTask->pMutex))  // it's a periodic thread, and it's not currently running...
-		{
-			if (pTask->iSidUpdateIdle == 0)  // ...and it doesn't have a pending update -> awake it and run it again.
-			{
-				pTask->bRunThread = TRUE;
-				pTask->bIsRunning = TRUE;
-				g_cond_signal (pTask->pCond);
-			}
-			g_mutex_unlock (pTask->pMutex);
-		}  // else it's a one-shot thread or it's currently running or has a pending update -> don't launch it. so if the task is periodic, it will skip this iteration.
-	}
+		pTask->bIsRunning = TRUE;
+		if (! _push_task_in_pool (pTask))  // couldn't push the task
+			pTask->bIsRunning = FALSE;
+	}  // else it's either waiting in the queue, or currently running or has a pending update -> don't launch it. so if the task is periodic, it will skip this iteration.
 }
 
 
@@ -231,10 +531,8 @@ GldiTask *gldi_task_new_full (int iPeriod, GldiGetDataAsyncFunc get_data, GldiUp
 	pTask->pSharedMemory = pSharedMemory;
 	pTask->pClock = g_timer_new ();
 	G_MUTEX_INIT (pTask->pMutex);
-	if (iPeriod != 0)
-	{
-		G_COND_INIT (pTask->pCond);
-	}
+	G_COND_INIT (pTask->pCond);
+	pTask->iWheelSlot = -1;
 	return pTask;
 }
 
@@ -248,42 +546,13 @@ void gldi_task_stop (GldiTask *pTask)
 	
 	if (gldi_task_is_running (pTask))
 	{
-		if (pTask->pThread)
-		{
-			g_atomic_int_set (&pTask->bDiscard, 1);  // set the discard flag to help the 'get_data' callback knows that it should stop.
-			if (pTask->pCond)  // the thread might be sleeping, awake it.
-			{
-				if (g_mutex_trylock (pTask->pMutex))
-				{
-					pTask->bRunThread = TRUE;
-					g_cond_signal (pTask->pCond);
-					g_mutex_unlock (pTask->pMutex);
-				}
-			}
-			g_thread_join (pTask->pThread);  // unref the thread
-			pTask->pThread = NULL;
-			g_atomic_int_set (&pTask->bDiscard, 0);
-		}
-		if (pTask->iSidUpdateIdle != 0)  // do it after the thread has possibly scheduled the 'update'
-		{
-			g_source_remove (pTask->iSidUpdateIdle);
-			pTask->iSidUpdateIdle = 0;
-		}
+		g_atomic_int_set (&pTask->bDiscard, 1);  // set the discard flag to help the 'get_data' callback knows that it should stop, and to skip it if the task is still waiting in the queue.
+		_wait_for_task_in_pool (pTask);
+		g_atomic_int_set (&pTask->bDiscard, 0);
+		
+		pTask->bNeedsUpdate = FALSE;
 		pTask->bIsRunning = FALSE;  // since we didn't go through the 'update'
 	}
-	else
-	{
-		if (pTask->pThread && pTask->pCond && g_mutex_trylock (pTask->pMutex))  // the thread is sleeping, awake it and let it exit.
-		{
-			g_atomic_int_set (&pTask->bDiscard, 1);
-			pTask->bRunThread = TRUE;
-			g_cond_signal (pTask->pCond);
-			g_mutex_unlock (pTask->pMutex);
-			g_thread_join (pTask->pThread);  // unref the thread
-			pTask->pThread = NULL;
-			g_atomic_int_set (&pTask->bDiscard, 0);
-		}
-	}
 }
 
 
@@ -297,19 +566,12 @@ void gldi_task_discard (GldiTask *pTask)
 	g_atomic_int_set (&pTask->bDiscard, 1);
 	
 	// if the task is running, there is nothing to do:
-	//   if we're inside the thread, it will trigger the 'update' anyway, which will destroy the task.
+	//   if it's waiting in the queue, the worker will skip the 'get_data' and trigger the 'update' anyway, which will destroy the task.
+	//   if we're inside the worker, it will trigger the 'update' anyway, which will destroy the task.
 	//   if we're waiting for the 'update', same as above
 	//   if we're inside the 'update' user callback, the task will be destroyed in the 2nd stage of the function (the user callback is called in the 1st stage).
-	if (! gldi_task_is_running (pTask))  // we can free the task immediately.
+	if (! gldi_task_is_running (pTask))  // no worker holds the task, we can free it immediately.
 	{
-		if (pTask->pThread && pTask->pCond && g_mutex_trylock (pTask->pMutex))  // the thread is sleeping, awake it and let it exit before we can free everything
-		{
-			pTask->bRunThread = TRUE;
-			g_cond_signal (pTask->pCond);
-			g_mutex_unlock (pTask->pMutex);
-			g_thread_join (pTask->pThread);  // unref the thread
-			pTask->pThread = NULL;
-		}
 		_free_task (pTask);
 	}
 }
@@ -325,7 +587,7 @@ void gldi_task_free (GldiTask *pTask)
 
 gboolean gldi_task_is_active (GldiTask *pTask)
 {
-	return (pTask != NULL && pTask->iSidTimer != 0);
+	return (pTask != NULL && (pTask->iWheelSlot >= 0 || pTask->iSidTimer != 0));
 }
 
 gboolean gldi_task_is_running (GldiTask *pTask)
@@ -335,11 +597,11 @@ gboolean gldi_task_is_running (GldiTask *pTask)
 
 static void _restart_timer_with_frequency (GldiTask *pTask, int iNewPeriod)
 {
-	gboolean bNeedsRestart = (pTask->iSidTimer != 0);
+	gboolean bNeedsRestart = gldi_task_is_active (pTask);
 	_cancel_next_iteration (pTask);
 	
 	if (bNeedsRestart && iNewPeriod != 0)
-		pTask->iSidTimer = g_timeout_add_seconds (iNewPeriod, (GSourceFunc) _launch_task_timer, pTask);
+		_add_task_in_wheel (pTask, iNewPeriod);
 }
 
 void gldi_task_change_frequency (GldiTask *pTask, int iNewPeriod)
@@ -363,22 +625,7 @@ void gldi_task_downgrade_frequency (GldiTask *pTask)
 	if (pTask->iFrequencyState < GLDI_TASK_FREQUENCY_SLEEP)
 	{
 		pTask->iFrequencyState ++;
-		int iNewPeriod;
-		switch (pTask->iFrequencyState)
-		{
-			case GLDI_TASK_FREQUENCY_LOW :
-				iNewPeriod = 2 * pTask->iPeriod;
-			break ;
-			case GLDI_TASK_FREQUENCY_VERY_LOW :
-				iNewPeriod = 4 * pTask->iPeriod;
-			break ;
-			case GLDI_TASK_FREQUENCY_SLEEP :
-				iNewPeriod = 10 * pTask->iPeriod;
-			break ;
-			default :  // ne doit pas arriver.
-				iNewPeriod = pTask->iPeriod;
-			break ;
-		}
+		int iNewPeriod = s_iFrequencyFactor[pTask->iFrequencyState] * pTask->iPeriod;
 		
 		cd_message ("degradation de la mesure (etat <- %d/%d)", pTask->iFrequencyState, GLDI_TASK_NB_FREQUENCIES-1);
 		_restart_timer_with_frequency (pTask, iNewPeriod);
@@ -393,3 +640,64 @@ void gldi_task_set_normal_frequency (GldiTask *pTask)
 		_restart_timer_with_frequency (pTask, pTask->iPeriod);
 	}
 }
+
+void gldi_task_set_slack (GldiTask *pTask, int iSlack)
+{
+	g_return_if_fail (pTask != NULL && iSlack >= 0);
+	pTask->iSlack = MIN (iSlack, GLDI_TASK_MAX_SLACK);
+	
+	if (pTask->iWheelSlot >= 0)  // re-schedule the next iteration with the new slack.
+		_restart_timer_with_frequency (pTask, pTask->iWheelPeriod);
+}
+
+
+guint gldi_task_get_nb_wheel_wakeups (void)
+{
+	return s_iNbWheelWakeups;
+}
+
+guint gldi_task_get_nb_completion_wakeups (void)
+{
+	return s_iNbCompletionWakeups;
+}
+
+
+  /////////////////
+ /// BENCHMARK ///
+/////////////////
+
+static GList *s_pBenchmarkTasks = NULL;
+static guint s_iNbBenchmarkIterations = 0;
+
+static void _benchmark_get_data (gpointer pDuration)  // thread
+{
+	g_usleep (GPOINTER_TO_INT (pDuration) * 1000);  // a slow job, like reading a file or querying a server.
+}
+
+static gboolean _benchmark_update (G_GNUC_UNUSED gpointer pDuration)
+{
+	s_iNbBenchmarkIterations ++;
+	return TRUE;
+}
+
+void gldi_task_start_benchmark (int iNbTasks, int iPeriod, int iJobDuration)
+{
+	gldi_task_stop_benchmark ();
+	GldiTask *pTask;
+	int i;
+	for (i = 0; i < iNbTasks; i ++)
+	{
+		pTask = gldi_task_new (iPeriod, (GldiGetDataAsyncFunc) _benchmark_get_data, (GldiUpdateSyncFunc) _benchmark_update, GINT_TO_POINTER (iJobDuration));
+		gldi_task_launch_delayed (pTask, (i * 1000. / iNbTasks) * iPeriod);  // spread the tasks over a period, like applets started at different moments.
+		s_pBenchmarkTasks = g_list_prepend (s_pBenchmarkTasks, pTask);
+	}
+}
+
+guint gldi_task_stop_benchmark (void)
+{
+	g_list_free_full (s_pBenchmarkTasks, (GDestroyNotify) gldi_task_free);
+	s_pBenchmarkTasks = NULL;
+	guint iNbIterations = s_iNbBenchmarkIterations;
+	s_iNbBenchmarkIterations = 0;
+	return iNbIterations;
+}
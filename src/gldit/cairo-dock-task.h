@@ -27,7 +27,7 @@ G_BEGIN_DECLS
 *@file cairo-dock-task.h An easy way to define periodic and asynchronous tasks, that can perform heavy jobs without blocking the dock.
  *
  *  A Task is divided in 2 phases : 
- * - the asynchronous phase will be executed in another thread, while the dock continues to run on its own thread, in parallel. During this phase you will do all the heavy job (like downloading a file or computing something) but you can't interact on the dock.
+ * - the asynchronous phase will be executed by a thread of a pool shared by all the Tasks, while the dock continues to run on its own thread, in parallel. During this phase you will do all the heavy job (like downloading a file or computing something) but you can't interact on the dock.
  * - the synchronous phase will be executed after the first one has finished. There you will update your applet with the result of the first phase.
  * 
  * \attention A data buffer is used to communicate between the 2 phases. It is important that these datas are never accessed outside the task, and vice versa that the asynchronous thread never accesses other data than this buffer.\n
@@ -73,19 +73,26 @@ struct _GldiTask {
 	double fElapsedTime;
 	// function called when the task is destroyed to free the shared memory (optionnal).
 	GFreeFunc free_data;
+	// slot of the timer wheel holding the Task, or -1 if it's not scheduled.
+	gint iWheelSlot;
+	// period of the Task in the wheel, according to its frequency state.
+	guint iWheelPeriod;
+	// time in seconds the Task accepts to be delayed, to be run along with other Tasks.
+	guint iSlack;
+	// tick at which the next iteration is due.
+	gint64 iDueTick;
+	// tick at which the next iteration will be run at the latest (due tick + slack).
+	gint64 iExpiryTick;
 	// below are the parameters accessed inside the thread => only between mutex lock/unlock
 	/// structure passed as parameter of the 'get_data' and 'update' functions. Must not be accessed outside of these 2 functions !
 	gpointer pSharedMemory;
-	// ID of the idle source to perform the update.
-	gint iSidUpdateIdle;
 	/// TRUE when the task has been discarded.
 	gboolean bDiscard;
 	gboolean bNeedsUpdate;  // TRUE when new data are waiting to be processed.
 	gboolean bContinue;  // result of the 'update' function (TRUE -> continue, FALSE -> stop, if the task is periodic).
-	GThread *pThread;  // the thread that execute the asynchronous 'get_data' callback
-	GCond *pCond;  // condition to awake the thread (if periodic).
-	gboolean bRunThread;  // condition value: whether to run the thread or exit.
-	GMutex *pMutex;  // mutex associated with the condition.
+	gboolean bQueued;  // TRUE while the task is in the hands of the pool of threads (waiting in the queue or executing the 'get_data' callback).
+	GCond *pCond;  // condition signaled when the pool is done with the task.
+	GMutex *pMutex;  // mutex held by the worker while it executes the task, associated with the condition.
 } ;
 
 
@@ -166,10 +173,38 @@ void gldi_task_downgrade_frequency (GldiTask *pTask);
 */
 void gldi_task_set_normal_frequency (GldiTask *pTask);
 
+/** Let a periodic Task be delayed by a few seconds, so that it can be run along with other Tasks and wake up the dock less often. Tasks in a downgraded frequency state automatically accept a delay of 1/10 of their period.
+*@param pTask the periodic Task.
+*@param iSlack maximum delay in s (capped to 63), 0 to run the Task on time (default).
+*/
+void gldi_task_set_slack (GldiTask *pTask, int iSlack);
+
 /** Get the time elapsed since the last time the Task has run.
 *@param pTask the periodic Task.
 */
 #define gldi_task_get_elapsed_time(pTask) (pTask->fElapsedTime)
 
+/** Get the number of times the timer shared by the periodic Tasks has woken up the dock since the beginning. Since the Tasks are grouped on the same timer, it's at most once per second, whatever the number of Tasks.
+*@return number of wakeups.
+*/
+guint gldi_task_get_nb_wheel_wakeups (void);
+
+/** Get the number of times the main loop has been woken up to update the Tasks whose asynchronous part is over. Several Tasks completing at the same time only cost 1 wakeup.
+*@return number of wakeups.
+*/
+guint gldi_task_get_nb_completion_wakeups (void);
+
+/** Launch a number of periodic Tasks that do nothing but wait in their asynchronous part, to measure the cost of the Tasks on the main loop. Their first iterations are spread over a period. Any previous benchmark is stopped.
+*@param iNbTasks number of Tasks.
+*@param iPeriod period of the Tasks, in s.
+*@param iJobDuration time spent in the asynchronous part, in ms.
+*/
+void gldi_task_start_benchmark (int iNbTasks, int iPeriod, int iJobDuration);
+
+/** Stop and destroy the Tasks of the benchmark.
+*@return the number of iterations they have completed.
+*/
+guint gldi_task_stop_benchmark (void);
+
 G_END_DECLS
 #endif
@@ -28,19 +28,24 @@ GldiObjectManager myWindowObjectMgr;
 // dependancies
 
 // private
-GList *s_pWindowsList = NULL;  // list of all window actors
-static gboolean s_bSortedByZ = FALSE;  // whether the list is currently sorted by z-order
-static gboolean s_bSortedByAge = FALSE;  // whether the list is currently sorted by age
+typedef struct {
+	GldiWindowActor *actor;
+	GSequenceIter *pZIter;  // position in the z-ordered sequence
+	GSequenceIter *pAgeIter;  // position in the age-ordered sequence
+	gboolean bPending;  // TRUE if it has to be re-indexed
+	} GldiWindowEntry;
+
+static GHashTable *s_hWindowEntries = NULL;  // actor -> entry
+static GSequence *s_pWindowsByZ = NULL;  // all window actors, sorted by z-order
+static GSequence *s_pWindowsByAge = NULL;  // all window actors, sorted by age
+static GPtrArray *s_pPendingWindows = NULL;  // entries whose actor changed since it was indexed
+static gint s_iNbIterations = 0;  // > 0 while iterating on the indexes, which must not be modified meanwhile
+static gboolean s_bLastOrderedByZ = FALSE;  // order of the last gldi_windows_foreach, also used by gldi_windows_find
+static gboolean s_bBackendTellsRestacked = FALSE;  // TRUE if the backend sends NOTIFICATION_WINDOW_RESTACKED
 static GldiWindowManagerBackend s_backend;
 
 
-static gboolean on_zorder_changed (G_GNUC_UNUSED gpointer data)
-{
-	s_bSortedByZ = FALSE;  // invalidate the sorting
-	return GLDI_NOTIFICATION_LET_PASS;
-}
-
-static int _compare_z_order (GldiWindowActor *actor1, GldiWindowActor *actor2)
+static int _compare_z_order (GldiWindowActor *actor1, GldiWindowActor *actor2, G_GNUC_UNUSED gpointer data)
 {
 	if (actor1->iStackOrder < actor2->iStackOrder)
 		return -1;
@@ -50,7 +55,7 @@ static int _compare_z_order (GldiWindowActor *actor1, GldiWindowActor *actor2)
 		return 0;
 }
 
-static int _compare_age (GldiWindowActor *actor1, GldiWindowActor *actor2)
+static int _compare_age (GldiWindowActor *actor1, GldiWindowActor *actor2, G_GNUC_UNUSED gpointer data)
 {
 	if (actor1->iAge < actor2->iAge)
 		return -1;
@@ -60,34 +65,128 @@ static int _compare_age (GldiWindowActor *actor1, GldiWindowActor *actor2)
 		return 0;
 }
 
-void gldi_windows_foreach (gboolean bOrderedByZ, GFunc callback, gpointer data)
+static void _invalidate_window (GldiWindowActor *actor)
+{
+	GldiWindowEntry *pEntry = g_hash_table_lookup (s_hWindowEntries, actor);
+	if (pEntry != NULL && ! pEntry->bPending)
+	{
+		pEntry->bPending = TRUE;
+		g_ptr_array_add (s_pPendingWindows, pEntry);
+	}
+}
+
+static void _unindex_window (GldiWindowEntry *pEntry)
+{
+	if (pEntry->pZIter == NULL)  // not indexed yet
+		return;
+	g_sequence_remove (pEntry->pZIter);
+	g_sequence_remove (pEntry->pAgeIter);
+	pEntry->pZIter = pEntry->pAgeIter = NULL;
+}
+
+static void _index_window (GldiWindowEntry *pEntry)
+{
+	GldiWindowActor *actor = pEntry->actor;
+	pEntry->pZIter = g_sequence_insert_sorted (s_pWindowsByZ, actor, (GCompareDataFunc)_compare_z_order, NULL);
+	pEntry->pAgeIter = g_sequence_insert_sorted (s_pWindowsByAge, actor, (GCompareDataFunc)_compare_age, NULL);
+}
+
+// bring the indexes up-to-date; the actors are only re-indexed when they're needed, because their properties are usually set after they are created, and because the backend changes the z-order of several windows at once.
+static void _update_windows_registry (void)
 {
-	if (bOrderedByZ && ! s_bSortedByZ)
+	if (s_pPendingWindows->len == 0 || s_iNbIterations > 0)  // if called from a callback, the current order is good enough; the changes will be applied once the iteration is over.
+		return;
+	// first take all the modified actors out, so that the remaining ones are consistently sorted while inserting them back.
+	guint i;
+	GldiWindowEntry *pEntry;
+	for (i = 0; i < s_pPendingWindows->len; i ++)
 	{
-		s_pWindowsList = g_list_sort (s_pWindowsList, (GCompareFunc)_compare_z_order);
-		s_bSortedByZ = TRUE;
-		s_bSortedByAge = FALSE;
+		pEntry = g_ptr_array_index (s_pPendingWindows, i);
+		_unindex_window (pEntry);
 	}
-	else if (! bOrderedByZ && ! s_bSortedByAge)
+	for (i = 0; i < s_pPendingWindows->len; i ++)
 	{
-		s_pWindowsList = g_list_sort (s_pWindowsList, (GCompareFunc)_compare_age);
-		s_bSortedByAge = TRUE;
-		s_bSortedByZ = FALSE;
+		pEntry = g_ptr_array_index (s_pPendingWindows, i);
+		_index_window (pEntry);
+		pEntry->bPending = FALSE;
 	}
-	g_list_foreach (s_pWindowsList, callback, data);
+	g_ptr_array_set_size (s_pPendingWindows, 0);
 }
 
-GldiWindowActor *gldi_windows_find (gboolean (*callback) (GldiWindowActor*, gpointer), gpointer data)
+static gboolean on_window_restacked (G_GNUC_UNUSED gpointer data, GldiWindowActor *actor)
 {
-	GldiWindowActor *actor;
-	GList *a;
-	for (a = s_pWindowsList; a != NULL; a = a->next)
+	s_bBackendTellsRestacked = TRUE;
+	_invalidate_window (actor);
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+
+static gboolean on_zorder_changed (G_GNUC_UNUSED gpointer data, G_GNUC_UNUSED GldiWindowActor *actor)
+{
+	if (! s_bBackendTellsRestacked)  // we don't know which windows have moved
 	{
-		actor = a->data;
-		if (callback (actor, data))
-			return actor;
+		GHashTableIter iter;
+		gpointer key;
+		g_hash_table_iter_init (&iter, s_hWindowEntries);
+		while (g_hash_table_iter_next (&iter, &key, NULL))
+			_invalidate_window (key);
 	}
-	return NULL;
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+
+static gboolean on_window_destroyed (G_GNUC_UNUSED gpointer data, GldiWindowActor *actor)
+{
+	_invalidate_window (actor);  // the actor may survive it, if the backend just ignores the window from now on; its z-order has changed then.
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+
+static void _end_iteration (void)
+{
+	s_iNbIterations --;
+	if (s_iNbIterations == 0)
+		_update_windows_registry ();  // apply the changes that occured during the iteration
+}
+
+static void _foreach_in_sequence (GSequence *pSeq, GFunc callback, gpointer data)
+{
+	s_iNbIterations ++;
+	GSequenceIter *iter = g_sequence_get_begin_iter (pSeq), *next;
+	while (! g_sequence_iter_is_end (iter))
+	{
+		next = g_sequence_iter_next (iter);  // the callback may destroy the actor
+		callback (g_sequence_get (iter), data);
+		iter = next;
+	}
+	_end_iteration ();
+}
+
+static GldiWindowActor *_find_in_sequence (GSequence *pSeq, gboolean (*callback) (GldiWindowActor*, gpointer), gpointer data)
+{
+	GldiWindowActor *actor = NULL;
+	s_iNbIterations ++;
+	GSequenceIter *iter;
+	for (iter = g_sequence_get_begin_iter (pSeq); ! g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter))
+	{
+		if (callback (g_sequence_get (iter), data))
+		{
+			actor = g_sequence_get (iter);
+			break;
+		}
+	}
+	_end_iteration ();
+	return actor;
+}
+
+void gldi_windows_foreach (gboolean bOrderedByZ, GFunc callback, gpointer data)
+{
+	_update_windows_registry ();
+	s_bLastOrderedByZ = bOrderedByZ;
+	_foreach_in_sequence (bOrderedByZ ? s_pWindowsByZ : s_pWindowsByAge, callback, data);
+}
+
+GldiWindowActor *gldi_windows_find (gboolean (*callback) (GldiWindowActor*, gpointer), gpointer data)
+{
+	_update_windows_registry ();
+	return _find_in_sequence (s_bLastOrderedByZ ? s_pWindowsByZ : s_pWindowsByAge, callback, data);  // the windows used to be in a single list, sorted by the last foreach
 }
 
 
@@ -285,6 +384,22 @@ GldiWindowActor *gldi_window_pick (void)
 	return NULL;
 }
 
+void gldi_windows_get_new_windows_stats (guint *iNbWindows, gint64 *iTotalTime)
+{
+	*iNbWindows = 0;
+	*iTotalTime = 0;
+	if (s_backend.get_new_windows_stats)
+		s_backend.get_new_windows_stats (iNbWindows, iTotalTime);
+}
+
+void gldi_windows_get_events_stats (gulong *iNbEvents, gulong *iNbCoalescedEvents)
+{
+	*iNbEvents = 0;
+	*iNbCoalescedEvents = 0;
+	if (s_backend.get_events_stats)
+		s_backend.get_events_stats (iNbEvents, iNbCoalescedEvents);
+}
+
 
   /////////////////
  /// UTILITIES ///
@@ -348,7 +463,10 @@ void gldi_window_move_to_current_desktop (GldiWindowActor *pAppli)
 static void init_object (GldiObject *obj, G_GNUC_UNUSED gpointer attr)
 {
 	GldiWindowActor *actor = (GldiWindowActor*)obj;
-	s_pWindowsList = g_list_prepend (s_pWindowsList, actor);
+	GldiWindowEntry *pEntry = g_new0 (GldiWindowEntry, 1);
+	pEntry->actor = actor;
+	g_hash_table_insert (s_hWindowEntries, actor, pEntry);
+	_invalidate_window (actor);  // the backend fills the actor after this, so index it later
 }
 
 static void reset_object (GldiObject *obj)
@@ -358,7 +476,15 @@ static void reset_object (GldiObject *obj)
 	g_free (actor->cClass);
 	g_free (actor->cWmClass);
 	g_free (actor->cLastAttentionDemand);
-	s_pWindowsList = g_list_remove (s_pWindowsList, actor);
+	
+	GldiWindowEntry *pEntry = g_hash_table_lookup (s_hWindowEntries, actor);
+	if (pEntry != NULL)
+	{
+		_unindex_window (pEntry);
+		if (pEntry->bPending)
+			g_ptr_array_remove_fast (s_pPendingWindows, pEntry);
+		g_hash_table_remove (s_hWindowEntries, actor);  // frees the entry
+	}
 }
 
 void gldi_register_windows_manager (void)
@@ -375,9 +501,21 @@ void gldi_register_windows_manager (void)
 	
 	// init
 	memset (&s_backend, 0, sizeof (GldiWindowManagerBackend));
+	s_hWindowEntries = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+	s_pWindowsByZ = g_sequence_new (NULL);
+	s_pWindowsByAge = g_sequence_new (NULL);
+	s_pPendingWindows = g_ptr_array_new ();
 	gldi_object_register_notification (&myWindowObjectMgr,
 		NOTIFICATION_WINDOW_Z_ORDER_CHANGED,
 		(GldiNotificationFunc) on_zorder_changed,
 		GLDI_RUN_FIRST, NULL);
+	gldi_object_register_notification (&myWindowObjectMgr,
+		NOTIFICATION_WINDOW_RESTACKED,
+		(GldiNotificationFunc) on_window_restacked,
+		GLDI_RUN_FIRST, NULL);
+	gldi_object_register_notification (&myWindowObjectMgr,
+		NOTIFICATION_WINDOW_DESTROYED,
+		(GldiNotificationFunc) on_window_destroyed,
+		GLDI_RUN_FIRST, NULL);
 }
 
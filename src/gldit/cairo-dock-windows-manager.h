@@ -48,6 +48,7 @@ typedef enum {
 	NOTIFICATION_WINDOW_Z_ORDER_CHANGED,
 	NOTIFICATION_WINDOW_ACTIVATED,
 	NOTIFICATION_WINDOW_DESKTOP_CHANGED,
+	NOTIFICATION_WINDOW_RESTACKED,  // a window has moved in the stack (or just appeared); sent for each of them before NOTIFICATION_WINDOW_Z_ORDER_CHANGED, by the backends that can tell.
 	NB_NOTIFICATIONS_WINDOWS
 	} GldiWindowNotifications;
 
@@ -78,6 +79,8 @@ struct _GldiWindowManagerBackend {
 	void (*can_minimize_maximize_close) (GldiWindowActor *actor, gboolean *bCanMinimize, gboolean *bCanMaximize, gboolean *bCanClose);
 	guint (*get_id) (GldiWindowActor *actor);
 	GldiWindowActor* (*pick_window) (void);  // grab the mouse, wait for a click, then get the clicked window and returns its actor
+	void (*get_new_windows_stats) (guint *iNbWindows, gint64 *iTotalTime);  // number of new windows inspected since the beginning, and time spent to make their actors (in us)
+	void (*get_events_stats) (gulong *iNbEvents, gulong *iNbCoalescedEvents);  // number of events received from the window system since the beginning, and how many of them were dropped because a later one superseded them
 	} ;
 
 /// Definition of a window actor.
@@ -170,6 +173,18 @@ guint gldi_window_get_id (GldiWindowActor *pAppli);
 
 GldiWindowActor *gldi_window_pick (void);
 
+/** Get the number of new windows inspected by the backend since the beginning, and the time spent to fetch their properties and make their actors, round-trips included.
+*@param iNbWindows returns the number of windows
+*@param iTotalTime returns the time, in us
+*/
+void gldi_windows_get_new_windows_stats (guint *iNbWindows, gint64 *iTotalTime);
+
+/** Get the number of events received by the backend from the window system since the beginning, and how many of them were not handled because a later event of the same kind on the same window superseded them.
+*@param iNbEvents returns the number of events received
+*@param iNbCoalescedEvents returns the number of events dropped
+*/
+void gldi_windows_get_events_stats (gulong *iNbEvents, gulong *iNbCoalescedEvents);
+
 
 void gldi_register_windows_manager (void);
 
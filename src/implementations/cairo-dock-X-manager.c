@@ -86,9 +86,13 @@ static Atom s_aNetStartupInfoBegin;
 static Atom s_aNetStartupInfo;
 static GHashTable *s_hXWindowTable = NULL;  // table of (Xid,actor)
 static GHashTable *s_hXClientMessageTable = NULL;  // table of (Xid,client-message)
-static int s_iTime = 1;  // on peut aller jusqu'a 2^31, soit 17 ans a 4Hz.
 static int s_iNumWindow = 1;  // used to order appli icons by age (=creation date).
 static Window s_iCurrentActiveWindow = 0;
+static XEvent *s_pCoalescedXEvents = NULL;  // events taken from the queue, once merged
+static gulong s_iNbXEvents = 0;  // number of events received
+static gulong s_iNbCoalescedXEvents = 0;  // number of events dropped because a later one superseded them
+static guint s_iNbNewWindows = 0;  // number of new windows inspected
+static gint64 s_iNewWindowsTime = 0;  // time spent to get their properties and make their actors, in us
 static guint num_lock_mask=0, caps_lock_mask=0, scroll_lock_mask=0;
 static GPollFD s_poll_fd;
 
@@ -108,7 +112,7 @@ struct _GldiXWindowActor {
 	GldiWindowActor actor;
 	// X-specific
 	Window Xid;
-	gint iLastCheckTime;
+	gint iLastCheckTime;  // -1 once it has been removed from the table
 	Pixmap iBackingPixmap;
 	Window XTransientFor;
 	guint iDemandsAttention;  // a mask of XAttentionFlag
@@ -116,7 +120,45 @@ struct _GldiXWindowActor {
 	};
 
 
-static GldiXWindowActor *_make_new_actor (Window Xid)
+  //////////////////
+ /// STACK DIFF ///
+//////////////////
+
+typedef struct {
+	Window Xid;
+	GldiXWindowActor *actor;  // NULL if the actor has been destroyed since the snapshot was taken
+	gint iStackOrder;  // position in the client list
+	gint iOldStackOrder;  // position in the previous client list, -1 if the window was not known
+	} GldiXStackEntry;
+
+static GldiXStackEntry *s_pStack = NULL;  // last snapshot of the client list, sorted by Xid
+static gulong s_iNbStackEntries = 0;
+
+static int _compare_stack_entries (const GldiXStackEntry *e1, const GldiXStackEntry *e2)
+{
+	return (e1->Xid < e2->Xid ? -1 : (e1->Xid > e2->Xid ? 1 : 0));
+}
+
+static GldiXStackEntry *_find_stack_entry (Window Xid)
+{
+	GldiXStackEntry key = {Xid, NULL, 0, 0};
+	return bsearch (&key, s_pStack, s_iNbStackEntries, sizeof (GldiXStackEntry), (GCompareFunc)_compare_stack_entries);
+}
+
+static void _forget_stacked_window (GldiXWindowActor *actor)
+{
+	GldiXStackEntry *e = _find_stack_entry (actor->Xid);
+	if (e != NULL && e->actor == actor)
+		e->actor = NULL;  // the next diff will look it up again
+}
+
+typedef struct {
+	Window Xid;
+	CairoDockXWindowProperties *pProps;  // NULL if the properties have to be fetched one by one
+	} GldiXWindowActorAttr;
+
+// pProps holds the properties fetched beforehand along with the other new windows, or is NULL if they have to be fetched one by one.
+static GldiXWindowActor *_make_new_actor (Window Xid, CairoDockXWindowProperties *pProps)
 {
 	GldiXWindowActor *xactor;
 	gboolean bShowInTaskbar = FALSE;
@@ -126,41 +168,76 @@ static GldiXWindowActor *_make_new_actor (Window Xid)
 	gboolean bIsHidden = FALSE, bIsFullScreen = FALSE, bIsMaximized = FALSE, bDemandsAttention = FALSE;
 	
 	//\__________________ see if we should skip it
-	// check its 'skip taskbar' property
-	bShowInTaskbar = cairo_dock_xwindow_is_fullscreen_or_hidden_or_maximized (Xid, &bIsFullScreen, &bIsHidden, &bIsMaximized, &bDemandsAttention);
-	
-	if (bShowInTaskbar)
+	if (pProps != NULL)  // same tests as below, on the properties we already have
 	{
-		// check its type
-		bNormalWindow = cairo_dock_get_xwindow_type (Xid, &iTransientFor);
-		if (bNormalWindow || iTransientFor != None)
+		bShowInTaskbar = pProps->bShowInTaskbar;
+		bIsFullScreen = pProps->bIsFullScreen;
+		bIsHidden = pProps->bIsHidden;
+		bIsMaximized = pProps->bIsMaximized;
+		bDemandsAttention = pProps->bDemandsAttention;
+		bNormalWindow = pProps->bNormalWindow;
+		iTransientFor = pProps->iTransientFor;
+		if (bShowInTaskbar)
 		{
-			// check get its class
-			cClass = cairo_dock_get_xwindow_class (Xid, &cWmClass);
-			if (cClass == NULL)
+			if (! bNormalWindow && iTransientFor == None)
+			{
+				cd_debug ("unwanted type -> ignore this window");
+				bShowInTaskbar = FALSE;
+			}
+			else if (pProps->cClass == NULL)
 			{
-				gchar *cName = cairo_dock_get_xwindow_name (Xid, TRUE);
 				cd_warning ("this window (%s, %ld) doesn't belong to any class, skip it.\n"
-					"Please report this bug to the application's devs.", cName, Xid);
-				g_free (cName);
+					"Please report this bug to the application's devs.", pProps->cName, Xid);
 				bShowInTaskbar = FALSE;
 			}
-		}
-		else
-		{
-			cd_debug ("unwanted type -> ignore this window");
-			bShowInTaskbar = FALSE;
+			else  // take the class, the rest will be freed with the properties
+			{
+				cClass = pProps->cClass;
+				pProps->cClass = NULL;
+				cWmClass = pProps->cWmClass;
+				pProps->cWmClass = NULL;
+			}
 		}
 	}
 	else
 	{
-		XGetTransientForHint (s_XDisplay, Xid, &iTransientFor);
+		// check its 'skip taskbar' property
+		bShowInTaskbar = cairo_dock_xwindow_is_fullscreen_or_hidden_or_maximized (Xid, &bIsFullScreen, &bIsHidden, &bIsMaximized, &bDemandsAttention);
+		
+		if (bShowInTaskbar)
+		{
+			// check its type
+			bNormalWindow = cairo_dock_get_xwindow_type (Xid, &iTransientFor);
+			if (bNormalWindow || iTransientFor != None)
+			{
+				// check get its class
+				cClass = cairo_dock_get_xwindow_class (Xid, &cWmClass);
+				if (cClass == NULL)
+				{
+					gchar *cName = cairo_dock_get_xwindow_name (Xid, TRUE);
+					cd_warning ("this window (%s, %ld) doesn't belong to any class, skip it.\n"
+						"Please report this bug to the application's devs.", cName, Xid);
+					g_free (cName);
+					bShowInTaskbar = FALSE;
+				}
+			}
+			else
+			{
+				cd_debug ("unwanted type -> ignore this window");
+				bShowInTaskbar = FALSE;
+			}
+		}
+		else
+		{
+			XGetTransientForHint (s_XDisplay, Xid, &iTransientFor);
+		}
 	}
 	
 	//\__________________ if the window passed all the tests, make a new actor
 	if (bShowInTaskbar)  // make a new actor and fill the properties we got before
 	{
-		xactor = (GldiXWindowActor*)gldi_object_new (&myXObjectMgr, &Xid);
+		GldiXWindowActorAttr attr = {Xid, pProps};
+		xactor = (GldiXWindowActor*)gldi_object_new (&myXObjectMgr, &attr);
 		GldiWindowActor *actor = (GldiWindowActor*)xactor;
 		actor->bDisplayed = bNormalWindow;
 		actor->cClass = cClass;
@@ -184,7 +261,7 @@ static GldiXWindowActor *_make_new_actor (Window Xid)
 	}
 	xactor->XTransientFor = iTransientFor;
 	((GldiWindowActor*)xactor)->bIsTransientFor = (iTransientFor != None);
-	xactor->iLastCheckTime = s_iTime;
+	xactor->iLastCheckTime = 0;
 	return xactor;
 }
 
@@ -195,6 +272,7 @@ static void _delete_actor (GldiXWindowActor *actor)
 		// remove from table
 		if (actor->iLastCheckTime != -1)  // if not already removed
 			g_hash_table_remove (s_hXWindowTable, &actor->Xid);
+		_forget_stacked_window (actor);
 		g_free (actor);
 	}
 	else
@@ -260,63 +338,191 @@ static void _update_backing_pixmap (GldiXWindowActor *actor)
 #endif
 }
 
-static gboolean _remove_old_applis (Window *Xid, GldiXWindowActor *actor, gpointer iTimePtr)
+static GldiXStackEntry *_make_stack_snapshot (const Window *pXWindowsList, gulong iNbWindows)
 {
-	gint iTime = GPOINTER_TO_INT (iTimePtr);
-	if (actor->iLastCheckTime >= 0 && actor->iLastCheckTime < iTime)
+	GldiXStackEntry *pEntries = g_new (GldiXStackEntry, iNbWindows);
+	gulong i;
+	for (i = 0; i < iNbWindows; i ++)
 	{
-		cd_message ("cette fenetre (%ld, %p, %s) est trop vieille (%d / %d)", *Xid, actor, actor->actor.cName, actor->iLastCheckTime, iTime);
-		// notify everybody
-		if (! actor->bIgnored)
-			gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_DESTROYED, actor);
-		
-		actor->iLastCheckTime = -1;  // to not remove it from the table during the free
-		_delete_actor (actor);
-		return TRUE;  // remove it from the table
+		pEntries[i].Xid = pXWindowsList[i];
+		pEntries[i].actor = NULL;
+		pEntries[i].iStackOrder = i;
+		pEntries[i].iOldStackOrder = -1;
 	}
-	return FALSE;
+	qsort (pEntries, iNbWindows, sizeof (GldiXStackEntry), (GCompareFunc)_compare_stack_entries);
+	return pEntries;
+}
+
+// among the windows that were already there (given in their new order), find the ones that really moved, i.e. the ones that are not in the longest sequence which kept its previous relative order.
+static void _find_moved_windows (GldiXStackEntry **pKept, gulong n, gboolean *bMoved)
+{
+	if (n == 0)
+		return;
+	gulong *pTails = g_new (gulong, n);  // pTails[k] = index of the smallest end of an increasing sequence of length k+1
+	gulong *pPrev = g_new (gulong, n);
+	gulong i, iLength = 0;
+	for (i = 0; i < n; i ++)
+	{
+		bMoved[i] = TRUE;
+		gulong a = 0, b = iLength;
+		while (a < b)
+		{
+			gulong m = (a + b) / 2;
+			if (pKept[pTails[m]]->iOldStackOrder < pKept[i]->iOldStackOrder)
+				a = m + 1;
+			else
+				b = m;
+		}
+		pPrev[i] = (a > 0 ? pTails[a-1] : i);
+		pTails[a] = i;
+		if (a == iLength)
+			iLength ++;
+	}
+	for (i = pTails[iLength-1]; ; i = pPrev[i])
+	{
+		bMoved[i] = FALSE;
+		if (pPrev[i] == i)
+			break;
+	}
+	g_free (pTails);
+	g_free (pPrev);
 }
+
 static void _on_update_applis_list (void)
 {
-	s_iTime ++;
 	// get all windows sorted by z-order
-	gulong i, iNbWindows = 0;
+	gulong i, j, iNbWindows = 0;
 	Window *pXWindowsList = cairo_dock_get_windows_list (&iNbWindows, TRUE);  // TRUE => ordered by z-stack.
 	
-	// set the z-order of existing windows, and create actors for new windows
-	Window Xid;
-	GldiXWindowActor *actor;
+	// diff it against the previous snapshot: both are sorted by Xid, so a single merge gives the windows that appeared, disappeared or stayed.
+	GldiXStackEntry *pEntries = _make_stack_snapshot (pXWindowsList, iNbWindows);
+	Window *pRemovedXids = g_new (Window, s_iNbStackEntries + 1);
+	gulong iNbRemoved = 0;
+	for (i = 0, j = 0; i < iNbWindows || j < s_iNbStackEntries; )
+	{
+		if (j == s_iNbStackEntries || (i < iNbWindows && pEntries[i].Xid < s_pStack[j].Xid))  // appeared
+		{
+			i ++;
+		}
+		else if (i == iNbWindows || pEntries[i].Xid > s_pStack[j].Xid)  // disappeared
+		{
+			pRemovedXids[iNbRemoved ++] = s_pStack[j].Xid;
+			j ++;
+		}
+		else  // still there
+		{
+			pEntries[i].actor = s_pStack[j].actor;
+			pEntries[i].iOldStackOrder = s_pStack[j].iStackOrder;
+			i ++, j ++;
+		}
+	}
+	g_free (s_pStack);
+	s_pStack = pEntries;
+	s_iNbStackEntries = iNbWindows;
+	
+	// go back to the z-order; windows without actor are new, or their actor was dropped meanwhile.
+	GldiXStackEntry **pByZ = g_new (GldiXStackEntry*, iNbWindows + 1);
+	for (i = 0; i < iNbWindows; i ++)
+		pByZ[pEntries[i].iStackOrder] = &pEntries[i];
+	
+	Window *pNewXids = g_new (Window, iNbWindows + 1);
+	gulong iNbNewWindows = 0;
+	GldiXStackEntry *e;
+	for (i = 0; i < iNbWindows; i ++)
+	{
+		e = pByZ[i];
+		if (e->actor == NULL)
+		{
+			e->actor = g_hash_table_lookup (s_hXWindowTable, &e->Xid);
+			if (e->actor == NULL)
+				pNewXids[iNbNewWindows ++] = e->Xid;
+		}
+	}
+	
+	// fetch the properties of the new windows all at once, rather than one round-trip at a time, and make their actors.
+	gint64 t0 = g_get_monotonic_time ();
+	CairoDockXWindowProperties *pProps = cairo_dock_fetch_xwindows_properties (pNewXids, iNbNewWindows);
+	GldiXWindowActor **pCreated = g_new (GldiXWindowActor*, iNbNewWindows + 1);
+	for (i = 0, j = 0; i < iNbWindows; i ++)
+	{
+		e = pByZ[i];
+		if (e->actor == NULL)
+		{
+			cd_message (" cette fenetre (%ld) de la pile n'est pas dans la liste", e->Xid);
+			e->actor = _make_new_actor (e->Xid, pProps ? &pProps[j] : NULL);  // new windows come in the same order as in pNewXids
+			pCreated[j ++] = e->actor;
+			e->iOldStackOrder = -1;
+		}
+	}
+	cairo_dock_free_xwindows_properties (pProps, iNbNewWindows);
+	g_free (pNewXids);
+	s_iNbNewWindows += iNbNewWindows;
+	s_iNewWindowsTime += g_get_monotonic_time () - t0;
+	
+	// set the z-order of the windows; it only changes silently for the windows that kept their relative order.
+	GldiXStackEntry **pKept = g_new (GldiXStackEntry*, iNbWindows + 1);
+	gulong iNbKept = 0;
 	int iStackOrder = 0;
 	for (i = 0; i < iNbWindows; i ++)
 	{
-		Xid = pXWindowsList[i];
-		
-		// check if the window is already known
-		actor = g_hash_table_lookup (s_hXWindowTable, &Xid);
-		if (actor == NULL)
+		e = pByZ[i];
+		if (e->actor == NULL)
+			continue;
+		if (e->actor->bIgnored)  // ignored windows are never restacked, so they must not keep an order that would be stale among the others: they all stay below.
 		{
-			// create a window actor
-			cd_message (" cette fenetre (%ld) de la pile n'est pas dans la liste", Xid);
-			actor = _make_new_actor (Xid);
-			
-			// notify everybody
-			if (! actor->bIgnored)
-				gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_CREATED, actor);
+			e->actor->actor.iStackOrder = -1;
+			continue;
 		}
-		else  // just update its check-time
-			actor->iLastCheckTime = s_iTime;
-		
-		// update the z-order
-		if (! actor->bIgnored)
-			actor->actor.iStackOrder = iStackOrder ++;
+		e->actor->actor.iStackOrder = iStackOrder ++;
+		if (e->iOldStackOrder >= 0)
+			pKept[iNbKept ++] = e;
 	}
+	gboolean *bMoved = g_new (gboolean, iNbKept + 1);
+	_find_moved_windows (pKept, iNbKept, bMoved);
+	
+	// notify everybody about the new windows; from now on, listeners may destroy actors, so only rely on the snapshot (which is kept up-to-date).
+	for (i = 0; i < j; i ++)
+	{
+		if (! pCreated[i]->bIgnored)
+			gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_CREATED, pCreated[i]);
+	}
+	g_free (pCreated);
 	
 	// remove old actors for windows that disappeared
-	g_hash_table_foreach_remove (s_hXWindowTable, (GHRFunc) _remove_old_applis, GINT_TO_POINTER (s_iTime));
+	GldiXWindowActor *actor;
+	for (i = 0; i < iNbRemoved; i ++)
+	{
+		actor = g_hash_table_lookup (s_hXWindowTable, &pRemovedXids[i]);
+		if (actor == NULL)  // already gone
+			continue;
+		cd_message ("cette fenetre (%ld, %p, %s) a disparu", actor->Xid, actor, actor->actor.cName);
+		// notify everybody
+		if (! actor->bIgnored)
+			gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_DESTROYED, actor);
+		
+		g_hash_table_remove (s_hXWindowTable, &pRemovedXids[i]);
+		actor->iLastCheckTime = -1;  // to not remove it from the table during the free
+		_delete_actor (actor);
+	}
+	g_free (pRemovedXids);
 	
-	// notify everybody that the stack order has changed
+	// tell which windows really moved in the stack (including the new ones), then that the stack has changed.
+	for (i = 0; i < iNbWindows; i ++)
+	{
+		e = pByZ[i];
+		if (e->actor != NULL && ! e->actor->bIgnored && e->iOldStackOrder < 0)
+			gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_RESTACKED, e->actor);
+	}
+	for (i = 0; i < iNbKept; i ++)
+	{
+		e = pKept[i];
+		if (bMoved[i] && e->actor != NULL && ! e->actor->bIgnored)
+			gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_RESTACKED, e->actor);
+	}
 	gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_Z_ORDER_CHANGED, NULL);
-	
+	g_free (bMoved);
+	g_free (pKept);
+	g_free (pByZ);
 	XFree (pXWindowsList);
 }
 
@@ -355,6 +561,72 @@ static void lookup_ignorable_modifiers (void)
 	scroll_lock_mask = XkbKeysymToModifiers (s_XDisplay, GDK_KEY_Scroll_Lock);
 }
 
+// events that only tell that something changed (the handler reads the new value from the server), so that only the last one of a kind per window matters.
+static inline gboolean _get_Xevent_key (XEvent *event, gint64 *iKey)
+{
+	if (event->type == PropertyNotify)
+		*iKey = ((gint64)event->xany.window << 32) | event->xproperty.atom;
+	else if (event->type == ConfigureNotify)
+		*iKey = ((gint64)event->xany.window << 32);  // None is not a valid atom, so it doesn't collide with a property
+	else
+		return FALSE;
+	return TRUE;
+}
+
+// drain the event queue, and drop the events that are superseded by a later one of the same kind on the same window; the order of the remaining events is kept.
+static int _coalesce_Xevents (int nb_msg)
+{
+	static XEvent *s_pXEvents = NULL;
+	static gint64 *s_pXEventKeys = NULL;
+	static gboolean *s_bDropXEvent = NULL;
+	static int s_iXEventsSize = 0;
+	static GHashTable *s_hXEventKeys = NULL;
+	if (nb_msg > s_iXEventsSize)
+	{
+		s_iXEventsSize = MAX (nb_msg, 2 * s_iXEventsSize);
+		s_pXEvents = g_renew (XEvent, s_pXEvents, s_iXEventsSize);
+		s_pXEventKeys = g_renew (gint64, s_pXEventKeys, s_iXEventsSize);
+		s_bDropXEvent = g_renew (gboolean, s_bDropXEvent, s_iXEventsSize);
+	}
+	if (s_hXEventKeys == NULL)
+		s_hXEventKeys = g_hash_table_new (g_int64_hash, g_int64_equal);
+	
+	int i, n = 0;
+	for (i = 0; i < nb_msg; i ++)
+		XNextEvent (s_XDisplay, &s_pXEvents[i]);
+	
+	// walk backwards, so that the first occurrence of a key is the one to keep.
+	gboolean *bDrop = s_bDropXEvent;
+	for (i = nb_msg - 1; i >= 0; i --)
+	{
+		bDrop[i] = FALSE;
+		if (! _get_Xevent_key (&s_pXEvents[i], &s_pXEventKeys[i]))
+			continue;
+		if (g_hash_table_lookup (s_hXEventKeys, &s_pXEventKeys[i]) != NULL)
+			bDrop[i] = TRUE;
+		else
+			g_hash_table_insert (s_hXEventKeys, &s_pXEventKeys[i], &s_pXEventKeys[i]);
+	}
+	g_hash_table_remove_all (s_hXEventKeys);
+	
+	for (i = 0; i < nb_msg; i ++)
+	{
+		if (! bDrop[i])
+		{
+			if (n != i)
+				s_pXEvents[n] = s_pXEvents[i];
+			n ++;
+		}
+	}
+	
+	s_iNbXEvents += nb_msg;
+	s_iNbCoalescedXEvents += nb_msg - n;
+	if (n != nb_msg)
+		cd_debug ("%d/%d X events coalesced (%lu/%lu so far)", nb_msg - n, nb_msg, s_iNbCoalescedXEvents, s_iNbXEvents);
+	s_pCoalescedXEvents = s_pXEvents;
+	return n;
+}
+
 static gboolean _cairo_dock_unstack_Xevents (G_GNUC_UNUSED gpointer data)
 {
 	static XEvent event;
@@ -369,10 +641,13 @@ static gboolean _cairo_dock_unstack_Xevents (G_GNUC_UNUSED gpointer data)
 	int i, nb_msg = XEventsQueued (s_XDisplay, QueuedAfterReading);
 	//g_print ("%d X msg\n", nb_msg);
 	
+	// take them all out of the queue at once, and merge the redundant ones
+	nb_msg = _coalesce_Xevents (nb_msg);
+	
 	for (i = 0; i < nb_msg; i ++)
 	{
-		// get the next event in the queue
-		XNextEvent (s_XDisplay, &event);
+		// get the next event
+		event = s_pCoalescedXEvents[i];
 		Xid = event.xany.window;
 		//g_print (" %d) type : %d; atom : %s; window : %d\n", i, event.type, XGetAtomName (s_XDisplay, event.xproperty.atom), Xid);
 		
@@ -585,6 +860,7 @@ static gboolean _cairo_dock_unstack_Xevents (G_GNUC_UNUSED gpointer data)
 						else  // is now ignored
 						{
 							xactor->bIgnored = bSkipTaskbar;
+							actor->iStackOrder = -1;  // like the other ignored windows (see _on_update_applis_list); the windows manager re-indexes it when it's notified.
 							gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_DESTROYED, actor);
 						}
 						continue;  // actor is either freeed or ignored
@@ -1057,6 +1333,18 @@ static GldiWindowActor *_pick_window (void)
 	return actor;
 }
 
+static void _get_new_windows_stats (guint *iNbWindows, gint64 *iTotalTime)
+{
+	*iNbWindows = s_iNbNewWindows;
+	*iTotalTime = s_iNewWindowsTime;
+}
+
+static void _get_events_stats (gulong *iNbEvents, gulong *iNbCoalescedEvents)
+{
+	*iNbEvents = s_iNbXEvents;
+	*iNbCoalescedEvents = s_iNbCoalescedXEvents;
+}
+
   /////////////////////////////////
  /// CONTAINER MANAGER BACKEND ///
 /////////////////////////////////
@@ -1189,12 +1477,23 @@ static void init (void)
 	Window *pXWindowsList = cairo_dock_get_windows_list (&iNbWindows, FALSE);  // ordered by creation date; this allows us to set the correct age to the icon, which is constant. On the next updates, the z-order (which is dynamic) will be set.
 	cd_debug ("got %d X windows", iNbWindows);
 	
-	Window Xid;
+	s_pStack = _make_stack_snapshot (pXWindowsList, iNbWindows);  // the first diff will compare the z-order with the creation order
+	s_iNbStackEntries = iNbWindows;
+	
+	gint64 t0 = g_get_monotonic_time ();
+	CairoDockXWindowProperties *pProps = cairo_dock_fetch_xwindows_properties (pXWindowsList, iNbWindows);  // all at once, to not pay a round-trip per property and per window
+	GldiXWindowActor *actor;
+	int iStackOrder = 0;
 	for (i = 0; i < iNbWindows; i ++)
 	{
-		Xid = pXWindowsList[i];
-		(void)_make_new_actor (Xid);
+		actor = _make_new_actor (pXWindowsList[i], pProps ? &pProps[i] : NULL);
+		_find_stack_entry (pXWindowsList[i])->actor = actor;
+		if (! actor->bIgnored)
+			actor->actor.iStackOrder = iStackOrder ++;
 	}
+	cairo_dock_free_xwindows_properties (pProps, iNbWindows);
+	s_iNbNewWindows += iNbWindows;
+	s_iNewWindowsTime += g_get_monotonic_time () - t0;
 	if (pXWindowsList != NULL)
 		XFree (pXWindowsList);
 	
@@ -1264,6 +1563,8 @@ static void init (void)
 	wmb.can_minimize_maximize_close = _can_minimize_maximize_close;
 	wmb.get_id = _get_id;
 	wmb.pick_window = _pick_window;
+	wmb.get_new_windows_stats = _get_new_windows_stats;
+	wmb.get_events_stats = _get_events_stats;
 	gldi_windows_manager_register_backend (&wmb);
 	
 	GldiContainerManagerBackend cmb;
@@ -1291,17 +1592,30 @@ static void init_object (GldiObject *obj, gpointer attr)
 {
 	GldiXWindowActor *xactor = (GldiXWindowActor*)obj;
 	GldiWindowActor *actor = (GldiWindowActor*)xactor;
-	Window *xid = (Window*)attr;
-	Window Xid = *xid;
+	GldiXWindowActorAttr *xattr = (GldiXWindowActorAttr*)attr;
+	Window Xid = xattr->Xid;
+	CairoDockXWindowProperties *pProps = xattr->pProps;
 	
 	xactor->Xid = Xid;
 	
 	// get additional properties
-	actor->cName = cairo_dock_get_xwindow_name (Xid, TRUE);
-	actor->iNumDesktop = cairo_dock_get_xwindow_desktop (Xid);
-	
 	int iLocalPositionX=0, iLocalPositionY=0, iWidthExtent=0, iHeightExtent=0;
-	cairo_dock_get_xwindow_geometry (Xid, &iLocalPositionX, &iLocalPositionY, &iWidthExtent, &iHeightExtent);
+	if (pProps != NULL)
+	{
+		actor->cName = pProps->cName;
+		pProps->cName = NULL;
+		actor->iNumDesktop = pProps->iNumDesktop;
+		iLocalPositionX = pProps->iLocalPositionX;
+		iLocalPositionY = pProps->iLocalPositionY;
+		iWidthExtent = pProps->iWidthExtent;
+		iHeightExtent = pProps->iHeightExtent;
+	}
+	else
+	{
+		actor->cName = cairo_dock_get_xwindow_name (Xid, TRUE);
+		actor->iNumDesktop = cairo_dock_get_xwindow_desktop (Xid);
+		cairo_dock_get_xwindow_geometry (Xid, &iLocalPositionX, &iLocalPositionY, &iWidthExtent, &iHeightExtent);
+	}
 	
 	actor->iViewPortX = iLocalPositionX / g_desktopGeometry.Xscreen.width + g_desktopGeometry.iCurrentViewportX;
 	actor->iViewPortY = iLocalPositionY / g_desktopGeometry.Xscreen.height + g_desktopGeometry.iCurrentViewportY;
@@ -1345,6 +1659,7 @@ static void reset_object (GldiObject *obj)
 	// remove from table
 	if (actor->iLastCheckTime != -1)  // if not already removed
 		g_hash_table_remove (s_hXWindowTable, &actor->Xid);
+	_forget_stacked_window (actor);
 	
 	// free data
 	#ifdef HAVE_XEXTEND
@@ -31,6 +31,11 @@
 #endif
 #include <X11/extensions/Xrandr.h>
 #endif
+#ifdef HAVE_XCB
+#include <stdlib.h>  // free
+#include <X11/Xlib-xcb.h>  // XGetXCBConnection
+#include <xcb/xcb.h>
+#endif
 
 #include "cairo-dock-log.h"
 #include "cairo-dock-utils.h"  // cairo_dock_remove_version_from_string, cairo_dock_check_xrandr
@@ -85,6 +90,7 @@ static Atom s_aNetWmDesktop;
 static Atom s_aNetWmIcon;
 static Atom s_aNetWmName;
 static Atom s_aWmName;
+static Atom s_aNetFrameExtents;
 static Atom s_aUtf8String;
 static Atom s_aString;
 static unsigned char error_code = Success;
@@ -156,6 +162,7 @@ Display *cairo_dock_initialize_X_desktop_support (void)
     s_aNetWmIcon                = XInternAtom (s_XDisplay, "_NET_WM_ICON", False);
     s_aNetWmName                = XInternAtom (s_XDisplay, "_NET_WM_NAME", False);
     s_aWmName                   = XInternAtom (s_XDisplay, "WM_NAME", False);
+    s_aNetFrameExtents          = XInternAtom (s_XDisplay, "_NET_FRAME_EXTENTS", False);
     s_aUtf8String               = XInternAtom (s_XDisplay, "UTF8_STRING", False);
     s_aString                   = XInternAtom (s_XDisplay, "STRING", False);
 	
@@ -1106,38 +1113,38 @@ gchar *cairo_dock_get_xwindow_name (Window Xid, gboolean bSearchWmName)
 	return cName;
 }
 
-gchar *cairo_dock_get_xwindow_class (Window Xid, gchar **cWMClass)
+// make the class of a window from its WM_CLASS hint.
+static gchar *_get_xwindow_class_from_hint (const gchar *cResName, const gchar *cResClass, gchar **cWMClass)
 {
-	XClassHint *pClassHint = XAllocClassHint ();
 	gchar *cClass = NULL, *cWmClass = NULL;
-	if (XGetClassHint (s_XDisplay, Xid, pClassHint) != 0 && pClassHint->res_class)
+	if (cResClass != NULL)
 	{
-		cWmClass = g_strdup (pClassHint->res_class);
+		cWmClass = g_strdup (cResClass);
 		
-		cd_debug ("  res_name : %s(%x); res_class : %s(%x)", pClassHint->res_name, pClassHint->res_name, pClassHint->res_class, pClassHint->res_class);
-		if (strcmp (pClassHint->res_class, "Wine") == 0 && pClassHint->res_name && (g_str_has_suffix (pClassHint->res_name, ".exe") || g_str_has_suffix (pClassHint->res_name, ".EXE")))  // wine application: use the name instead, because we don't want to group all wine apps togather
+		cd_debug ("  res_name : %s(%x); res_class : %s(%x)", cResName, cResName, cResClass, cResClass);
+		if (strcmp (cResClass, "Wine") == 0 && cResName && (g_str_has_suffix (cResName, ".exe") || g_str_has_suffix (cResName, ".EXE")))  // wine application: use the name instead, because we don't want to group all wine apps togather
 		{
-			cd_debug ("  wine application detected, changing the class '%s' to '%s'", pClassHint->res_class, pClassHint->res_name);
-			cClass = g_ascii_strdown (pClassHint->res_name, -1);
+			cd_debug ("  wine application detected, changing the class '%s' to '%s'", cResClass, cResName);
+			cClass = g_ascii_strdown (cResName, -1);
 		}
 		// chromium web apps (not the browser): same remark as for wine apps
-		else if (pClassHint->res_name && pClassHint->res_name[0] != '\0' && pClassHint->res_class[0] != '\0'
-		         && (strcmp (pClassHint->res_class, "Chromium-browser") == 0 // on Debian, etc.
-		          || strcmp (pClassHint->res_class, "Chromium") == 0         // on Arch, etc.
-		          || strcmp (pClassHint->res_class, "Google-chrome") == 0    // from Google
-		          || strcmp (pClassHint->res_class, "Google-chrome-beta") == 0
-		          || strcmp (pClassHint->res_class, "Google-chrome-unstable") == 0)
-		         && strcmp (pClassHint->res_class+1, pClassHint->res_name+1) != 0) // skip first letter (upper/lowercase)
+		else if (cResName && cResName[0] != '\0' && cResClass[0] != '\0'
+		         && (strcmp (cResClass, "Chromium-browser") == 0 // on Debian, etc.
+		          || strcmp (cResClass, "Chromium") == 0         // on Arch, etc.
+		          || strcmp (cResClass, "Google-chrome") == 0    // from Google
+		          || strcmp (cResClass, "Google-chrome-beta") == 0
+		          || strcmp (cResClass, "Google-chrome-unstable") == 0)
+		         && strcmp (cResClass+1, cResName+1) != 0) // skip first letter (upper/lowercase)
 		{
-			cClass = g_ascii_strdown (pClassHint->res_name, -1);
-
+			cClass = g_ascii_strdown (cResName, -1);
+		
 			/* Remove spaces. Why do they add spaces here?
 			 * (e.g.: Google-chrome-unstable (/home/$USER/.config/google-chrome-unstable))
 			 */
 			gchar *str = strchr (cClass, ' ');
 			if (str != NULL)
 				*str = '\0';
-
+		
 			/* Replace '.' to '_' (e.g.: www.google.com__calendar). It's to not
 			 * just have 'www' as class (we will drop the rest just here after)
 			 */
@@ -1146,33 +1153,29 @@ gchar *cairo_dock_get_xwindow_class (Window Xid, gchar **cWMClass)
 				if (cClass[i] == '.')
 					cClass[i] = '_';
 			}
-			cd_debug ("  chromium application detected, changing the class '%s' to '%s'", pClassHint->res_class, cClass);
+			cd_debug ("  chromium application detected, changing the class '%s' to '%s'", cResClass, cClass);
 		}
-		else if (*pClassHint->res_class == '/' && (g_str_has_suffix (pClassHint->res_class, ".exe") || g_str_has_suffix (pClassHint->res_name, ".EXE")))  // case of Mono applications like tomboy ...
+		else if (*cResClass == '/' && (g_str_has_suffix (cResClass, ".exe") || g_str_has_suffix (cResName, ".EXE")))  // case of Mono applications like tomboy ...
 		{
-			gchar *str = strrchr (pClassHint->res_class, '/');
+			const gchar *str = strrchr (cResClass, '/');
 			if (str)
 				str ++;
 			else
-				str = pClassHint->res_class;
+				str = cResClass;
 			cClass = g_ascii_strdown (str, -1);
 			cClass[strlen (cClass) - 4] = '\0';
 		}
 		else
 		{
-			cClass = g_ascii_strdown (pClassHint->res_class, -1);  // down case because some apps change the case depending of their windows...
+			cClass = g_ascii_strdown (cResClass, -1);  // down case because some apps change the case depending of their windows...
 		}
-
+		
 		cairo_dock_remove_version_from_string (cClass);  // we remore number of version (e.g. Openoffice.org-3.1)
-
+		
 		gchar *str = strchr (cClass, '.');  // we remove all .xxx otherwise we can't detect the lack of extension when looking for an icon (openoffice.org) or it's a problem when looking for an icon (jbrout.py).
 		if (str != NULL)
 			*str = '\0';
 		cd_debug ("got an application with class '%s'", cClass);
-		
-		XFree (pClassHint->res_name);
-		XFree (pClassHint->res_class);
-		XFree (pClassHint);
 	}
 	if (cWMClass)
 		*cWMClass = cWmClass;
@@ -1181,6 +1184,22 @@ gchar *cairo_dock_get_xwindow_class (Window Xid, gchar **cWMClass)
 	return cClass;
 }
 
+gchar *cairo_dock_get_xwindow_class (Window Xid, gchar **cWMClass)
+{
+	XClassHint *pClassHint = XAllocClassHint ();
+	gchar *cClass = NULL;
+	if (XGetClassHint (s_XDisplay, Xid, pClassHint) != 0)
+	{
+		cClass = _get_xwindow_class_from_hint (pClassHint->res_name, pClassHint->res_class, cWMClass);
+		XFree (pClassHint->res_name);
+		XFree (pClassHint->res_class);
+	}
+	else if (cWMClass)
+		*cWMClass = NULL;
+	XFree (pClassHint);
+	return cClass;
+}
+
 gboolean cairo_dock_xwindow_is_maximized (Window Xid)
 {
 	g_return_val_if_fail (Xid > 0, FALSE);
@@ -1283,16 +1302,9 @@ void cairo_dock_xwindow_is_above_or_below (Window Xid, gboolean *bIsAbove, gbool
 	XFree (pXStateBuffer);
 }
 
-gboolean cairo_dock_xwindow_is_fullscreen_or_hidden_or_maximized (Window Xid, gboolean *bIsFullScreen, gboolean *bIsHidden, gboolean *bIsMaximized, gboolean *bDemandsAttention)
+// parse the _NET_WM_STATE of a window; returns FALSE if the window should not be in the taskbar.
+static gboolean _get_xwindow_state_from_buffer (const gulong *pXStateBuffer, gulong iBufferNbElements, gboolean *bIsFullScreen, gboolean *bIsHidden, gboolean *bIsMaximized, gboolean *bDemandsAttention)
 {
-	g_return_val_if_fail (Xid > 0, FALSE);
-	//cd_debug ("%s (%d)", __func__, Xid);
-	Atom aReturnedType = 0;
-	int aReturnedFormat = 0;
-	unsigned long iLeftBytes, iBufferNbElements = 0;
-	gulong *pXStateBuffer = NULL;
-	XGetWindowProperty (s_XDisplay, Xid, s_aNetWmState, 0, G_MAXULONG, False, XA_ATOM, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pXStateBuffer);
-	
 	gboolean bValid = TRUE;
 	*bIsFullScreen = FALSE;
 	*bIsHidden = FALSE;
@@ -1336,6 +1348,20 @@ gboolean cairo_dock_xwindow_is_fullscreen_or_hidden_or_maximized (Window Xid, gb
 			}
 		}
 	}
+	return bValid;
+}
+
+gboolean cairo_dock_xwindow_is_fullscreen_or_hidden_or_maximized (Window Xid, gboolean *bIsFullScreen, gboolean *bIsHidden, gboolean *bIsMaximized, gboolean *bDemandsAttention)
+{
+	g_return_val_if_fail (Xid > 0, FALSE);
+	//cd_debug ("%s (%d)", __func__, Xid);
+	Atom aReturnedType = 0;
+	int aReturnedFormat = 0;
+	unsigned long iLeftBytes, iBufferNbElements = 0;
+	gulong *pXStateBuffer = NULL;
+	XGetWindowProperty (s_XDisplay, Xid, s_aNetWmState, 0, G_MAXULONG, False, XA_ATOM, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pXStateBuffer);
+	
+	gboolean bValid = _get_xwindow_state_from_buffer (pXStateBuffer, iBufferNbElements, bIsFullScreen, bIsHidden, bIsMaximized, bDemandsAttention);
 	
 	XFree (pXStateBuffer);
 	return bValid;
@@ -1430,7 +1456,7 @@ void cairo_dock_get_xwindow_geometry (Window Xid, int *iLocalPositionX, int *iLo
 	Atom aReturnedType = 0;
 	int aReturnedFormat = 0;
 	gulong *pBuffer = NULL;
-	XGetWindowProperty (s_XDisplay, Xid, XInternAtom (s_XDisplay, "_NET_FRAME_EXTENTS", False), 0, G_MAXULONG, False, XA_CARDINAL, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pBuffer);
+	XGetWindowProperty (s_XDisplay, Xid, s_aNetFrameExtents, 0, G_MAXULONG, False, XA_CARDINAL, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pBuffer);
 	if (iBufferNbElements > 3)
 	{
 		left=pBuffer[0], right=pBuffer[1], top=pBuffer[2], bottom=pBuffer[3];
@@ -1745,14 +1771,24 @@ GLuint cairo_dock_texture_from_pixmap (Window Xid, Pixmap iBackingPixmap)
 	return cCommand;
 }*/
 
-gboolean cairo_dock_get_xwindow_type (Window Xid, Window *pTransientFor)
+// tell if the WM_TRANSIENT_FOR hint of a window is needed to know whether to keep it: only if it has no type, or if it's a dialog.
+static gboolean _xwindow_type_needs_transient (const gulong *pTypeBuffer, gulong iBufferNbElements)
+{
+	guint i;
+	for (i = 0; i < iBufferNbElements; i ++)
+	{
+		if (pTypeBuffer[i] == s_aNetWmWindowTypeNormal || pTypeBuffer[i] == s_aNetWmWindowTypeDock)
+			return FALSE;
+		if (pTypeBuffer[i] == s_aNetWmWindowTypeDialog)
+			return TRUE;
+	}
+	return (iBufferNbElements == 0);
+}
+
+// parse the _NET_WM_WINDOW_TYPE of a window; 'iTransientFor' is only copied into 'pTransientFor' if it was needed to take the decision.
+static gboolean _get_xwindow_type_from_buffer (const gulong *pTypeBuffer, gulong iBufferNbElements, Window iTransientFor, Window *pTransientFor)
 {
 	gboolean bKeep = FALSE;  // we only want to know if we can display this window in the dock or not, so a boolean is enough.
-	Atom aReturnedType = 0;
-	int aReturnedFormat = 0;
-	unsigned long iLeftBytes, iBufferNbElements;
-	gulong *pTypeBuffer = NULL;
-	XGetWindowProperty (s_XDisplay, Xid, s_aNetWmWindowType, 0, G_MAXULONG, False, XA_ATOM, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pTypeBuffer);
 	if (iBufferNbElements != 0)
 	{
 		guint i;
@@ -1765,7 +1801,7 @@ gboolean cairo_dock_get_xwindow_type (Window Xid, Window *pTransientFor)
 			}
 			if (pTypeBuffer[i] == s_aNetWmWindowTypeDialog)  // dialog -> skip modal dialog, because we can't act on it independantly from the parent window (it's most probably a dialog box like an open/save dialog)
 			{
-				XGetTransientForHint (s_XDisplay, Xid, pTransientFor);  // maybe we should also get the _NET_WM_STATE_MODAL property, although if a dialog is set modal but not transient, that would probably be an error from the application.
+				*pTransientFor = iTransientFor;  // maybe we should also get the _NET_WM_STATE_MODAL property, although if a dialog is set modal but not transient, that would probably be an error from the application.
 				if (*pTransientFor == None)
 				{
 					bKeep = TRUE;
@@ -1777,14 +1813,232 @@ gboolean cairo_dock_get_xwindow_type (Window Xid, Window *pTransientFor)
 				break;
 			}
 		}
-		XFree (pTypeBuffer);
 	}
 	else  // no type, take it by default, unless it's transient.
 	{
-		XGetTransientForHint (s_XDisplay, Xid, pTransientFor);
+		*pTransientFor = iTransientFor;
 		bKeep = (*pTransientFor == None);
 	}
 	return bKeep;
 }
 
+gboolean cairo_dock_get_xwindow_type (Window Xid, Window *pTransientFor)
+{
+	Atom aReturnedType = 0;
+	int aReturnedFormat = 0;
+	unsigned long iLeftBytes, iBufferNbElements = 0;
+	gulong *pTypeBuffer = NULL;
+	XGetWindowProperty (s_XDisplay, Xid, s_aNetWmWindowType, 0, G_MAXULONG, False, XA_ATOM, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pTypeBuffer);
+	
+	Window iTransientFor = None;
+	if (_xwindow_type_needs_transient (pTypeBuffer, iBufferNbElements))
+		XGetTransientForHint (s_XDisplay, Xid, &iTransientFor);
+	gboolean bKeep = _get_xwindow_type_from_buffer (pTypeBuffer, iBufferNbElements, iTransientFor, pTransientFor);
+	
+	if (pTypeBuffer != NULL)
+		XFree (pTypeBuffer);
+	return bKeep;
+}
+
+
+#ifdef HAVE_XCB
+typedef struct {
+	xcb_get_property_cookie_t state;
+	xcb_get_property_cookie_t type;
+	xcb_get_property_cookie_t transient;
+	xcb_get_property_cookie_t wmclass;
+	xcb_get_property_cookie_t netname;
+	xcb_get_property_cookie_t name;
+	xcb_get_property_cookie_t desktop;
+	xcb_get_property_cookie_t extents;
+	xcb_get_geometry_cookie_t geometry;
+	xcb_translate_coordinates_cookie_t coords;
+} CairoDockXWindowCookies;
+
+// get the items of a 32-bits property, as the Xlib would give them (an array of longs).
+static gulong *_get_xcb_property_items (xcb_connection_t *pConnection, xcb_get_property_cookie_t cookie, gulong *iNbItems)
+{
+	gulong *pBuffer = NULL;
+	*iNbItems = 0;
+	xcb_generic_error_t *pError = NULL;
+	xcb_get_property_reply_t *pReply = xcb_get_property_reply (pConnection, cookie, &pError);
+	if (pReply != NULL && pReply->format == 32 && pReply->value_len > 0)
+	{
+		const uint32_t *pValues = xcb_get_property_value (pReply);
+		pBuffer = g_new (gulong, pReply->value_len);
+		guint i;
+		for (i = 0; i < pReply->value_len; i ++)
+			pBuffer[i] = pValues[i];
+		*iNbItems = pReply->value_len;
+	}
+	free (pReply);
+	free (pError);
+	return pBuffer;
+}
+
+// get a 8-bits property as a nul-terminated string (which may contain several strings, like WM_CLASS).
+static gchar *_get_xcb_property_string (xcb_connection_t *pConnection, xcb_get_property_cookie_t cookie, int *iLength)
+{
+	gchar *cString = NULL;
+	*iLength = 0;
+	xcb_generic_error_t *pError = NULL;
+	xcb_get_property_reply_t *pReply = xcb_get_property_reply (pConnection, cookie, &pError);
+	if (pReply != NULL && pReply->format == 8 && pReply->value_len > 0)
+	{
+		int n = xcb_get_property_value_length (pReply);
+		cString = g_new (gchar, n + 1);
+		memcpy (cString, xcb_get_property_value (pReply), n);
+		cString[n] = '\0';
+		*iLength = n;
+	}
+	free (pReply);
+	free (pError);
+	return cString;
+}
+
+static inline xcb_get_property_cookie_t _request_xcb_property (xcb_connection_t *pConnection, Window Xid, Atom aProperty, Atom aType)
+{
+	return xcb_get_property (pConnection, 0, Xid, aProperty, aType, 0, G_MAXUINT32);
+}
+
+static void _fetch_xwindows_properties_xcb (const Window *pXids, gulong iNbWindows, CairoDockXWindowProperties *pProps)
+{
+	xcb_connection_t *pConnection = XGetXCBConnection (s_XDisplay);
+	Window root = DefaultRootWindow (s_XDisplay);
+	
+	// send all the requests for all the windows, without waiting for any reply.
+	CairoDockXWindowCookies *pCookies = g_new (CairoDockXWindowCookies, iNbWindows);
+	gulong i;
+	for (i = 0; i < iNbWindows; i ++)
+	{
+		Window Xid = pXids[i];
+		CairoDockXWindowCookies *c = &pCookies[i];
+		c->state     = _request_xcb_property (pConnection, Xid, s_aNetWmState, XA_ATOM);
+		c->type      = _request_xcb_property (pConnection, Xid, s_aNetWmWindowType, XA_ATOM);
+		c->transient = _request_xcb_property (pConnection, Xid, XA_WM_TRANSIENT_FOR, XA_WINDOW);
+		c->wmclass   = _request_xcb_property (pConnection, Xid, XA_WM_CLASS, XA_STRING);
+		c->netname   = _request_xcb_property (pConnection, Xid, s_aNetWmName, s_aUtf8String);
+		c->name      = _request_xcb_property (pConnection, Xid, s_aWmName, s_aString);
+		c->desktop   = _request_xcb_property (pConnection, Xid, s_aNetWmDesktop, XA_CARDINAL);
+		c->extents   = _request_xcb_property (pConnection, Xid, s_aNetFrameExtents, XA_CARDINAL);
+		c->geometry  = xcb_get_geometry (pConnection, Xid);
+		c->coords    = xcb_translate_coordinates (pConnection, Xid, root, 0, 0);  // see cairo_dock_get_xwindow_geometry() for why we need it.
+	}
+	xcb_flush (pConnection);
+	
+	// now collect the replies, in the same order as the requests.
+	xcb_generic_error_t *pError;
+	gulong n;
+	int iLength;
+	for (i = 0; i < iNbWindows; i ++)
+	{
+		CairoDockXWindowCookies *c = &pCookies[i];
+		CairoDockXWindowProperties *p = &pProps[i];
+		
+		// state
+		gulong *pXStateBuffer = _get_xcb_property_items (pConnection, c->state, &n);
+		p->bShowInTaskbar = _get_xwindow_state_from_buffer (pXStateBuffer, n, &p->bIsFullScreen, &p->bIsHidden, &p->bIsMaximized, &p->bDemandsAttention);
+		g_free (pXStateBuffer);
+		
+		// type and transient-for
+		gulong *pTypeBuffer = _get_xcb_property_items (pConnection, c->type, &n);
+		gulong nt;
+		gulong *pTransientBuffer = _get_xcb_property_items (pConnection, c->transient, &nt);
+		Window iTransientFor = (nt > 0 ? pTransientBuffer[0] : None);
+		if (p->bShowInTaskbar)
+			p->bNormalWindow = _get_xwindow_type_from_buffer (pTypeBuffer, n, iTransientFor, &p->iTransientFor);
+		else
+			p->iTransientFor = iTransientFor;
+		g_free (pTypeBuffer);
+		g_free (pTransientBuffer);
+		
+		// class: WM_CLASS is made of 2 consecutive strings, res_name and res_class
+		gchar *cClassHint = _get_xcb_property_string (pConnection, c->wmclass, &iLength);
+		if (cClassHint != NULL)
+		{
+			int iNameLength = strlen (cClassHint);
+			p->cClass = _get_xwindow_class_from_hint (cClassHint, iNameLength < iLength ? cClassHint + iNameLength + 1 : cClassHint + iNameLength, &p->cWmClass);  // like XGetClassHint, a missing res_class gives an empty string
+			g_free (cClassHint);
+		}
+		
+		// name: prefer the UTF-8 one
+		p->cName = _get_xcb_property_string (pConnection, c->netname, &iLength);
+		gchar *cWmName = _get_xcb_property_string (pConnection, c->name, &iLength);
+		if (p->cName == NULL)
+			p->cName = cWmName;
+		else
+			g_free (cWmName);
+		
+		// desktop
+		gulong *pDesktopBuffer = _get_xcb_property_items (pConnection, c->desktop, &n);
+		p->iNumDesktop = (n > 0 ? (int)pDesktopBuffer[0] : 0);
+		g_free (pDesktopBuffer);
+		
+		// geometry, including the window borders
+		int left=0, right=0, top=0, bottom=0;
+		gulong *pExtentsBuffer = _get_xcb_property_items (pConnection, c->extents, &n);
+		if (n > 3)
+		{
+			left=pExtentsBuffer[0], right=pExtentsBuffer[1], top=pExtentsBuffer[2], bottom=pExtentsBuffer[3];
+		}
+		g_free (pExtentsBuffer);
+		
+		int iWidth = 0, iHeight = 0;
+		pError = NULL;
+		xcb_get_geometry_reply_t *pGeometry = xcb_get_geometry_reply (pConnection, c->geometry, &pError);
+		if (pGeometry != NULL)
+		{
+			iWidth = pGeometry->width;
+			iHeight = pGeometry->height;
+		}
+		free (pGeometry);
+		free (pError);
+		
+		int x = 0, y = 0;
+		pError = NULL;
+		xcb_translate_coordinates_reply_t *pCoords = xcb_translate_coordinates_reply (pConnection, c->coords, &pError);
+		if (pCoords != NULL)
+		{
+			x = pCoords->dst_x;
+			y = pCoords->dst_y;
+		}
+		free (pCoords);
+		free (pError);
+		
+		p->iLocalPositionX = x - left;
+		p->iLocalPositionY = y - top;
+		p->iWidthExtent = iWidth + left + right;
+		p->iHeightExtent = iHeight + top + bottom;
+	}
+	g_free (pCookies);
+}
+#endif
+
+CairoDockXWindowProperties *cairo_dock_fetch_xwindows_properties (const Window *pXids, gulong iNbWindows)
+{
+	#ifdef HAVE_XCB
+	CairoDockXWindowProperties *pProps = g_new0 (CairoDockXWindowProperties, iNbWindows + 1);
+	if (iNbWindows != 0)
+		_fetch_xwindows_properties_xcb (pXids, iNbWindows, pProps);
+	return pProps;
+	#else
+	(void)pXids;
+	(void)iNbWindows;
+	return NULL;  // without XCB, each request costs a round-trip anyway, so let the caller only ask for what it needs.
+	#endif
+}
+
+void cairo_dock_free_xwindows_properties (CairoDockXWindowProperties *pProps, gulong iNbWindows)
+{
+	if (pProps == NULL)
+		return;
+	gulong i;
+	for (i = 0; i < iNbWindows; i ++)
+	{
+		g_free (pProps[i].cClass);
+		g_free (pProps[i].cWmClass);
+		g_free (pProps[i].cName);
+	}
+	g_free (pProps);
+}
 #endif
@@ -123,6 +123,31 @@ GLuint cairo_dock_texture_from_pixmap (Window Xid, Pixmap iBackingPixmap);
 
 gboolean cairo_dock_get_xwindow_type (Window Xid, Window *pTransientFor);
 
+// BATCH //
+/* Properties of a window needed to make its actor.
+ */
+typedef struct _CairoDockXWindowProperties {
+	gboolean bShowInTaskbar;  // FALSE if the window has the 'skip taskbar' state
+	gboolean bIsFullScreen;
+	gboolean bIsHidden;
+	gboolean bIsMaximized;
+	gboolean bDemandsAttention;
+	gboolean bNormalWindow;  // whether its type can be displayed in the taskbar (only set if bShowInTaskbar)
+	Window iTransientFor;
+	gchar *cClass;
+	gchar *cWmClass;
+	gchar *cName;
+	int iNumDesktop;
+	int iLocalPositionX, iLocalPositionY, iWidthExtent, iHeightExtent;
+} CairoDockXWindowProperties;
+
+/* Get the properties of several windows at once. All the requests are sent before waiting for any reply, so it costs a single round-trip whatever the number of windows.
+ It needs XCB: without it, NULL is returned and the properties have to be fetched one by one with the functions above.
+ The strings can be stolen by the caller (set them to NULL), the rest will be freed by cairo_dock_free_xwindows_properties.
+ */
+CairoDockXWindowProperties *cairo_dock_fetch_xwindows_properties (const Window *pXids, gulong iNbWindows);
+void cairo_dock_free_xwindows_properties (CairoDockXWindowProperties *pProps, gulong iNbWindows);
+
 gboolean cairo_dock_xcomposite_is_available (void);
 
 
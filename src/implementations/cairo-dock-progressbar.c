@@ -259,8 +259,8 @@ static void render_opengl (ProgressBar *pProgressBar)
 		
 		if (v > 0 && v <= 1)  // any negative value is an "undef" value
 		{
-			// make a rounded rectangle path.
-			const CairoDockGLPath *pFramePath = cairo_dock_generate_rectangle_path (w * v, 2*r, r, TRUE);
+			// make a rounded rectangle path; its width changes with the value, so don't let it evict the paths of the cache.
+			const CairoDockGLPath *pFramePath = cairo_dock_generate_uncached_rectangle_path (w * v, 2*r, r, TRUE);
 			
 			// bind the texture to the path
 			// we don't use the automatic coords generation because we want to bind the texture to the interval [0; v].
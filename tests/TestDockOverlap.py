@@ -0,0 +1,66 @@
+from time import sleep
+import os  # system
+import subprocess
+import dbus
+from Test import Test, key, set_param
+from CairoDock import CairoDock
+import config
+
+# Drag a window over the main dock and back, and check that the overlap with the dock is detected by only testing the windows near it.
+# The main dock must be set to hide when any window overlaps it (default theme).
+class TestDockOverlap(Test):
+	def __init__(self, dock):
+		self.exe = config.exe
+		self.wmclass = config.wmclass
+		Test.__init__(self, "Test dock overlap", dock)
+		bus = dbus.SessionBus()
+		self.p = dbus.Interface (bus.get_object("org.cairodock.CairoDock", "/org/cairodock/CairoDock/RuntimeStats"), "org.cairodock.CairoDock.RuntimeStats")
+	
+	def _get_overlap_stats(self):
+		fields = self.p.GetOverlapStats().split('\t')
+		if len(fields) != 3:
+			self.print_error ('Wrong format: "%s"' % '\t'.join(fields))
+			return None
+		return int(fields[0]), int(fields[1]), int(fields[2])
+	
+	def _drag(self, win, x, y0, y1):
+		step = 10 if y1 > y0 else -10
+		for y in range(y0, y1, step):
+			os.system ("xdotool windowmove %s %d %d" % (win, x, y))
+		sleep(1)
+	
+	def run(self):
+		props = self.d.GetProperties('type=Dock & name=_MainDock_')
+		x, y, w, h = props[0]['x'], props[0]['y'], props[0]['width'], props[0]['height']
+		
+		os.system('killall -q '+self.exe)
+		sleep(1)
+		os.system(self.exe+'&')
+		win = subprocess.check_output(['xdotool', 'search', '--sync', '--class', self.wmclass]).split()[0].decode()
+		os.system ("xdotool windowmove %s %d 0" % (win, x))
+		sleep(1)
+		
+		# drag the window down onto the dock (at the bottom of the screen)
+		before = self._get_overlap_stats()
+		self._drag (win, x, 0, y + h // 2)
+		over = self._get_overlap_stats()
+		
+		# drag it back to the top
+		self._drag (win, x, y + h // 2, 0)
+		away = self._get_overlap_stats()
+		
+		os.system('killall -q '+self.exe)
+		sleep(1)
+		
+		if before != None and over != None and away != None:
+			n, n_tested = away[0] - before[0], away[1] - before[1]
+			if n == 0:
+				self.print_error ('No overlap search while a window was dragged')
+			else:
+				print ('[%s] %d searches, %.1f windows tested per search' % (self.name, n, float(n_tested) / n))
+			if over[2] == before[2]:
+				self.print_error ('The window over the dock has not been detected')
+			if away[0] == over[0]:
+				self.print_error ('No overlap search while the window was dragged away')
+		
+		self.end()
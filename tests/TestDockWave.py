@@ -0,0 +1,45 @@
+from time import sleep
+import os  # system
+import dbus
+from Test import Test, key, set_param
+from CairoDock import CairoDock
+
+# Benchmark the computation of the wave, by sweeping the cursor over the main dock
+class TestDockWave(Test):
+	def __init__(self, dock):
+		Test.__init__(self, "Test dock wave", dock)
+		bus = dbus.SessionBus()
+		self.p = dbus.Interface (bus.get_object("org.cairodock.CairoDock", "/org/cairodock/CairoDock/RuntimeStats"), "org.cairodock.CairoDock.RuntimeStats")
+	
+	def _get_wave_stats(self):
+		fields = self.p.GetWaveStats().split('\t')
+		if len(fields) != 3:
+			self.print_error ('Wrong format: "%s"' % '\t'.join(fields))
+			return None
+		return int(fields[0]), int(fields[1]), int(fields[2])
+	
+	def run(self):
+		props = self.d.GetProperties('type=Dock & name=_MainDock_')
+		x, y, w, h = props[0]['x'], props[0]['y'], props[0]['width'], props[0]['height']
+		yc = y + h - 10  # inside the icons, the dock being at the bottom
+		
+		before = self._get_wave_stats()
+		os.system ("xdotool mousemove %d %d" % (x + 5, yc))
+		sleep(1)  # let the dock grow
+		for i in range(2):  # sweep back and forth
+			for xc in range(x + 5, x + w - 5, 4) if i == 0 else range(x + w - 5, x + 5, -4):
+				os.system ("xdotool mousemove %d %d" % (xc, yc))
+		sleep(.5)
+		after = self._get_wave_stats()
+		os.system ("xdotool mousemove 0 0")
+		
+		if before != None and after != None:
+			n, n_inc, t = after[0] - before[0], after[1] - before[1], after[2] - before[2]
+			if n == 0:
+				self.print_error ('No wave has been computed while the cursor was inside the dock')
+			else:
+				print ('[%s] %d waves (%d incremental), %.1fus/wave' % (self.name, n, n_inc, float(t) / n))
+				if n_inc == 0:
+					self.print_error ('The wave is never updated incrementally while only the cursor moves')
+		
+		self.end()
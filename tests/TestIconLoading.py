@@ -0,0 +1,43 @@
+from time import sleep, time
+from Test import Test, key, set_param
+from CairoDock import CairoDock
+
+# Benchmark the loading of the icons' images, like at startup: all the images are decoded again when the icons size changes.
+# The images are decoded in threads, so the dock should keep answering while they're loaded.
+class TestIconLoading(Test):
+	def __init__(self, dock):
+		self.mgr = 'Icons'
+		self.max_latency = 0.5  # maximum time the dock may be frozen, in s
+		Test.__init__(self, "Test icons loading", dock)
+	
+	def _reload_and_measure(self):
+		t0 = time()
+		self.d.Reload('type=Manager & name='+self.mgr)
+		t_reload = time() - t0
+		
+		# ping the dock until the images are loaded, and keep the longest answer time.
+		latency = 0
+		t_end = time() + 2
+		while time() < t_end:
+			t = time()
+			self.d.GetProperties('type=Dock')
+			latency = max (latency, time() - t)
+			sleep(.01)
+		return t_reload, latency
+	
+	def run(self):
+		set_param (self.get_conf_file(), "Icons", "launcher size", "48;48")  # from 40 to 48
+		t_reload, latency = self._reload_and_measure()
+		print ('[%s] reload: %.0fms, max latency: %.0fms' % (self.name, t_reload * 1000, latency * 1000))
+		if latency > self.max_latency:
+			self.print_error ('The dock has been frozen for %.0fms while loading the icons' % (latency * 1000))
+		
+		set_param (self.get_conf_file(), "Icons", "launcher size", "40;40")  # back to normal
+		t_reload, latency = self._reload_and_measure()
+		print ('[%s] reload: %.0fms, max latency: %.0fms' % (self.name, t_reload * 1000, latency * 1000))
+		
+		props = self.d.GetProperties('type=Launcher')
+		if len(props) == 0:
+			self.print_error ('No launcher found')
+		
+		self.end()
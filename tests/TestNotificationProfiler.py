@@ -0,0 +1,64 @@
+from time import sleep
+import dbus
+from Test import Test, key, set_param
+from CairoDock import CairoDock
+
+# Test the notifications profiler exported on the bus
+class TestNotificationProfiler(Test):
+	def __init__(self, dock):
+		Test.__init__(self, "Test notifications profiler", dock)
+		bus = dbus.SessionBus()
+		self.p = dbus.Interface (bus.get_object("org.cairodock.CairoDock", "/org/cairodock/CairoDock/NotificationProfiler"), "org.cairodock.CairoDock.NotificationProfiler")
+	
+	def run(self):
+		self.p.Reset()
+		self.p.Enable(True)
+		self.d.Reload('type=Manager & name=Docks')  # triggers a lot of notifications (render, update, etc)
+		sleep(1)
+		self.p.Enable(False)
+		
+		stats = self.p.GetStats()
+		lines = stats.splitlines()
+		if len(lines) == 0:
+			self.print_error ('No notification has been recorded')
+		for l in lines:
+			fields = l.split('\t')
+			if len(fields) != 6:
+				self.print_error ('Wrong format: "%s"' % l)
+			elif int(fields[3]) == 0 or int(fields[5]) > int(fields[4]):
+				self.print_error ('Wrong stats: "%s"' % l)
+		
+		if len(self.p.GetHistory().splitlines()) == 0:
+			self.print_error ('The history is empty')
+		
+		# no more record once disabled
+		self.p.Reset()
+		self.d.Reload('type=Manager & name=Docks')
+		sleep(1)
+		if self.p.GetStats() != '':
+			self.print_error ('Notifications are still recorded after the profiler has been disabled')
+		
+		self.end()
+
+# Test that an object can be destroyed by one of its own callbacks
+class TestDestroyDuringNotification(Test):
+	def __init__(self, dock):
+		Test.__init__(self, "Test destroy during notification", dock)
+		bus = dbus.SessionBus()
+		self.p = dbus.Interface (bus.get_object("org.cairodock.CairoDock", "/org/cairodock/CairoDock/NotificationProfiler"), "org.cairodock.CairoDock.NotificationProfiler")
+	
+	def run(self):
+		for enable in [False, True]:  # the profiler takes another path to call the callbacks
+			self.p.Enable(enable)
+			calls, late_calls = [int(x) for x in self.p.TestDestroyDuringNotification().split('\t')]
+			if calls != 1:
+				self.print_error ('%d callbacks were called instead of 1 (profiler: %s)' % (calls, enable))
+			if late_calls != 0:
+				self.print_error ('%d callbacks were called after the object was destroyed (profiler: %s)' % (late_calls, enable))
+		self.p.Enable(False)
+		
+		# the dock is still alive
+		if len(self.d.GetProperties('container=_MainDock_')) == 0:
+			self.print_error ('The dock has no more icons')
+		
+		self.end()
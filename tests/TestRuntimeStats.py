@@ -0,0 +1,284 @@
+from time import sleep
+import os  # system
+import subprocess
+import dbus
+from Test import Test, key, set_param
+from CairoDock import CairoDock
+import config
+
+# Test the statistics of the dock exported on the bus
+class TestRuntimeStats(Test):
+	def __init__(self, dock):
+		Test.__init__(self, "Test runtime stats", dock)
+		bus = dbus.SessionBus()
+		self.p = dbus.Interface (bus.get_object("org.cairodock.CairoDock", "/org/cairodock/CairoDock/RuntimeStats"), "org.cairodock.CairoDock.RuntimeStats")
+	
+	def _get_task_stats(self):
+		fields = self.p.GetTaskStats().split('\t')
+		if len(fields) != 2:
+			self.print_error ('Wrong format: "%s"' % '\t'.join(fields))
+			return None
+		return int(fields[0]), int(fields[1])
+	
+	def run(self):
+		# the periodic tasks (clock, etc) share a single timer, that fires at most once per second.
+		before = self._get_task_stats()
+		sleep(5)
+		after = self._get_task_stats()
+		if before != None and after != None:
+			print ('[%s] %d timer wakeups and %d completion wakeups in 5s' % (self.name, after[0] - before[0], after[1] - before[1]))
+			if after[0] < before[0] or after[1] < before[1]:
+				self.print_error ('The counters went backwards')
+			elif after[0] - before[0] > 6:
+				self.print_error ('The timer of the tasks woke up the dock more than once per second')
+		
+		self.end()
+
+# Measure the cost of inspecting new windows (one round-trip per property without XCB, a single one for all of them with it)
+class TestNewWindowsStats(Test):
+	def __init__(self, dock):
+		self.exe = config.exe
+		Test.__init__(self, "Test new windows stats", dock)
+		bus = dbus.SessionBus()
+		self.p = dbus.Interface (bus.get_object("org.cairodock.CairoDock", "/org/cairodock/CairoDock/RuntimeStats"), "org.cairodock.CairoDock.RuntimeStats")
+	
+	def _get_new_windows_stats(self):
+		fields = self.p.GetNewWindowsStats().split('\t')
+		if len(fields) != 2:
+			self.print_error ('Wrong format: "%s"' % '\t'.join(fields))
+			return None
+		return int(fields[0]), int(fields[1])
+	
+	def run(self):
+		os.system('killall -q '+self.exe)
+		sleep(1)
+		before = self._get_new_windows_stats()
+		
+		# open a few windows at once, so that they are likely to be inspected together
+		for i in range(3):
+			os.system(self.exe+'&')
+		sleep(3)
+		after = self._get_new_windows_stats()
+		os.system('killall -q '+self.exe)
+		sleep(1)
+		
+		if before != None and after != None:
+			n = after[0] - before[0]
+			if n < 3:
+				self.print_error ('Only %d new windows were inspected' % n)
+			else:
+				print ('[%s] %d new windows inspected in %dus (%dus per window)' % (self.name, n, after[1] - before[1], (after[1] - before[1]) / n))
+		
+		self.end()
+
+# Run 50 periodic tasks with a slow asynchronous part, and measure the CPU the dock spends waiting for them (the main loop should only wake up when some of them are over)
+class TestTaskBenchmark(Test):
+	def __init__(self, dock):
+		Test.__init__(self, "Test task benchmark", dock)
+		bus = dbus.SessionBus()
+		self.p = dbus.Interface (bus.get_object("org.cairodock.CairoDock", "/org/cairodock/CairoDock/RuntimeStats"), "org.cairodock.CairoDock.RuntimeStats")
+	
+	def _get_cpu_time(self, pid):  # in s
+		fields = open('/proc/%s/stat' % pid).read().rsplit(')', 1)[1].split()
+		return float(int(fields[11]) + int(fields[12])) / os.sysconf('SC_CLK_TCK')  # utime + stime
+	
+	def _measure(self, pid, nb_tasks, duration):
+		stats = self.p.GetTaskStats().split('\t')
+		cpu = self._get_cpu_time(pid)
+		self.p.StartTaskBenchmark(nb_tasks, 1, 20)
+		sleep(duration)
+		n = int(self.p.StopTaskBenchmark())
+		cpu = self._get_cpu_time(pid) - cpu
+		wakeups = int(self.p.GetTaskStats().split('\t')[1]) - int(stats[1])
+		return n, cpu, wakeups
+	
+	def run(self):
+		pid = os.popen('pidof -s cairo-dock').read().strip()
+		if pid == '':
+			self.print_error ('The dock is not running')
+			self.end()
+			return
+		duration = 10
+		n0, cpu0, wakeups0 = self._measure(pid, 0, duration)
+		n, cpu, wakeups = self._measure(pid, 50, duration)
+		print ('[%s] idle: %.2fs of CPU; 50 tasks: %d iterations, %d completion wakeups, %.2fs of CPU in %ds' % (self.name, cpu0, n, wakeups, cpu, duration))
+		if n < 50 * (duration - 2):
+			self.print_error ('Only %d iterations of the tasks in %ds' % (n, duration))
+		if wakeups > n:
+			self.print_error ('The main loop was woken up more often than the tasks completed')
+		if cpu - cpu0 > .05 * duration:  # waiting for the tasks by polling would take a whole core.
+			self.print_error ('The tasks cost %.2fs of CPU in %ds' % (cpu - cpu0, duration))
+		
+		self.end()
+
+# Run 50 periodic tasks started at different moments, and count how many times the timer of the tasks wakes up the dock: since they share the timer wheel, it's at most once per second instead of once per task and per period
+class TestTaskWheel(Test):
+	def __init__(self, dock):
+		Test.__init__(self, "Test task wheel", dock)
+		bus = dbus.SessionBus()
+		self.p = dbus.Interface (bus.get_object("org.cairodock.CairoDock", "/org/cairodock/CairoDock/RuntimeStats"), "org.cairodock.CairoDock.RuntimeStats")
+	
+	def run(self):
+		nb_tasks, period, duration = 50, 5, 30
+		self.p.StartTaskBenchmark(nb_tasks, period, 0)  # the first iterations are spread over a period.
+		sleep(period)
+		before = int(self.p.GetTaskStats().split('\t')[0])
+		sleep(duration)
+		after = int(self.p.GetTaskStats().split('\t')[0])
+		n = int(self.p.StopTaskBenchmark())
+		
+		wakeups = after - before
+		print ('[%s] %d tasks with a period of %ds: %d iterations, %d timer wakeups per minute (%d with a timer per task)' % (self.name, nb_tasks, period, n, wakeups * 60 / duration, nb_tasks * 60 / period))
+		if wakeups > duration + 1:
+			self.print_error ('The timer of the tasks woke up the dock %d times in %ds' % (wakeups, duration))
+		if n < nb_tasks * (duration / period):
+			self.print_error ('Only %d iterations of the tasks' % n)
+		
+		self.end()
+
+# Check that the animations are paced on the frame clock: move the cursor in and out of the main dock, so that it grows and shrinks, and count the steps that missed their frame
+class TestFramesStats(Test):
+	def __init__(self, dock):
+		Test.__init__(self, "Test frames stats", dock)
+		bus = dbus.SessionBus()
+		self.p = dbus.Interface (bus.get_object("org.cairodock.CairoDock", "/org/cairodock/CairoDock/RuntimeStats"), "org.cairodock.CairoDock.RuntimeStats")
+	
+	def _get_frames_stats(self):
+		fields = self.p.GetFramesStats().split('\t')
+		if len(fields) != 3:
+			self.print_error ('Wrong format: "%s"' % '\t'.join(fields))
+			return None
+		return int(fields[0]), int(fields[1]), int(fields[2])
+	
+	def run(self):
+		props = self.d.GetProperties('type=Dock & name=_MainDock_')
+		x, y, w, h = props[0]['x'], props[0]['y'], props[0]['width'], props[0]['height']
+		
+		before = self._get_frames_stats()
+		for i in range(5):
+			os.system ("xdotool mousemove %d %d" % (x + w / 2, y + h - 10))
+			sleep(1)  # let the dock grow
+			os.system ("xdotool mousemove 0 0")
+			sleep(1)  # let the dock shrink
+		after = self._get_frames_stats()
+		
+		if before != None and after != None:
+			frames, late, dropped = after[0] - before[0], after[1] - before[1], after[2] - before[2]
+			print ('[%s] %d steps, %d late, %d frames dropped' % (self.name, frames, late, dropped))
+			if frames == 0:
+				print ('[%s] the animations are not paced on the frame clock (GTK < 3.8), skipped' % self.name)
+			elif late > frames or dropped < late:
+				self.print_error ('Inconsistent stats: %d steps, %d late, %d frames dropped' % (frames, late, dropped))
+			elif late * 10 > frames:
+				self.print_error ('More than 10%% of the steps missed their frame (%d/%d)' % (late, frames))
+		
+		self.end()
+
+# Send a burst of property changes and moves to a window, and check that only the last event of each kind is handled (the window gets its last name)
+class TestEventsStats(Test):
+	def __init__(self, dock):
+		self.exe = config.exe
+		self.wmclass = config.wmclass
+		Test.__init__(self, "Test events stats", dock)
+		bus = dbus.SessionBus()
+		self.p = dbus.Interface (bus.get_object("org.cairodock.CairoDock", "/org/cairodock/CairoDock/RuntimeStats"), "org.cairodock.CairoDock.RuntimeStats")
+	
+	def _get_events_stats(self):
+		fields = self.p.GetEventsStats().split('\t')
+		if len(fields) != 2:
+			self.print_error ('Wrong format: "%s"' % '\t'.join(fields))
+			return None
+		return int(fields[0]), int(fields[1])
+	
+	def run(self):
+		os.system('killall -q '+self.exe)
+		sleep(1)
+		os.system(self.exe+'&')
+		win = subprocess.check_output(['xdotool', 'search', '--sync', '--class', self.wmclass]).split()[0].decode()
+		sleep(1)
+		
+		# a single xdotool command, so that the events arrive together
+		n = 100
+		cmd = 'xdotool'
+		for i in range(n):
+			cmd += ' set_window --name burst-%d %s windowmove %s %d 100' % (i, win, win, 100 + i)
+		before = self._get_events_stats()
+		os.system(cmd)
+		sleep(1)
+		after = self._get_events_stats()
+		
+		props = self.d.GetProperties('class='+self.wmclass)
+		os.system('killall -q '+self.exe)
+		sleep(1)
+		
+		if before != None and after != None:
+			received, coalesced = after[0] - before[0], after[1] - before[1]
+			print ('[%s] %d events received, %d coalesced' % (self.name, received, coalesced))
+			if coalesced == 0:
+				self.print_error ('No event has been coalesced during a burst of %d changes' % (2*n))
+			elif coalesced > received:
+				self.print_error ('Inconsistent stats: %d events received, %d coalesced' % (received, coalesced))
+		names = [prop['name'] for prop in props]  # the launcher of the class may be there too
+		if not 'burst-%d' % (n-1) in names:
+			self.print_error ('The window didn\'t get its last name (%s)' % ', '.join(names))
+		
+		self.end()
+
+# Check the order of the windows in the registry of the windows manager: by age (launch order), and by z-order once they're raised one after the other
+class TestWindowsOrder(Test):
+	def __init__(self, dock):
+		self.exe = config.exe
+		self.wmclass = config.wmclass
+		Test.__init__(self, "Test windows order", dock)
+		bus = dbus.SessionBus()
+		self.p = dbus.Interface (bus.get_object("org.cairodock.CairoDock", "/org/cairodock/CairoDock/RuntimeStats"), "org.cairodock.CairoDock.RuntimeStats")
+	
+	def _get_windows(self, by_z):
+		ids = self.p.GetWindowsOrder(by_z)
+		return [int(x) for x in ids.split('\t')] if ids != '' else []
+	
+	def _search_windows(self):
+		try:
+			return set(int(x) for x in subprocess.check_output(['xdotool', 'search', '--onlyvisible', '--class', self.wmclass]).split())
+		except subprocess.CalledProcessError:  # no window
+			return set()
+	
+	def run(self):
+		os.system('killall -q '+self.exe)
+		sleep(1)
+		
+		# launch a few windows one after the other, to know their age
+		wins = []
+		for i in range(3):
+			os.system(self.exe+'&')
+			sleep(2)
+			new_wins = self._search_windows() - set(wins)
+			if len(new_wins) != 1:
+				self.print_error ('Couldn\'t find the window of the instance %d' % i)
+				os.system('killall -q '+self.exe)
+				self.end()
+				return
+			wins.append(new_wins.pop())
+		
+		# raise them in another order
+		raised = [wins[2], wins[0], wins[1]]
+		for w in raised:
+			os.system('xdotool windowactivate --sync %d' % w)
+		sleep(1)
+		
+		by_age = self._get_windows(False)
+		by_z = self._get_windows(True)
+		if sorted(by_age) != sorted(by_z) or len(set(by_age)) != len(by_age):
+			self.print_error ('The windows are not the same in both orders, or some are there twice')
+		if [w for w in by_age if w in wins] != wins:
+			self.print_error ('Wrong age order: %s instead of %s' % ([w for w in by_age if w in wins], wins))
+		if [w for w in by_z if w in wins] != raised:
+			self.print_error ('Wrong z-order: %s instead of %s' % ([w for w in by_z if w in wins], raised))
+		
+		# the windows are removed from the registry once closed
+		os.system('killall -q '+self.exe)
+		sleep(1)
+		if any(w in wins for w in self._get_windows(True) + self._get_windows(False)):
+			self.print_error ('Some closed windows are still in the registry')
+		
+		self.end()
@@ -0,0 +1,108 @@
+from time import sleep
+import dbus
+from Test import Test, key, set_param
+from CairoDock import CairoDock
+
+# Check that the icons that use the same image share it, by adding a few launchers with the same icon
+class TestSharedImages(Test):
+	def __init__(self, dock):
+		Test.__init__(self, "Test shared images", dock)
+		bus = dbus.SessionBus()
+		self.p = dbus.Interface (bus.get_object("org.cairodock.CairoDock", "/org/cairodock/CairoDock/RuntimeStats"), "org.cairodock.CairoDock.RuntimeStats")
+	
+	def _get_shared_images_stats(self):
+		fields = self.p.GetSharedImagesStats().split('\t')
+		if len(fields) != 4:
+			self.print_error ('Wrong format: "%s"' % '\t'.join(fields))
+			return None
+		return int(fields[0]), int(fields[1]), int(fields[2]), int(fields[3])
+	
+	def run(self):
+		before = self._get_shared_images_stats()
+		
+		# add a few launchers with the same icon
+		launchers = []
+		for i in range(3):
+			launchers.append (self.d.Add({'type':'Launcher', 'name':'TestSharedImages', 'icon':'gtk-home', 'container':'_MainDock_'}))
+		sleep(1)
+		after = self._get_shared_images_stats()
+		
+		for l in launchers:
+			self.d.Remove('config-file='+l)
+		sleep(1)
+		
+		if before != None and after != None:
+			print ('[%s] %d shared images, %d references, %dkB used, %dkB saved' % (self.name, after[0], after[1], after[2] / 1024, after[3] / 1024))
+			if after[1] < before[1] + 3:
+				self.print_error ('The new launchers do not use shared images')
+			if after[3] <= before[3]:
+				self.print_error ('The new launchers do not share their image')
+		
+		self.end()
+
+# Cycle the quick-info of an icon between a few values, like a clock or a monitor does, and check that the texts are taken from the cache after the first round
+class TestTextCache(Test):
+	def __init__(self, dock):
+		Test.__init__(self, "Test text cache", dock)
+		bus = dbus.SessionBus()
+		self.p = dbus.Interface (bus.get_object("org.cairodock.CairoDock", "/org/cairodock/CairoDock/RuntimeStats"), "org.cairodock.CairoDock.RuntimeStats")
+	
+	def _get_text_cache_stats(self):
+		fields = self.p.GetTextCacheStats().split('\t')
+		if len(fields) != 4:
+			self.print_error ('Wrong format: "%s"' % '\t'.join(fields))
+			return None
+		return int(fields[0]), int(fields[1]), int(fields[2]), int(fields[3])
+	
+	def run(self):
+		query = 'container=_MainDock_ & position=0'
+		values = ['12%', '34%', '56%']
+		
+		# first round: the texts are rendered
+		for v in values:
+			self.d.SetQuickInfo(v, query)
+			sleep(.2)
+		before = self._get_text_cache_stats()
+		
+		# next rounds: they should be taken from the cache
+		for i in range(3):
+			for v in values:
+				self.d.SetQuickInfo(v, query)
+				sleep(.2)
+		after = self._get_text_cache_stats()
+		
+		self.d.SetQuickInfo('', query)
+		sleep(.2)
+		
+		if before != None and after != None:
+			hits, misses = after[2] - before[2], after[3] - before[3]
+			print ('[%s] %d texts in the cache (%d unused), %d hits and %d misses' % (self.name, after[0], after[1], hits, misses))
+			if hits < 3 * len(values):
+				self.print_error ('Only %d of the %d quick-infos were taken from the cache' % (hits, 3 * len(values)))
+		
+		self.end()
+
+# Draw on an icon whose image is shared with another one, and check that only the first one is changed
+class TestDrawOnSharedIcon(Test):
+	def __init__(self, dock):
+		Test.__init__(self, "Test draw on shared icon", dock)
+		bus = dbus.SessionBus()
+		self.p = dbus.Interface (bus.get_object("org.cairodock.CairoDock", "/org/cairodock/CairoDock/RuntimeStats"), "org.cairodock.CairoDock.RuntimeStats")
+	
+	def run(self):
+		before = self.p.GetSharedImagesStats()
+		
+		fields = self.p.TestDrawOnSharedIcon().split('\t')
+		if len(fields) != 2:
+			self.print_error ('Wrong format: "%s"' % '\t'.join(fields))
+		else:
+			if int(fields[0]) != 1:
+				self.print_error ('The icon was not drawn')
+			if int(fields[1]) != 1:
+				self.print_error ('The icon sharing its image was drawn too')
+		
+		after = self.p.GetSharedImagesStats()
+		if after != before:
+			self.print_error ('The shared image was not released (%s -> %s)' % (before, after))
+		
+		self.end()
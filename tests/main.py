@@ -23,6 +23,12 @@ from TestStackIcon import TestStackIcon
 from TestTaskbar import TestTaskbar, TestTaskbar2
 from TestIconManager import TestIconManager
 from TestDesklet import TestDesklet
+from TestNotificationProfiler import TestNotificationProfiler, TestDestroyDuringNotification
+from TestIconLoading import TestIconLoading
+from TestRuntimeStats import TestRuntimeStats, TestNewWindowsStats, TestTaskBenchmark, TestTaskWheel, TestFramesStats, TestEventsStats, TestWindowsOrder
+from TestDockWave import TestDockWave
+from TestDockOverlap import TestDockOverlap
+from TestSharedImages import TestSharedImages, TestTextCache, TestDrawOnSharedIcon
 
 from CairoDock import CairoDock
 dock = CairoDock()
@@ -54,6 +60,36 @@ if __name__ == '__main__':
 			TestIconManager(dock).run()
 		elif sys.argv[1] == "TestDesklet":
 			TestDesklet(dock).run()
+		elif sys.argv[1] == "TestNotificationProfiler":
+			TestNotificationProfiler(dock).run()
+		elif sys.argv[1] == "TestIconLoading":
+			TestIconLoading(dock).run()
+		elif sys.argv[1] == "TestRuntimeStats":
+			TestRuntimeStats(dock).run()
+		elif sys.argv[1] == "TestDockWave":
+			TestDockWave(dock).run()
+		elif sys.argv[1] == "TestNewWindowsStats":
+			TestNewWindowsStats(dock).run()
+		elif sys.argv[1] == "TestDockOverlap":
+			TestDockOverlap(dock).run()
+		elif sys.argv[1] == "TestSharedImages":
+			TestSharedImages(dock).run()
+		elif sys.argv[1] == "TestTextCache":
+			TestTextCache(dock).run()
+		elif sys.argv[1] == "TestTaskBenchmark":
+			TestTaskBenchmark(dock).run()
+		elif sys.argv[1] == "TestTaskWheel":
+			TestTaskWheel(dock).run()
+		elif sys.argv[1] == "TestDestroyDuringNotification":
+			TestDestroyDuringNotification(dock).run()
+		elif sys.argv[1] == "TestFramesStats":
+			TestFramesStats(dock).run()
+		elif sys.argv[1] == "TestEventsStats":
+			TestEventsStats(dock).run()
+		elif sys.argv[1] == "TestWindowsOrder":
+			TestWindowsOrder(dock).run()
+		elif sys.argv[1] == "TestDrawOnSharedIcon":
+			TestDrawOnSharedIcon(dock).run()
 		else:
 			print ("Unknown test")
 	else:  # run them all
@@ -69,4 +105,18 @@ if __name__ == '__main__':
 		TestDockManager(dock).run()
 		TestIconManager(dock).run()
 		TestDesklet(dock).run()
-	
+		TestNotificationProfiler(dock).run()
+		TestIconLoading(dock).run()
+		TestRuntimeStats(dock).run()
+		TestDockWave(dock).run()
+		TestNewWindowsStats(dock).run()
+		TestDockOverlap(dock).run()
+		TestSharedImages(dock).run()
+		TestTextCache(dock).run()
+		TestTaskBenchmark(dock).run()
+		TestTaskWheel(dock).run()
+		TestDestroyDuringNotification(dock).run()
+		TestFramesStats(dock).run()
+		TestEventsStats(dock).run()
+		TestWindowsOrder(dock).run()
+		TestDrawOnSharedIcon(dock).run()